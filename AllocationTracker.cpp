@@ -0,0 +1,240 @@
+#include "AllocationTracker.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+#if defined (GPS_ALLOC_TRACKING)
+    #if defined (_WIN32)
+        #define WIN32_LEAN_AND_MEAN
+        #define NOMINMAX
+        #include <windows.h>
+    #else
+        #include <execinfo.h>
+        #include <unistd.h>
+    #endif
+#endif
+
+namespace gps {
+
+#if defined (GPS_ALLOC_TRACKING)
+
+    struct TagCounters {
+        std::atomic<const char*> name;
+        std::atomic<long long> allocations;
+        std::atomic<long long> bytes;
+    };
+
+    //slot 0 counts the untagged allocations and the ones past ALLOCATION_MAX_TAGS
+    static TagCounters tags[ALLOCATION_MAX_TAGS];
+    //the frame EndFrame closed, only read and written on the GL thread
+    static const char* lastTagNames[ALLOCATION_MAX_TAGS];
+    static AllocationCount lastTags[ALLOCATION_MAX_TAGS];
+    static AllocationCount lastFrame = {};
+
+    static thread_local const char* currentTag = nullptr;
+    //the stack capture may allocate itself, that one is not reported again
+    static thread_local bool reporting = false;
+
+    static std::atomic<bool> guardArmed(false);
+    static std::atomic<int> guardViolations(0);
+    static std::atomic<long long> frameIndex(0);
+
+    //tags are string literals, the pointer is the key
+    static TagCounters& TagSlot(const char* name) {
+        if (name == nullptr) {
+            return tags[0];
+        }
+        for (int i = 1; i < ALLOCATION_MAX_TAGS; i++) {
+            const char* slotName = tags[i].name.load(std::memory_order_acquire);
+            if (slotName == name) {
+                return tags[i];
+            }
+            if (slotName == nullptr) {
+                const char* expected = nullptr;
+                if (tags[i].name.compare_exchange_strong(expected, name) || expected == name) {
+                    return tags[i];
+                }
+            }
+        }
+        return tags[0];
+    }
+
+    static void ReportViolation(size_t bytes) {
+        int violation = guardViolations.fetch_add(1);
+        if (violation >= ALLOCATION_REPORTED_VIOLATIONS) {
+            return;
+        }
+
+        reporting = true;
+        fprintf(stderr, "Allocation of %zu bytes in frame %lld (%s) while the allocation guard is armed\n",
+            bytes, frameIndex.load(), currentTag != nullptr ? currentTag : "untagged");
+        void* stack[ALLOCATION_STACK_DEPTH];
+#if defined (_WIN32)
+        int depth = CaptureStackBackTrace(2, ALLOCATION_STACK_DEPTH, stack, nullptr);
+        for (int i = 0; i < depth; i++) {
+            fprintf(stderr, "    %p\n", stack[i]);
+        }
+#else
+        int depth = backtrace(stack, ALLOCATION_STACK_DEPTH);
+        //written straight to the descriptor, backtrace_symbols would allocate
+        backtrace_symbols_fd(stack + 2, depth > 2 ? depth - 2 : 0, STDERR_FILENO);
+#endif
+        fflush(stderr);
+        reporting = false;
+    }
+
+    void AllocationTracker::RecordAllocation(size_t bytes) {
+        if (reporting) {
+            return;
+        }
+        TagCounters& counters = TagSlot(currentTag);
+        counters.allocations.fetch_add(1, std::memory_order_relaxed);
+        counters.bytes.fetch_add((long long)bytes, std::memory_order_relaxed);
+        if (guardArmed.load(std::memory_order_relaxed)) {
+            ReportViolation(bytes);
+        }
+    }
+
+    void AllocationTracker::EndFrame() {
+        lastFrame.allocations = 0;
+        lastFrame.bytes = 0;
+        for (int i = 0; i < ALLOCATION_MAX_TAGS; i++) {
+            lastTagNames[i] = tags[i].name.load(std::memory_order_acquire);
+            lastTags[i].allocations = tags[i].allocations.exchange(0, std::memory_order_relaxed);
+            lastTags[i].bytes = tags[i].bytes.exchange(0, std::memory_order_relaxed);
+            lastFrame.allocations += lastTags[i].allocations;
+            lastFrame.bytes += lastTags[i].bytes;
+        }
+        frameIndex.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    AllocationCount AllocationTracker::GetLastFrame() {
+        return lastFrame;
+    }
+
+    void AllocationTracker::PrintFrameSummary() {
+        std::cout << "Heap allocations in frame " << frameIndex.load() - 1 << ": " << lastFrame.allocations
+            << " (" << lastFrame.bytes << " bytes)" << std::endl;
+        for (int i = 0; i < ALLOCATION_MAX_TAGS; i++) {
+            if (lastTags[i].allocations == 0) {
+                continue;
+            }
+            std::cout << "    " << (i == 0 ? "untagged" : lastTagNames[i]) << ": " << lastTags[i].allocations
+                << " (" << lastTags[i].bytes << " bytes)" << std::endl;
+        }
+    }
+
+    void AllocationTracker::SetGuard(bool armed) {
+        guardArmed.store(armed, std::memory_order_relaxed);
+    }
+
+    int AllocationTracker::GetGuardViolationCount() {
+        return guardViolations.load();
+    }
+
+    bool AllocationTracker::IsEnabled() {
+        return true;
+    }
+
+    const char* AllocationTracker::SetTag(const char* name) {
+        const char* previous = currentTag;
+        currentTag = name;
+        return previous;
+    }
+
+    const char* AllocationTracker::GetTag() {
+        return currentTag;
+    }
+
+#else
+
+    void AllocationTracker::RecordAllocation(size_t bytes) {
+    }
+
+    void AllocationTracker::EndFrame() {
+    }
+
+    AllocationCount AllocationTracker::GetLastFrame() {
+        AllocationCount count = {};
+        return count;
+    }
+
+    void AllocationTracker::PrintFrameSummary() {
+        std::cout << "Allocation tracking is not compiled in, build with GPS_ALLOC_TRACKING" << std::endl;
+    }
+
+    void AllocationTracker::SetGuard(bool armed) {
+    }
+
+    int AllocationTracker::GetGuardViolationCount() {
+        return 0;
+    }
+
+    bool AllocationTracker::IsEnabled() {
+        return false;
+    }
+
+    const char* AllocationTracker::SetTag(const char* name) {
+        return nullptr;
+    }
+
+    const char* AllocationTracker::GetTag() {
+        return nullptr;
+    }
+
+#endif
+}
+
+#if defined (GPS_ALLOC_TRACKING)
+
+//the replacements are global, every operator new of the program comes through here
+void* operator new(size_t bytes) {
+    gps::AllocationTracker::RecordAllocation(bytes);
+    void* memory = malloc(bytes != 0 ? bytes : 1);
+    if (memory == nullptr) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void* operator new[](size_t bytes) {
+    return operator new(bytes);
+}
+
+void* operator new(size_t bytes, const std::nothrow_t&) noexcept {
+    gps::AllocationTracker::RecordAllocation(bytes);
+    return malloc(bytes != 0 ? bytes : 1);
+}
+
+void* operator new[](size_t bytes, const std::nothrow_t&) noexcept {
+    return operator new(bytes, std::nothrow);
+}
+
+void operator delete(void* memory) noexcept {
+    free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept {
+    free(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {
+    free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    free(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept {
+    free(memory);
+}
+
+#endif
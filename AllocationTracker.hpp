@@ -0,0 +1,70 @@
+#ifndef AllocationTracker_hpp
+#define AllocationTracker_hpp
+
+#include <cstddef>
+
+//GPS_ALLOC_TRACKING replaces the global operator new and delete to count the heap allocations
+//of every frame, without it the tags compile to nothing and nothing is counted
+#if defined (GPS_ALLOC_TRACKING)
+    #define GPS_ALLOC_CONCAT_(a, b) a##b
+    #define GPS_ALLOC_CONCAT(a, b) GPS_ALLOC_CONCAT_(a, b)
+    //name must outlive the tracker, a string literal
+    #define GPS_ALLOC_TAG(name) gps::AllocationTag GPS_ALLOC_CONCAT(allocationTag, __LINE__)(name)
+#else
+    #define GPS_ALLOC_TAG(name) ((void)0)
+#endif
+
+namespace gps {
+
+    //tags with their own counters, allocations under further tags count as untagged
+    const int ALLOCATION_MAX_TAGS = 32;
+    //frames of the stack printed for an allocation in a guarded frame
+    const int ALLOCATION_STACK_DEPTH = 24;
+    //guard violations that print their stack, the rest are only counted
+    const int ALLOCATION_REPORTED_VIOLATIONS = 8;
+
+    struct AllocationCount {
+        long long allocations;
+        long long bytes;
+    };
+
+    //counts operator new calls per frame and per tag, the tag is per thread (see GPS_ALLOC_TAG)
+    //the job system hands the tag of ParallelFor to the workers running the loop
+    class AllocationTracker {
+
+    public:
+        //from the operator new replacements, on any thread
+        static void RecordAllocation(size_t bytes);
+        //GL thread, once per frame: the counters start over, the last frame is kept for the summary
+        static void EndFrame();
+        static AllocationCount GetLastFrame();
+        //per tag counts of the last frame
+        static void PrintFrameSummary();
+
+        //while armed every allocation is a violation, its stack is printed to stderr
+        static void SetGuard(bool armed);
+        static int GetGuardViolationCount();
+        static bool IsEnabled();
+
+        //returns the tag of the thread before
+        static const char* SetTag(const char* name);
+        static const char* GetTag();
+    };
+
+    class AllocationTag {
+
+    public:
+        explicit AllocationTag(const char* name) {
+            previous = AllocationTracker::SetTag(name);
+        }
+
+        ~AllocationTag() {
+            AllocationTracker::SetTag(previous);
+        }
+
+    private:
+        const char* previous;
+    };
+}
+
+#endif /* AllocationTracker_hpp */
@@ -0,0 +1,215 @@
+#include "Benchmark.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+namespace gps {
+
+    void Benchmark::Init() {
+
+        frame = 0;
+        metrics.clear();
+        passes.clear();
+        frameCpuMetric = FindMetric("frame.cpu");
+        frameGpuMetric = FindMetric("frame.gpu");
+        swapMetric = FindMetric("frame.swap");
+    }
+
+    void Benchmark::SetWarmupFrames(int frames) {
+        warmupFrames = frames;
+    }
+
+    int Benchmark::FindMetric(const std::string& name) {
+
+        for (size_t i = 0; i < metrics.size(); i++) {
+            if (metrics[i].name == name)
+                return (int)i;
+        }
+
+        Metric metric;
+        metric.name = name;
+        metrics.push_back(metric);
+        metrics.back().samples.reserve(BENCHMARK_RESERVED_SAMPLES);
+        return (int)metrics.size() - 1;
+    }
+
+    //the metrics are created on first use, so every pass shows up in the report even if it only ran in the warmup
+    const Benchmark::PassMetrics& Benchmark::FindPass(const std::string& name) {
+
+        std::map<std::string, PassMetrics>::iterator found = passes.find(name);
+        if (found != passes.end())
+            return found->second;
+
+        PassMetrics pass;
+        pass.cpu = FindMetric("pass." + name + ".cpu");
+        pass.gpu = FindMetric("pass." + name + ".gpu");
+        return passes.insert(std::make_pair(name, pass)).first->second;
+    }
+
+    void Benchmark::AddSample(int metric, double milliseconds) {
+
+        if (frame >= warmupFrames)
+            metrics[metric].samples.push_back(milliseconds);
+    }
+
+    //the queries are recycled once their frame is resolved
+    GLuint Benchmark::Timestamp() {
+
+        GLuint query;
+        if (freeQueries.empty()) {
+            glGenQueries(1, &query);
+            allQueries.push_back(query);
+        }
+        else {
+            query = freeQueries.back();
+            freeQueries.pop_back();
+        }
+
+        glQueryCounter(query, GL_TIMESTAMP);
+        return query;
+    }
+
+    void Benchmark::BeginFrame() {
+
+        //the slot about to be reused holds the frame from BENCHMARK_FRAME_LATENCY frames ago
+        ResolveFrame(frame % BENCHMARK_FRAME_LATENCY);
+
+        frameStart = Clock::now();
+        frameQuery = Timestamp();
+    }
+
+    void Benchmark::BeginPass(const std::string& name) {
+
+        OpenInterval interval;
+        interval.pass = &FindPass(name);
+        interval.cpuStart = Clock::now();
+        interval.gpuStart = Timestamp();
+        openPasses.push_back(interval);
+    }
+
+    void Benchmark::EndPass(const std::string& name) {
+
+        if (openPasses.empty() || openPasses.back().pass != &FindPass(name)) {
+            std::cout << "Benchmark: pass " << name << " ended without a matching begin" << std::endl;
+            return;
+        }
+
+        OpenInterval interval = openPasses.back();
+        openPasses.pop_back();
+
+        AddSample(interval.pass->cpu, std::chrono::duration<double, std::milli>(Clock::now() - interval.cpuStart).count());
+
+        PendingInterval gpu;
+        gpu.metric = interval.pass->gpu;
+        gpu.begin = interval.gpuStart;
+        gpu.end = Timestamp();
+        pending[frame % BENCHMARK_FRAME_LATENCY].push_back(gpu);
+    }
+
+    void Benchmark::BeginSwap() {
+        swapStart = Clock::now();
+    }
+
+    void Benchmark::EndSwap() {
+        AddSample(swapMetric, std::chrono::duration<double, std::milli>(Clock::now() - swapStart).count());
+    }
+
+    void Benchmark::EndFrame() {
+
+        AddSample(frameCpuMetric, std::chrono::duration<double, std::milli>(Clock::now() - frameStart).count());
+
+        PendingInterval gpu;
+        gpu.metric = frameGpuMetric;
+        gpu.begin = frameQuery;
+        gpu.end = Timestamp();
+        pending[frame % BENCHMARK_FRAME_LATENCY].push_back(gpu);
+
+        frame++;
+    }
+
+    //a few frames late the results are normally there already, otherwise this waits
+    void Benchmark::ResolveFrame(int slot) {
+
+        //the frame index the slot was recorded in decides about the warmup
+        bool warmup = frame - BENCHMARK_FRAME_LATENCY < warmupFrames;
+        for (size_t i = 0; i < pending[slot].size(); i++) {
+
+            GLuint64 begin = 0, end = 0;
+            glGetQueryObjectui64v(pending[slot][i].begin, GL_QUERY_RESULT, &begin);
+            glGetQueryObjectui64v(pending[slot][i].end, GL_QUERY_RESULT, &end);
+            if (!warmup)
+                metrics[pending[slot][i].metric].samples.push_back((double)(end - begin) / 1000000.0);
+
+            freeQueries.push_back(pending[slot][i].begin);
+            freeQueries.push_back(pending[slot][i].end);
+        }
+        pending[slot].clear();
+    }
+
+    void Benchmark::Finish() {
+
+        //as if the next frames began, ResolveFrame works out the frame index from the counter
+        for (int i = 0; i < BENCHMARK_FRAME_LATENCY; i++) {
+            ResolveFrame(frame % BENCHMARK_FRAME_LATENCY);
+            frame++;
+        }
+        frame -= BENCHMARK_FRAME_LATENCY;
+    }
+
+    //nearest rank
+    double Benchmark::Percentile(const std::vector<double>& sorted, double percent) {
+
+        if (sorted.empty())
+            return 0.0;
+        size_t rank = (size_t)(percent / 100.0 * (double)sorted.size() + 0.999999);
+        rank = std::min(std::max(rank, (size_t)1), sorted.size());
+        return sorted[rank - 1];
+    }
+
+    //{ "frames": n, "metrics": { "frame.cpu": { "count", "mean", "p50", "p95", "p99", "max" }, ... } }, milliseconds
+    bool Benchmark::WriteJson(std::string fileName) {
+
+        std::ofstream file(fileName);
+        if (!file.is_open()) {
+            std::cout << "Could not write " << fileName << std::endl;
+            return false;
+        }
+
+        file << "{\n  \"frames\": " << std::max(frame - warmupFrames, 0) << ",\n  \"unit\": \"ms\",\n  \"metrics\": {";
+        for (size_t i = 0; i < metrics.size(); i++) {
+
+            std::vector<double> sorted = metrics[i].samples;
+            std::sort(sorted.begin(), sorted.end());
+            double sum = 0.0;
+            for (size_t s = 0; s < sorted.size(); s++)
+                sum += sorted[s];
+
+            file << (i == 0 ? "\n" : ",\n") << "    \"" << metrics[i].name << "\": { "
+                << "\"count\": " << sorted.size()
+                << ", \"mean\": " << (sorted.empty() ? 0.0 : sum / (double)sorted.size())
+                << ", \"p50\": " << Percentile(sorted, 50.0)
+                << ", \"p95\": " << Percentile(sorted, 95.0)
+                << ", \"p99\": " << Percentile(sorted, 99.0)
+                << ", \"max\": " << (sorted.empty() ? 0.0 : sorted.back()) << " }";
+        }
+        file << "\n  }\n}\n";
+
+        std::cout << "Benchmark results written to " << fileName << std::endl;
+        return true;
+    }
+
+    void Benchmark::Delete() {
+
+        if (!allQueries.empty())
+            glDeleteQueries((GLsizei)allQueries.size(), &allQueries[0]);
+        allQueries.clear();
+        freeQueries.clear();
+        for (int i = 0; i < BENCHMARK_FRAME_LATENCY; i++)
+            pending[i].clear();
+    }
+
+    int Benchmark::GetFrameCount() {
+        return frame;
+    }
+}
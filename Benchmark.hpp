@@ -0,0 +1,101 @@
+#ifndef Benchmark_hpp
+#define Benchmark_hpp
+
+#if defined (__APPLE__)
+    #define GL_SILENCE_DEPRECATION
+    #include <OpenGL/gl3.h>
+#else
+    #define GLEW_STATIC
+    #include <GL/glew.h>
+#endif
+
+#include "GLIntercept.hpp"
+
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace gps {
+
+    //GPU timestamps are read back this many frames later, so the CPU never waits for them
+    const int BENCHMARK_FRAME_LATENCY = 4;
+    //samples reserved per metric, a run of over two minutes at 60 frames per second stays off the heap
+    const int BENCHMARK_RESERVED_SAMPLES = 8192;
+
+    //CPU, GPU and swap times of whole frames and of the render graph passes
+    //every measurement is one sample per frame, summarized as mean, p50, p95, p99 and max
+    class Benchmark {
+
+    public:
+        //GL thread only
+        void Init();
+        void BeginFrame();
+        void BeginPass(const std::string& name);
+        void EndPass(const std::string& name);
+        //the swap is part of the CPU frame time and also reported on its own
+        void BeginSwap();
+        void EndSwap();
+        void EndFrame();
+        //samples of frames before this are discarded, e.g. while shaders compile
+        void SetWarmupFrames(int frames);
+        //waits for the timestamps still in flight
+        void Finish();
+        bool WriteJson(std::string fileName);
+        void Delete();
+
+        int GetFrameCount();
+
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        struct Metric {
+            std::string name;
+            std::vector<double> samples;
+        };
+
+        //a GPU interval still waiting for its timestamps
+        struct PendingInterval {
+            int metric;
+            GLuint begin;
+            GLuint end;
+        };
+
+        //the metrics of a pass, found by name once so the frames build no strings
+        struct PassMetrics {
+            int cpu;
+            int gpu;
+        };
+
+        struct OpenInterval {
+            const PassMetrics* pass;
+            Clock::time_point cpuStart;
+            GLuint gpuStart;
+        };
+
+        std::vector<Metric> metrics;
+        std::map<std::string, PassMetrics> passes;
+        std::vector<PendingInterval> pending[BENCHMARK_FRAME_LATENCY];
+        std::vector<OpenInterval> openPasses;
+        std::vector<GLuint> freeQueries;
+        std::vector<GLuint> allQueries;
+
+        Clock::time_point frameStart;
+        Clock::time_point swapStart;
+        GLuint frameQuery = 0;
+        int frameCpuMetric = -1;
+        int frameGpuMetric = -1;
+        int swapMetric = -1;
+        int frame = 0;
+        int warmupFrames = 0;
+
+        int FindMetric(const std::string& name);
+        const PassMetrics& FindPass(const std::string& name);
+        void AddSample(int metric, double milliseconds);
+        GLuint Timestamp();
+        void ResolveFrame(int slot);
+        static double Percentile(const std::vector<double>& sorted, double percent);
+    };
+}
+
+#endif /* Benchmark_hpp */
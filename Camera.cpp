@@ -10,11 +10,102 @@ namespace gps {
 
         this->cameraFrontDirection = glm::normalize(cameraTarget - cameraPosition);
         this->cameraRightDirection = glm::normalize(glm::cross(cameraFrontDirection, cameraUp));
+
+        this->fov = glm::radians(45.0f);
+        this->aspect = 1.0f;
+        this->nearPlane = 0.1f;
+        this->farPlane = 100.0f;
+        this->viewDirty = true;
+        this->projectionDirty = true;
+    }
+
+    //set the perspective projection parameters, fov in radians
+    void Camera::setProjection(float fov, float aspect, float nearPlane, float farPlane) {
+        this->fov = fov;
+        this->aspect = aspect;
+        this->nearPlane = nearPlane;
+        this->farPlane = farPlane;
+        projectionDirty = true;
+    }
+
+    void Camera::setAspect(float aspect) {
+        this->aspect = aspect;
+        projectionDirty = true;
+    }
+
+    //rebuild only what the last changes invalidated
+    void Camera::updateMatrices() {
+        if (!viewDirty && !projectionDirty)
+            return;
+
+        if (viewDirty) {
+            viewMatrix = glm::lookAt(cameraPosition, cameraTarget, cameraUpDirection);
+            inverseViewMatrix = glm::inverse(viewMatrix);
+        }
+        if (projectionDirty) {
+            projectionMatrix = glm::perspective(fov, aspect, nearPlane, farPlane);
+            inverseProjectionMatrix = glm::inverse(projectionMatrix);
+        }
+
+        viewProjectionMatrix = projectionMatrix * viewMatrix;
+        inverseViewProjectionMatrix = inverseViewMatrix * inverseProjectionMatrix;
+        frustum.Extract(viewProjectionMatrix);
+
+        viewDirty = false;
+        projectionDirty = false;
     }
 
     //return the view matrix, using the glm::lookAt() function
-    glm::mat4 Camera::getViewMatrix() {
-        return glm::lookAt(cameraPosition, cameraTarget, this->cameraUpDirection);
+    const glm::mat4& Camera::getViewMatrix() {
+        updateMatrices();
+        return viewMatrix;
+    }
+
+    const glm::mat4& Camera::getProjectionMatrix() {
+        updateMatrices();
+        return projectionMatrix;
+    }
+
+    const glm::mat4& Camera::getViewProjectionMatrix() {
+        updateMatrices();
+        return viewProjectionMatrix;
+    }
+
+    const glm::mat4& Camera::getInverseViewMatrix() {
+        updateMatrices();
+        return inverseViewMatrix;
+    }
+
+    const glm::mat4& Camera::getInverseProjectionMatrix() {
+        updateMatrices();
+        return inverseProjectionMatrix;
+    }
+
+    const glm::mat4& Camera::getInverseViewProjectionMatrix() {
+        updateMatrices();
+        return inverseViewProjectionMatrix;
+    }
+
+    //frustum planes of the view projection matrix
+    const gps::Frustum& Camera::getFrustum() {
+        updateMatrices();
+        return frustum;
+    }
+
+    float Camera::getFov() {
+        return fov;
+    }
+
+    float Camera::getAspect() {
+        return aspect;
+    }
+
+    float Camera::getNearPlane() {
+        return nearPlane;
+    }
+
+    float Camera::getFarPlane() {
+        return farPlane;
     }
 
     //update the camera internal parameters following a camera move event
@@ -44,6 +135,7 @@ namespace gps {
             cameraPosition -= cameraUpDirection * speed;
         }
         cameraTarget = cameraPosition + cameraFrontDirection;
+        viewDirty = true;
     }
 
     //update the camera internal parameters following a camera rotate event
@@ -58,5 +150,20 @@ namespace gps {
         
         cameraTarget = cameraPosition + cameraFrontDirection;
         cameraRightDirection = glm::normalize(glm::cross(cameraFrontDirection, cameraUpDirection));
+        viewDirty = true;
+    }
+
+    //position of the camera, the viewing direction is kept
+    glm::vec3 Camera::getPosition() {
+        return cameraPosition;
+    }
+
+    void Camera::setPosition(glm::vec3 position) {
+        if (position == cameraPosition)
+            return;
+
+        cameraPosition = position;
+        cameraTarget = cameraPosition + cameraFrontDirection;
+        viewDirty = true;
     }
 }
@@ -4,6 +4,8 @@
 #include <glm/glm.hpp>
 #include <glm/gtx/transform.hpp>
 
+#include "Frustum.hpp"
+
 namespace gps {
     
     enum MOVE_DIRECTION {MOVE_FORWARD, MOVE_BACKWARD, MOVE_RIGHT, MOVE_LEFT, MOVE_UP, MOVE_DOWN};
@@ -13,14 +15,32 @@ namespace gps {
     public:
         //Camera constructor
         Camera(glm::vec3 cameraPosition, glm::vec3 cameraTarget, glm::vec3 cameraUp);
+        //set the perspective projection parameters, fov in radians
+        void setProjection(float fov, float aspect, float nearPlane, float farPlane);
+        void setAspect(float aspect);
+        //the matrices and frustum planes are cached and only rebuilt after the camera changed
         //return the view matrix, using the glm::lookAt() function
-        glm::mat4 getViewMatrix();
+        const glm::mat4& getViewMatrix();
+        const glm::mat4& getProjectionMatrix();
+        const glm::mat4& getViewProjectionMatrix();
+        const glm::mat4& getInverseViewMatrix();
+        const glm::mat4& getInverseProjectionMatrix();
+        const glm::mat4& getInverseViewProjectionMatrix();
+        //frustum planes of the view projection matrix
+        const gps::Frustum& getFrustum();
+        float getFov();
+        float getAspect();
+        float getNearPlane();
+        float getFarPlane();
         //update the camera internal parameters following a camera move event
         void move(MOVE_DIRECTION direction, float speed);
         //update the camera internal parameters following a camera rotate event
         //yaw - camera rotation around the y axis
         //pitch - camera rotation around the x axis
         void rotate(float pitch, float yaw);
+        //position of the camera, the viewing direction is kept
+        glm::vec3 getPosition();
+        void setPosition(glm::vec3 position);
         
     private:
         glm::vec3 cameraPosition;
@@ -28,6 +48,23 @@ namespace gps {
         glm::vec3 cameraFrontDirection;
         glm::vec3 cameraRightDirection;
         glm::vec3 cameraUpDirection;
+
+        float fov;
+        float aspect;
+        float nearPlane;
+        float farPlane;
+
+        bool viewDirty;
+        bool projectionDirty;
+        glm::mat4 viewMatrix;
+        glm::mat4 projectionMatrix;
+        glm::mat4 viewProjectionMatrix;
+        glm::mat4 inverseViewMatrix;
+        glm::mat4 inverseProjectionMatrix;
+        glm::mat4 inverseViewProjectionMatrix;
+        gps::Frustum frustum;
+
+        void updateMatrices();
     };    
 }
 
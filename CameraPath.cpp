@@ -0,0 +1,111 @@
+#include "CameraPath.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace gps {
+
+    void CameraPath::AddKey(float time, glm::vec3 position, float yaw, float pitch) {
+
+        CameraKey key;
+        key.time = time;
+        key.position = position;
+        key.yaw = yaw;
+        key.pitch = pitch;
+        keys.push_back(key);
+    }
+
+    //one key per line: time x y z yaw pitch, lines starting with # are comments
+    bool CameraPath::Load(std::string fileName) {
+
+        std::ifstream file(fileName);
+        if (!file.is_open()) {
+            std::cout << "Could not open the camera path " << fileName << std::endl;
+            return false;
+        }
+
+        keys.clear();
+        std::string line;
+        while (std::getline(file, line)) {
+
+            if (line.empty() || line[0] == '#')
+                continue;
+
+            std::stringstream values(line);
+            CameraKey key;
+            if (values >> key.time >> key.position.x >> key.position.y >> key.position.z >> key.yaw >> key.pitch)
+                keys.push_back(key);
+        }
+
+        std::cout << "Loaded " << keys.size() << " camera keys from " << fileName << std::endl;
+        return !keys.empty();
+    }
+
+    bool CameraPath::Save(std::string fileName) {
+
+        std::ofstream file(fileName);
+        if (!file.is_open()) {
+            std::cout << "Could not write the camera path " << fileName << std::endl;
+            return false;
+        }
+
+        file << "# time x y z yaw pitch\n";
+        for (size_t i = 0; i < keys.size(); i++) {
+            const CameraKey& key = keys[i];
+            file << key.time << " " << key.position.x << " " << key.position.y << " " << key.position.z << " "
+                << key.yaw << " " << key.pitch << "\n";
+        }
+        return true;
+    }
+
+    void CameraPath::Clear() {
+        keys.clear();
+    }
+
+    CameraKey CameraPath::Sample(float time) {
+
+        if (keys.empty()) {
+            CameraKey key = { time, glm::vec3(0.0f), 0.0f, 0.0f };
+            return key;
+        }
+        if (time <= keys.front().time || keys.size() == 1)
+            return keys.front();
+        if (time >= keys.back().time)
+            return keys.back();
+
+        //the segment [k1, k2] holding the time, the end keys are repeated as neighbours
+        size_t k2 = 1;
+        while (keys[k2].time < time)
+            k2++;
+        size_t k1 = k2 - 1;
+        size_t k0 = k1 > 0 ? k1 - 1 : k1;
+        size_t k3 = k2 + 1 < keys.size() ? k2 + 1 : k2;
+
+        float length = keys[k2].time - keys[k1].time;
+        float t = length > 0.0f ? (time - keys[k1].time) / length : 0.0f;
+        float t2 = t * t;
+        float t3 = t2 * t;
+
+        const glm::vec3& p0 = keys[k0].position;
+        const glm::vec3& p1 = keys[k1].position;
+        const glm::vec3& p2 = keys[k2].position;
+        const glm::vec3& p3 = keys[k3].position;
+
+        CameraKey key;
+        key.time = time;
+        key.position = 0.5f * ((2.0f * p1) + (p2 - p0) * t + (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2
+            + (3.0f * p1 - p0 - 3.0f * p2 + p3) * t3);
+        key.yaw = keys[k1].yaw + (keys[k2].yaw - keys[k1].yaw) * t;
+        key.pitch = keys[k1].pitch + (keys[k2].pitch - keys[k1].pitch) * t;
+        return key;
+    }
+
+    float CameraPath::GetDuration() {
+        return keys.empty() ? 0.0f : keys.back().time;
+    }
+
+    int CameraPath::GetKeyCount() {
+        return (int)keys.size();
+    }
+}
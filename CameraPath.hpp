@@ -0,0 +1,39 @@
+#ifndef CameraPath_hpp
+#define CameraPath_hpp
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+namespace gps {
+
+    //a camera pose at a point of the path, the angles as used by Camera::rotate
+    struct CameraKey {
+        float time;
+        glm::vec3 position;
+        float yaw;
+        float pitch;
+    };
+
+    //Catmull-Rom spline through the key positions, the angles are blended linearly
+    //keys must be added in time order; yaw is not wrapped, so -170 to 170 turns the long way
+    class CameraPath {
+
+    public:
+        void AddKey(float time, glm::vec3 position, float yaw, float pitch);
+        //one key per line: time x y z yaw pitch
+        bool Load(std::string fileName);
+        bool Save(std::string fileName);
+        void Clear();
+
+        CameraKey Sample(float time);
+        float GetDuration();
+        int GetKeyCount();
+
+    private:
+        std::vector<CameraKey> keys;
+    };
+}
+
+#endif /* CameraPath_hpp */
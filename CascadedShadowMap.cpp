@@ -0,0 +1,261 @@
+#include "CascadedShadowMap.hpp"
+#include "GpuMemory.hpp"
+
+#include <cmath>
+
+namespace gps {
+
+    //allocate the static and dynamic depth texture arrays (one layer per cascade) and the FBO
+    void CascadedShadowMap::Init(int cascadeCount, int resolution, float shadowDistance) {
+
+        this->cascadeCount = glm::clamp(cascadeCount, 1, MAX_SHADOW_CASCADES);
+        this->resolution = resolution;
+        this->shadowDistance = shadowDistance;
+
+        for (int i = 0; i < MAX_SHADOW_CASCADES; i++) {
+
+            staticDirty[i] = true;
+            pendingFrames[i] = 0;
+        }
+
+        //generate FBO ID
+        glGenFramebuffers(1, &shadowMapFBO);
+
+        staticDepthTexture = CreateDepthArray();
+        dynamicDepthTexture = CreateDepthArray();
+
+        //attach the first layer, the others are attached in BindForWriting
+        glBindFramebuffer(GL_FRAMEBUFFER, shadowMapFBO);
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, staticDepthTexture, 0, 0);
+        GPS_GL_LABEL(GL_FRAMEBUFFER, shadowMapFBO, "shadow cascades");
+        GPS_GL_LABEL(GL_TEXTURE, staticDepthTexture, "shadow cascades static");
+        GPS_GL_LABEL(GL_TEXTURE, dynamicDepthTexture, "shadow cascades dynamic");
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    //create a depth texture array with one layer per cascade
+    GLuint CascadedShadowMap::CreateDepthArray() {
+
+        GLuint textureId;
+        glGenTextures(1, &textureId);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, textureId);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT, resolution, resolution, cascadeCount, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+        GpuMemory::Track(GPU_MEMORY_TEXTURE, textureId, GpuMemory::ImageBytes(resolution, resolution, cascadeCount, GL_DEPTH_COMPONENT, false));
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        float borderColor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+        glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, borderColor);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+        return textureId;
+    }
+
+    void CascadedShadowMap::SetCacheParameters(float angularThreshold, float coverageMargin, int maxStaticUpdatesPerFrame) {
+
+        this->angularThreshold = angularThreshold;
+        this->coverageMargin = coverageMargin;
+        this->maxStaticUpdatesPerFrame = glm::max(maxStaticUpdatesPerFrame, 1);
+    }
+
+    //split the [nearPlane, shadowDistance] range with the practical split scheme
+    void CascadedShadowMap::ComputeSplitDepths(float nearPlane) {
+
+        for (int i = 0; i < cascadeCount; i++) {
+
+            float p = (float)(i + 1) / (float)cascadeCount;
+            float logSplit = nearPlane * std::pow(shadowDistance / nearPlane, p);
+            float uniformSplit = nearPlane + (shadowDistance - nearPlane) * p;
+            splitDepths[i] = splitLambda * logSplit + (1.0f - splitLambda) * uniformSplit;
+        }
+    }
+
+    //refit the cascades whose cached region no longer covers their slice of the camera frustum
+    void CascadedShadowMap::Update(const glm::mat4& viewMatrix, float fov, float aspect, float nearPlane, glm::vec3 lightDir) {
+
+        ComputeSplitDepths(nearPlane);
+
+        glm::mat4 inverseView = glm::inverse(viewMatrix);
+        float tanHalfHeight = std::tan(fov * 0.5f);
+        float tanHalfWidth = tanHalfHeight * aspect;
+        glm::vec3 lightDirN = glm::normalize(lightDir);
+
+        glm::vec3 centers[MAX_SHADOW_CASCADES];
+        float radius[MAX_SHADOW_CASCADES];
+        bool needsRefit[MAX_SHADOW_CASCADES];
+
+        float sliceNear = nearPlane;
+        for (int i = 0; i < cascadeCount; i++) {
+
+            float sliceFar = splitDepths[i];
+
+            //world space corners of the slice
+            glm::vec3 corners[8];
+            int corner = 0;
+            for (int z = 0; z < 2; z++) {
+
+                float depth = z == 0 ? sliceNear : sliceFar;
+                for (int y = -1; y <= 1; y += 2) {
+
+                    for (int x = -1; x <= 1; x += 2) {
+
+                        glm::vec4 cornerEye(x * tanHalfWidth * depth, y * tanHalfHeight * depth, -depth, 1.0f);
+                        corners[corner++] = glm::vec3(inverseView * cornerEye);
+                    }
+                }
+            }
+
+            //bounding sphere of the slice - its size does not change when the camera rotates
+            centers[i] = glm::vec3(0.0f);
+            for (int c = 0; c < 8; c++)
+                centers[i] += corners[c];
+            centers[i] /= 8.0f;
+
+            radius[i] = 0.0f;
+            for (int c = 0; c < 8; c++)
+                radius[i] = glm::max(radius[i], glm::length(corners[c] - centers[i]));
+
+            //refit once the light turned past the threshold or the slice left the cached region
+            float lightAngle = glm::degrees(std::acos(glm::clamp(glm::dot(lightDirN, cachedLightDirs[i]), -1.0f, 1.0f)));
+            bool covered = glm::length(centers[i] - cachedCenters[i]) + radius[i] <= cachedRadius[i];
+            needsRefit[i] = !initialized || lightAngle > angularThreshold || !covered;
+
+            sliceNear = sliceFar;
+        }
+
+        //spread the refits over several frames, longest waiting cascade first
+        int budget = initialized ? maxStaticUpdatesPerFrame : cascadeCount;
+        for (int update = 0; update < budget; update++) {
+
+            int selected = -1;
+            for (int i = 0; i < cascadeCount; i++) {
+
+                if (needsRefit[i] && (selected < 0 || pendingFrames[i] > pendingFrames[selected]))
+                    selected = i;
+            }
+
+            if (selected < 0)
+                break;
+
+            FitCascade(selected, centers[selected], radius[selected], lightDirN);
+            needsRefit[selected] = false;
+        }
+
+        for (int i = 0; i < cascadeCount; i++) {
+
+            if (needsRefit[i])
+                pendingFrames[i]++;
+        }
+
+        initialized = true;
+    }
+
+    //compute the light matrix of a cascade around a slightly enlarged bounding sphere
+    void CascadedShadowMap::FitCascade(int cascade, glm::vec3 center, float radius, glm::vec3 lightDirN) {
+
+        radius = std::ceil(radius * (1.0f + coverageMargin) * 16.0f) / 16.0f;
+
+        glm::vec3 lightUp = std::fabs(lightDirN.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+        glm::mat4 lightView = glm::lookAt(center + lightDirN * radius, center, lightUp);
+        glm::mat4 lightProjection = glm::ortho(-radius, radius, -radius, radius, 0.0f, 2.0f * radius);
+        glm::mat4 lightSpaceTrMatrix = lightProjection * lightView;
+
+        //snap the origin to a whole texel so the shadow edges do not shimmer while moving
+        glm::vec4 shadowOrigin = lightSpaceTrMatrix * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+        shadowOrigin = shadowOrigin * (resolution / 2.0f);
+        glm::vec4 roundedOrigin(std::round(shadowOrigin.x), std::round(shadowOrigin.y), 0.0f, 0.0f);
+        glm::vec4 roundOffset = (roundedOrigin - shadowOrigin) * (2.0f / resolution);
+        lightProjection[3][0] += roundOffset.x;
+        lightProjection[3][1] += roundOffset.y;
+
+        lightSpaceMatrices[cascade] = lightProjection * lightView;
+        frustums[cascade].Extract(lightSpaceMatrices[cascade]);
+
+        //bias of about one and a half texels, expressed in the [0, 1] depth range
+        float texelSize = 2.0f * radius / resolution;
+        depthBias[cascade] = 1.5f * texelSize / (2.0f * radius);
+
+        cachedCenters[cascade] = center;
+        cachedRadius[cascade] = radius;
+        cachedLightDirs[cascade] = lightDirN;
+        staticDirty[cascade] = true;
+        pendingFrames[cascade] = 0;
+    }
+
+    //force the static layer of every cascade to be re-rendered, e.g. after the static geometry moved
+    void CascadedShadowMap::InvalidateStaticLayer() {
+
+        for (int i = 0; i < cascadeCount; i++)
+            staticDirty[i] = true;
+    }
+
+    bool CascadedShadowMap::IsStaticLayerDirty(int cascade) {
+        return staticDirty[cascade];
+    }
+
+    void CascadedShadowMap::StaticLayerUpdated(int cascade) {
+        staticDirty[cascade] = false;
+    }
+
+    //bind the FBO with the layer of the given cascade attached and clear it
+    void CascadedShadowMap::BindForWriting(int cascade, SHADOW_LAYER layer) {
+
+        glBindFramebuffer(GL_FRAMEBUFFER, shadowMapFBO);
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GetTextureId(layer), 0, cascade);
+        glViewport(0, 0, resolution, resolution);
+        glClear(GL_DEPTH_BUFFER_BIT);
+    }
+
+    //bind both texture arrays and send matrices and split depths to the lighting shader
+    void CascadedShadowMap::SetUniforms(gps::Shader& shader, GLint textureUnit) {
+
+        shader.useShaderProgram();
+
+        glActiveTexture(GL_TEXTURE0 + textureUnit);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, staticDepthTexture);
+        glUniform1i(glGetUniformLocation(shader.shaderProgram, "shadowMap"), textureUnit);
+
+        glActiveTexture(GL_TEXTURE0 + textureUnit + 1);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, dynamicDepthTexture);
+        glUniform1i(glGetUniformLocation(shader.shaderProgram, "dynamicShadowMap"), textureUnit + 1);
+
+        glUniformMatrix4fv(glGetUniformLocation(shader.shaderProgram, "lightSpaceTrMatrices"),
+            cascadeCount, GL_FALSE, glm::value_ptr(lightSpaceMatrices[0]));
+        glUniform1fv(glGetUniformLocation(shader.shaderProgram, "cascadeSplits"), cascadeCount, splitDepths);
+        glUniform1fv(glGetUniformLocation(shader.shaderProgram, "cascadeBias"), cascadeCount, depthBias);
+        glUniform1i(glGetUniformLocation(shader.shaderProgram, "cascadeCount"), cascadeCount);
+    }
+
+    void CascadedShadowMap::Delete() {
+
+        GpuMemory::Release(GPU_MEMORY_TEXTURE, staticDepthTexture);
+        GpuMemory::Release(GPU_MEMORY_TEXTURE, dynamicDepthTexture);
+        glDeleteTextures(1, &staticDepthTexture);
+        glDeleteTextures(1, &dynamicDepthTexture);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glDeleteFramebuffers(1, &shadowMapFBO);
+    }
+
+    int CascadedShadowMap::GetCascadeCount() {
+        return cascadeCount;
+    }
+
+    int CascadedShadowMap::GetResolution() {
+        return resolution;
+    }
+
+    glm::mat4 CascadedShadowMap::GetLightSpaceMatrix(int cascade) {
+        return lightSpaceMatrices[cascade];
+    }
+
+    const gps::Frustum& CascadedShadowMap::GetFrustum(int cascade) {
+        return frustums[cascade];
+    }
+
+    GLuint CascadedShadowMap::GetTextureId(SHADOW_LAYER layer) {
+        return layer == SHADOW_LAYER_STATIC ? staticDepthTexture : dynamicDepthTexture;
+    }
+}
@@ -0,0 +1,94 @@
+#ifndef CascadedShadowMap_hpp
+#define CascadedShadowMap_hpp
+
+#if defined (__APPLE__)
+    #define GL_SILENCE_DEPRECATION
+    #include <OpenGL/gl3.h>
+#else
+    #define GLEW_STATIC
+    #include <GL/glew.h>
+#endif
+
+#include "GLDebug.hpp"
+#include "GLIntercept.hpp"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "Shader.hpp"
+#include "Frustum.hpp"
+
+namespace gps {
+
+    const int MAX_SHADOW_CASCADES = 4;
+
+    //static casters are cached between frames, dynamic casters are re-rendered every frame
+    enum SHADOW_LAYER {SHADOW_LAYER_STATIC, SHADOW_LAYER_DYNAMIC};
+
+    class CascadedShadowMap {
+
+    public:
+        //allocate the static and dynamic depth texture arrays (one layer per cascade) and the FBO
+        void Init(int cascadeCount, int resolution, float shadowDistance);
+        //angularThreshold - light rotation in degrees tolerated before a cascade is refitted
+        //coverageMargin - extra radius fraction so the camera can move without refitting
+        //maxStaticUpdatesPerFrame - refits are spread over several frames beyond this count
+        void SetCacheParameters(float angularThreshold, float coverageMargin, int maxStaticUpdatesPerFrame);
+        //refit the cascades whose cached region no longer covers their slice of the camera frustum
+        //fov - vertical field of view in radians
+        //lightDir - direction towards the light
+        void Update(const glm::mat4& viewMatrix, float fov, float aspect, float nearPlane, glm::vec3 lightDir);
+        //force the static layer of every cascade to be re-rendered, e.g. after the static geometry moved
+        void InvalidateStaticLayer();
+        bool IsStaticLayerDirty(int cascade);
+        void StaticLayerUpdated(int cascade);
+        //bind the FBO with the layer of the given cascade attached and clear it
+        void BindForWriting(int cascade, SHADOW_LAYER layer);
+        //bind both texture arrays and send matrices and split depths to the lighting shader
+        //the dynamic layer uses textureUnit + 1
+        void SetUniforms(gps::Shader& shader, GLint textureUnit);
+        void Delete();
+
+        int GetCascadeCount();
+        int GetResolution();
+        glm::mat4 GetLightSpaceMatrix(int cascade);
+        const gps::Frustum& GetFrustum(int cascade);
+        GLuint GetTextureId(SHADOW_LAYER layer);
+
+    private:
+        int cascadeCount;
+        int resolution;
+        float shadowDistance;
+        //lambda blends logarithmic (1) and uniform (0) split distribution
+        float splitLambda = 0.8f;
+
+        //static layer cache parameters
+        float angularThreshold = 0.5f;
+        float coverageMargin = 0.25f;
+        int maxStaticUpdatesPerFrame = 1;
+        bool initialized = false;
+
+        GLuint shadowMapFBO;
+        GLuint staticDepthTexture;
+        GLuint dynamicDepthTexture;
+
+        float splitDepths[MAX_SHADOW_CASCADES];
+        float depthBias[MAX_SHADOW_CASCADES];
+        glm::mat4 lightSpaceMatrices[MAX_SHADOW_CASCADES];
+        gps::Frustum frustums[MAX_SHADOW_CASCADES];
+
+        //region and light direction each cascade was last fitted to
+        glm::vec3 cachedCenters[MAX_SHADOW_CASCADES];
+        float cachedRadius[MAX_SHADOW_CASCADES];
+        glm::vec3 cachedLightDirs[MAX_SHADOW_CASCADES];
+        bool staticDirty[MAX_SHADOW_CASCADES];
+        int pendingFrames[MAX_SHADOW_CASCADES];
+
+        void ComputeSplitDepths(float nearPlane);
+        GLuint CreateDepthArray();
+        void FitCascade(int cascade, glm::vec3 center, float radius, glm::vec3 lightDirN);
+    };
+}
+
+#endif /* CascadedShadowMap_hpp */
@@ -0,0 +1,240 @@
+#include "DrawList.hpp"
+#include "Profiler.hpp"
+#include "AllocationTracker.hpp"
+
+
+namespace gps {
+
+    //cull, pick LODs, compute matrices and sort keys on the worker threads
+    void DrawList::Build(gps::JobSystem& jobs, std::vector<Renderable>& renderables, int objectSets, const DrawView& drawView) {
+        GPS_PROFILE_FUNCTION();
+        GPS_ALLOC_TAG("draw list");
+
+        depthOnly = drawView.depthOnly;
+        int renderableCount = (int)renderables.size();
+        selectedLods.resize(renderableCount);
+        normalMatrices.resize(renderableCount);
+        firstCandidate.resize(renderableCount + 1);
+
+        //stage 1 - per renderable: object set, LOD by distance, whole model culling, normal matrix
+        jobs.ParallelFor(renderableCount, 16, [&](int begin, int end) {
+
+            for (int r = begin; r < end; r++) {
+
+                Renderable& renderable = renderables[r];
+                selectedLods[r] = -1;
+                if ((renderable.objectSet & objectSets) == 0)
+                    continue;
+
+                glm::vec3 worldPosition = glm::vec3(renderable.modelMatrix[3]);
+                float distance = glm::length(worldPosition - drawView.position);
+                int lod = 0;
+                while (lod < renderable.lodCount - 1 && distance > renderable.lodDistances[lod])
+                    lod++;
+
+                if (!drawView.frustum.Intersects(renderable.lods[lod]->GetBounds(), renderable.modelMatrix, drawView.depthOnly))
+                    continue;
+
+                selectedLods[r] = lod;
+                //the view is a rigid transform, so its rotation carries the cached world normal matrix to eye space
+                if (!drawView.depthOnly)
+                    normalMatrices[r] = glm::mat3(drawView.view) * renderable.normalMatrix;
+            }
+        });
+
+        //flatten the meshes of the visible renderables
+        firstCandidate[0] = 0;
+        for (int r = 0; r < renderableCount; r++) {
+
+            int meshCount = selectedLods[r] < 0 ? 0 : renderables[r].lods[selectedLods[r]]->GetMeshCount();
+            firstCandidate[r + 1] = firstCandidate[r] + meshCount;
+        }
+        candidates.resize(firstCandidate[renderableCount]);
+
+        //stage 2 - per mesh: culling and sort key
+        glm::mat4 viewProjection = drawView.projection * drawView.view;
+        jobs.ParallelFor(renderableCount, 4, [&](int begin, int end) {
+
+            for (int r = begin; r < end; r++) {
+
+                if (selectedLods[r] < 0)
+                    continue;
+
+                Renderable& renderable = renderables[r];
+                gps::Model3D* model = renderable.lods[selectedLods[r]];
+                for (int m = 0; m < model->GetMeshCount(); m++) {
+
+                    DrawItem& item = candidates[firstCandidate[r] + m];
+                    item.mesh = model->GetMesh(m);
+                    item.gpuTimerName = renderable.gpuTimerName;
+                    item.modelMatrix = renderable.modelMatrix;
+                    item.normalMatrix = normalMatrices[r];
+                    item.lod = selectedLods[r];
+
+                    BoundingBox bounds = item.mesh->getBounds();
+                    item.visible = drawView.frustum.Intersects(bounds, item.modelMatrix, drawView.depthOnly);
+                    if (!item.visible)
+                        continue;
+
+                    //depth of the mesh center in [0, 1]
+                    glm::vec4 worldCenter = item.modelMatrix * glm::vec4((bounds.min + bounds.max) * 0.5f, 1.0f);
+                    glm::vec4 center = viewProjection * worldCenter;
+                    float depth = center.z / glm::max(center.w, 0.0001f) * 0.5f + 0.5f;
+
+                    //nearest possible view depth of the mesh, the scale is bounded by the longest model axis
+                    float scale = glm::max(glm::length(glm::vec3(item.modelMatrix[0])),
+                        glm::max(glm::length(glm::vec3(item.modelMatrix[1])), glm::length(glm::vec3(item.modelMatrix[2]))));
+                    float radius = glm::length(bounds.max - bounds.min) * 0.5f * scale;
+                    float nearestDepth = -(drawView.view * worldCenter).z - radius;
+                    item.program = nearestDepth > drawView.distantDepth ? drawView.distantProgram : drawView.program;
+
+                    //depth only draws do not sample textures, they are just ordered front to back
+                    GLuint material = drawView.depthOnly ? 0 : item.mesh->getMaterialId();
+                    item.sortKey = gps::RenderQueue::MakeKey(drawView.pass, item.program, material, depth);
+                }
+            }
+        });
+
+        //compact and order the visible draws
+        items.clear();
+        queue.Clear();
+        for (size_t c = 0; c < candidates.size(); c++) {
+
+            if (candidates[c].visible) {
+                queue.Push(candidates[c].sortKey, (int)items.size());
+                items.push_back(candidates[c]);
+            }
+        }
+        queue.Sort();
+
+        ComputeStats(renderables, objectSets);
+    }
+
+    //count the state changes the scene order would cause and the ones the sorted order causes
+    void DrawList::ComputeStats(const std::vector<Renderable>& renderables, int objectSets) {
+
+        stats.renderables = 0;
+        stats.culledRenderables = 0;
+        for (size_t r = 0; r < renderables.size(); r++) {
+
+            if ((renderables[r].objectSet & objectSets) == 0)
+                continue;
+            stats.renderables++;
+            if (selectedLods[r] < 0)
+                stats.culledRenderables++;
+        }
+        stats.meshes = (int)candidates.size();
+        stats.culledMeshes = (int)(candidates.size() - items.size());
+        stats.triangles = 0;
+        for (size_t i = 0; i < items.size(); i++)
+            stats.triangles += items[i].mesh->indices.size() / 3;
+
+        RenderQueueStats* orders[2] = { &stats.unsorted, &stats.sorted };
+        for (int o = 0; o < 2; o++) {
+
+            RenderQueueStats& counters = *orders[o];
+            counters.draws = (int)items.size();
+            counters.programChanges = 0;
+            counters.materialChanges = 0;
+            counters.meshChanges = 0;
+
+            unsigned long long previousKey = 0;
+            gps::Mesh* previousMesh = NULL;
+            for (int i = 0; i < (int)items.size(); i++) {
+
+                const DrawItem& item = o == 0 ? items[i] : items[queue.GetPayload(i)];
+                if (i == 0 || gps::RenderQueue::GetProgram(item.sortKey) != gps::RenderQueue::GetProgram(previousKey))
+                    counters.programChanges++;
+                if (i == 0 || gps::RenderQueue::GetMaterial(item.sortKey) != gps::RenderQueue::GetMaterial(previousKey))
+                    counters.materialChanges++;
+                if (item.mesh != previousMesh)
+                    counters.meshChanges++;
+
+                previousKey = item.sortKey;
+                previousMesh = item.mesh;
+            }
+        }
+    }
+
+    //issue the prepared draws in key order, GL thread only
+    //textures are only rebound when the material changes
+    void DrawList::Submit() {
+        GPS_PROFILE_FUNCTION();
+        GPS_ALLOC_TAG("draw list");
+
+        gps::Shader shader;
+        shader.shaderProgram = 0;
+        GLint modelLoc = -1;
+        GLint normalMatrixLoc = -1;
+
+        bool rebindMaterial = true;
+        unsigned int boundMaterial = 0;
+        size_t boundTextureCount = 0;
+        for (int i = 0; i < queue.GetSize(); i++) {
+
+            DrawItem& item = items[queue.GetPayload(i)];
+            if (item.program != shader.shaderProgram) {
+                shader.shaderProgram = item.program;
+                shader.useShaderProgram();
+                modelLoc = glGetUniformLocation(shader.shaderProgram, "model");
+                normalMatrixLoc = glGetUniformLocation(shader.shaderProgram, "normalMatrix");
+                //sampler uniforms belong to the program
+                rebindMaterial = true;
+            }
+
+            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(item.modelMatrix));
+
+            if (!depthOnly) {
+                glUniformMatrix3fv(normalMatrixLoc, 1, GL_FALSE, glm::value_ptr(item.normalMatrix));
+
+                unsigned int material = gps::RenderQueue::GetMaterial(item.sortKey);
+                if (rebindMaterial || material != boundMaterial) {
+                    item.mesh->BindTextures(shader);
+
+                    //units the previous material used and this one does not
+                    for (size_t t = item.mesh->textures.size(); t < boundTextureCount; t++) {
+                        glActiveTexture(GL_TEXTURE0 + (GLenum)t);
+                        glBindTexture(GL_TEXTURE_2D, 0);
+                    }
+
+                    boundMaterial = material;
+                    boundTextureCount = item.mesh->textures.size();
+                    rebindMaterial = false;
+                }
+            }
+
+            bool timed = gpuProfiler != nullptr && item.gpuTimerName != nullptr;
+            if (timed)
+                gpuProfiler->BeginScope(item.gpuTimerName);
+
+            if (depthOnly)
+                item.mesh->DrawPositions();
+            else
+                item.mesh->DrawGeometry();
+
+            if (timed)
+                gpuProfiler->EndScope();
+        }
+
+        for (size_t t = 0; t < boundTextureCount; t++) {
+            glActiveTexture(GL_TEXTURE0 + (GLenum)t);
+            glBindTexture(GL_TEXTURE_2D, 0);
+        }
+    }
+
+    void DrawList::SetGpuProfiler(gps::GpuProfiler* gpuProfiler) {
+        this->gpuProfiler = gpuProfiler;
+    }
+
+    int DrawList::GetSize() {
+        return (int)items.size();
+    }
+
+    const DrawItem& DrawList::GetItem(int index) {
+        return items[queue.GetPayload(index)];
+    }
+
+    DrawListStats DrawList::GetStats() {
+        return stats;
+    }
+}
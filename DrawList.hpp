@@ -0,0 +1,109 @@
+#ifndef DrawList_hpp
+#define DrawList_hpp
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_inverse.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "Model3D.hpp"
+#include "Frustum.hpp"
+#include "JobSystem.hpp"
+#include "RenderQueue.hpp"
+#include "GpuProfiler.hpp"
+
+#include <vector>
+
+namespace gps {
+
+    const int MAX_LODS = 4;
+
+    //a model instance in the scene
+    struct Renderable {
+        //lods[0] is the most detailed model, lods[i] is used up to lodDistances[i]
+        gps::Model3D* lods[MAX_LODS];
+        float lodDistances[MAX_LODS];
+        int lodCount;
+        glm::mat4 modelMatrix;
+        //world space normal matrix, inverse transpose of the model matrix
+        glm::mat3 normalMatrix;
+        //OBJECT_SET the instance belongs to
+        int objectSet;
+        //draws of the instance are timed on the GPU under this name (GpuProfiler::Intern), NULL for none
+        const char* gpuTimerName;
+    };
+
+    //the point of view a draw list is built for
+    struct DrawView {
+        //render pass the draws belong to, top bits of the sort key
+        unsigned int pass;
+        glm::mat4 view;
+        glm::mat4 projection;
+        glm::vec3 position;
+        gps::Frustum frustum;
+        //depth only lists skip the normal matrices and cull without the near plane
+        bool depthOnly;
+        GLuint program;
+        //draws lying entirely beyond distantDepth (view space) use distantProgram,
+        //e.g. a permutation without the shadow lookup past the shadow distance
+        GLuint distantProgram;
+        float distantDepth;
+    };
+
+    struct DrawItem {
+        gps::Mesh* mesh;
+        GLuint program;
+        const char* gpuTimerName;
+        glm::mat4 modelMatrix;
+        glm::mat3 normalMatrix;
+        unsigned long long sortKey;
+        int lod;
+        bool visible;
+    };
+
+    //state changes of the list in submission order (sorted) and in scene order (unsorted)
+    //culling: renderables of the object sets and meshes of their selected LODs, before and after the frustum test
+    struct DrawListStats {
+        RenderQueueStats sorted;
+        RenderQueueStats unsorted;
+        int renderables;
+        int culledRenderables;
+        int meshes;
+        int culledMeshes;
+        long long triangles;
+    };
+
+    class DrawList {
+
+    public:
+        //cull, pick LODs, compute matrices and sort keys on the worker threads
+        void Build(gps::JobSystem& jobs, std::vector<Renderable>& renderables, int objectSets, const DrawView& drawView);
+        //issue the prepared draws in key order, GL thread only
+        //programs are switched when the key changes, textures are only rebound when the material changes
+        //per frame uniforms have to be set on every program of the list beforehand
+        void Submit();
+        //times the draws of renderables with a gpuTimerName, NULL turns it off
+        void SetGpuProfiler(gps::GpuProfiler* gpuProfiler);
+
+        int GetSize();
+        const DrawItem& GetItem(int index);
+        DrawListStats GetStats();
+
+    private:
+        bool depthOnly;
+        gps::GpuProfiler* gpuProfiler = nullptr;
+
+        //per renderable results of the first stage
+        std::vector<int> selectedLods;
+        std::vector<glm::mat3> normalMatrices;
+        std::vector<int> firstCandidate;
+        //one slot per mesh of every visible renderable
+        std::vector<DrawItem> candidates;
+        std::vector<DrawItem> items;
+        gps::RenderQueue queue;
+        DrawListStats stats;
+
+        void ComputeStats(const std::vector<Renderable>& renderables, int objectSets);
+    };
+}
+
+#endif /* DrawList_hpp */
@@ -0,0 +1,60 @@
+#include "Frustum.hpp"
+
+namespace gps {
+
+    //extract the six clip planes from a (projection * view) matrix
+    void Frustum::Extract(const glm::mat4& viewProjection) {
+
+        //glm is column major, so row i is (m[0][i], m[1][i], m[2][i], m[3][i])
+        glm::vec4 row0(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]);
+        glm::vec4 row1(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+        glm::vec4 row2(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]);
+        glm::vec4 row3(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+
+        planes[PLANE_LEFT] = row3 + row0;
+        planes[PLANE_RIGHT] = row3 - row0;
+        planes[PLANE_BOTTOM] = row3 + row1;
+        planes[PLANE_TOP] = row3 - row1;
+        planes[PLANE_NEAR] = row3 + row2;
+        planes[PLANE_FAR] = row3 - row2;
+
+        for (int i = 0; i < 6; i++) {
+
+            float length = glm::length(glm::vec3(planes[i]));
+            planes[i] = planes[i] / length;
+        }
+    }
+
+    //test a model space bounding box transformed by modelMatrix against the planes
+    bool Frustum::Intersects(const BoundingBox& box, const glm::mat4& modelMatrix, bool ignoreNearPlane) const {
+
+        //world space box as center + extents
+        glm::vec3 center = glm::vec3(modelMatrix * glm::vec4((box.min + box.max) * 0.5f, 1.0f));
+        glm::vec3 localExtents = (box.max - box.min) * 0.5f;
+        glm::vec3 extents;
+        for (int i = 0; i < 3; i++) {
+
+            extents[i] = glm::abs(modelMatrix[0][i]) * localExtents.x
+                + glm::abs(modelMatrix[1][i]) * localExtents.y
+                + glm::abs(modelMatrix[2][i]) * localExtents.z;
+        }
+
+        for (int i = 0; i < 6; i++) {
+
+            if (ignoreNearPlane && i == PLANE_NEAR)
+                continue;
+
+            glm::vec3 normal = glm::vec3(planes[i]);
+            float distance = glm::dot(normal, center) + planes[i].w;
+            float radius = glm::dot(glm::abs(normal), extents);
+            if (distance + radius < 0.0f)
+                return false;
+        }
+
+        return true;
+    }
+
+    glm::vec4 Frustum::GetPlane(FRUSTUM_PLANE plane) const {
+        return planes[plane];
+    }
+}
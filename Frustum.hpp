@@ -0,0 +1,32 @@
+#ifndef Frustum_hpp
+#define Frustum_hpp
+
+#include <glm/glm.hpp>
+
+namespace gps {
+
+    struct BoundingBox {
+
+        glm::vec3 min;
+        glm::vec3 max;
+    };
+
+    enum FRUSTUM_PLANE {PLANE_LEFT, PLANE_RIGHT, PLANE_BOTTOM, PLANE_TOP, PLANE_NEAR, PLANE_FAR};
+
+    class Frustum {
+
+    public:
+        //extract the six clip planes from a (projection * view) matrix
+        void Extract(const glm::mat4& viewProjection);
+        //test a model space bounding box transformed by modelMatrix against the planes
+        //ignoreNearPlane - used for shadow casters that sit between the light and the frustum
+        bool Intersects(const BoundingBox& box, const glm::mat4& modelMatrix, bool ignoreNearPlane = false) const;
+        glm::vec4 GetPlane(FRUSTUM_PLANE plane) const;
+
+    private:
+        // (a, b, c, d) with the normal pointing inside the frustum
+        glm::vec4 planes[6];
+    };
+}
+
+#endif /* Frustum_hpp */
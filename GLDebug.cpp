@@ -0,0 +1,166 @@
+#include "GLDebug.hpp"
+
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+namespace gps {
+
+#if defined (GPS_GL_DEBUG)
+
+    static bool debugOutput = false;
+    //pushed and popped on the GL thread, the callback only reads the innermost group
+    static std::vector<const char*> groups;
+    static std::atomic<const char*> currentGroup(nullptr);
+    static std::mutex printMutex;
+
+    static const char* SourceName(GLenum source) {
+        switch (source) {
+        case GL_DEBUG_SOURCE_API: return "API";
+        case GL_DEBUG_SOURCE_WINDOW_SYSTEM: return "window system";
+        case GL_DEBUG_SOURCE_SHADER_COMPILER: return "shader compiler";
+        case GL_DEBUG_SOURCE_THIRD_PARTY: return "third party";
+        case GL_DEBUG_SOURCE_APPLICATION: return "application";
+        default: return "other";
+        }
+    }
+
+    static const char* TypeName(GLenum type) {
+        switch (type) {
+        case GL_DEBUG_TYPE_ERROR: return "error";
+        case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "deprecated";
+        case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR: return "undefined behavior";
+        case GL_DEBUG_TYPE_PORTABILITY: return "portability";
+        case GL_DEBUG_TYPE_PERFORMANCE: return "performance";
+        case GL_DEBUG_TYPE_MARKER: return "marker";
+        default: return "other";
+        }
+    }
+
+    static const char* SeverityName(GLenum severity) {
+        switch (severity) {
+        case GL_DEBUG_SEVERITY_HIGH: return "high";
+        case GL_DEBUG_SEVERITY_MEDIUM: return "medium";
+        case GL_DEBUG_SEVERITY_LOW: return "low";
+        default: return "notification";
+        }
+    }
+
+    static void GLAPIENTRY DebugCallback(GLenum source, GLenum type, GLuint id, GLenum severity,
+        GLsizei length, const GLchar* message, const void* userParam) {
+
+        const char* group = currentGroup.load(std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(printMutex);
+        std::cerr << "GL " << TypeName(type) << " (" << SeverityName(severity) << ", " << SourceName(source)
+            << " " << id << ")";
+        if (group != nullptr) {
+            std::cerr << " in " << group;
+        }
+        std::cerr << ": " << std::string(message, length >= 0 ? length : strlen(message)) << std::endl;
+    }
+
+    bool GLDebug::Init(GLenum minimumSeverity) {
+        if (!GLEW_KHR_debug && !GLEW_VERSION_4_3) {
+            std::cout << "GL debug output not available, GL errors are not reported" << std::endl;
+            return false;
+        }
+
+        GLint flags = 0;
+        glGetIntegerv(GL_CONTEXT_FLAGS, &flags);
+        if ((flags & GL_CONTEXT_FLAG_DEBUG_BIT) == 0) {
+            std::cout << "The context is not a debug context, the driver may report less" << std::endl;
+        }
+
+        glEnable(GL_DEBUG_OUTPUT);
+        //messages arrive inside the call that caused them, so the group is the one the call was made in
+        glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+        glDebugMessageCallback(DebugCallback, nullptr);
+
+        //everything off, then the severities from minimumSeverity up
+        const GLenum severities[] = { GL_DEBUG_SEVERITY_HIGH, GL_DEBUG_SEVERITY_MEDIUM, GL_DEBUG_SEVERITY_LOW, GL_DEBUG_SEVERITY_NOTIFICATION };
+        glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_FALSE);
+        for (GLenum severity : severities) {
+            glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, severity, 0, nullptr, GL_TRUE);
+            if (severity == minimumSeverity) {
+                break;
+            }
+        }
+        //our own groups would echo back as notifications
+        glDebugMessageControl(GL_DEBUG_SOURCE_APPLICATION, GL_DEBUG_TYPE_PUSH_GROUP, GL_DONT_CARE, 0, nullptr, GL_FALSE);
+        glDebugMessageControl(GL_DEBUG_SOURCE_APPLICATION, GL_DEBUG_TYPE_POP_GROUP, GL_DONT_CARE, 0, nullptr, GL_FALSE);
+
+        debugOutput = true;
+        std::cout << "GL debug output enabled from " << SeverityName(minimumSeverity) << " severity" << std::endl;
+        return true;
+    }
+
+    bool GLDebug::IsEnabled() {
+        return debugOutput;
+    }
+
+    void GLDebug::Label(GLenum identifier, GLuint name, const std::string& label) {
+        if (debugOutput && name != 0) {
+            glObjectLabel(identifier, name, (GLsizei)label.size(), label.c_str());
+        }
+    }
+
+    void GLDebug::PushGroup(const char* name) {
+        if (!debugOutput) {
+            return;
+        }
+        glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, name);
+        groups.push_back(name);
+        currentGroup.store(name, std::memory_order_relaxed);
+    }
+
+    void GLDebug::PopGroup() {
+        if (!debugOutput || groups.empty()) {
+            return;
+        }
+        glPopDebugGroup();
+        groups.pop_back();
+        currentGroup.store(groups.empty() ? nullptr : groups.back(), std::memory_order_relaxed);
+    }
+
+#else
+
+    bool GLDebug::Init(GLenum minimumSeverity) {
+        return false;
+    }
+
+    bool GLDebug::IsEnabled() {
+        return false;
+    }
+
+    void GLDebug::Label(GLenum identifier, GLuint name, const std::string& label) {
+    }
+
+    void GLDebug::PushGroup(const char* name) {
+    }
+
+    void GLDebug::PopGroup() {
+    }
+
+#endif
+
+    bool GLDebug::ParseSeverity(std::string name, GLenum& severity) {
+        if (name == "high") {
+            severity = GL_DEBUG_SEVERITY_HIGH;
+        }
+        else if (name == "medium") {
+            severity = GL_DEBUG_SEVERITY_MEDIUM;
+        }
+        else if (name == "low") {
+            severity = GL_DEBUG_SEVERITY_LOW;
+        }
+        else if (name == "notification") {
+            severity = GL_DEBUG_SEVERITY_NOTIFICATION;
+        }
+        else {
+            return false;
+        }
+        return true;
+    }
+}
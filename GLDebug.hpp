@@ -0,0 +1,72 @@
+#ifndef GLDebug_hpp
+#define GLDebug_hpp
+
+#if defined (__APPLE__)
+    #define GL_SILENCE_DEPRECATION
+    #include <OpenGL/gl3.h>
+#else
+    #define GLEW_STATIC
+    #include <GL/glew.h>
+#endif
+
+#include <string>
+
+//the severities are parsed on every platform
+#if !defined (GL_DEBUG_SEVERITY_HIGH)
+    #define GL_DEBUG_SEVERITY_HIGH 0x9146
+    #define GL_DEBUG_SEVERITY_MEDIUM 0x9147
+    #define GL_DEBUG_SEVERITY_LOW 0x9148
+    #define GL_DEBUG_SEVERITY_NOTIFICATION 0x826B
+#endif
+
+//debug builds report GL errors and warnings through KHR_debug, release builds compile all of it out
+//unless GPS_GL_DEBUG is defined, macOS stops at GL 4.1 and has no KHR_debug
+#if !defined (GPS_GL_DEBUG) && !defined (NDEBUG) && !defined (__APPLE__)
+    #define GPS_GL_DEBUG
+#endif
+
+#if defined (GPS_GL_DEBUG)
+    #define GPS_GL_DEBUG_CONCAT_(a, b) a##b
+    #define GPS_GL_DEBUG_CONCAT(a, b) GPS_GL_DEBUG_CONCAT_(a, b)
+    //identifier is GL_TEXTURE, GL_VERTEX_ARRAY, GL_PROGRAM, GL_FRAMEBUFFER..., the label is only built in debug builds
+    #define GPS_GL_LABEL(identifier, name, label) gps::GLDebug::Label(identifier, name, label)
+    #define GPS_GL_DEBUG_GROUP(name) gps::GLDebugGroup GPS_GL_DEBUG_CONCAT(glDebugGroup, __LINE__)(name)
+#else
+    #define GPS_GL_LABEL(identifier, name, label) ((void)0)
+    #define GPS_GL_DEBUG_GROUP(name) ((void)0)
+#endif
+
+namespace gps {
+
+    //driver messages through a KHR_debug callback instead of polling glGetError
+    //the output is synchronous, a message arrives inside the call that caused it
+    class GLDebug {
+
+    public:
+        //after the context is created, false when the context has no debug output
+        //messages below minimumSeverity are dropped by the driver
+        static bool Init(GLenum minimumSeverity);
+        static bool IsEnabled();
+        //"high", "medium", "low" or "notification"
+        static bool ParseSeverity(std::string name, GLenum& severity);
+
+        static void Label(GLenum identifier, GLuint name, const std::string& label);
+        //name must outlive the group, a string literal or a pass name
+        static void PushGroup(const char* name);
+        static void PopGroup();
+    };
+
+    class GLDebugGroup {
+
+    public:
+        explicit GLDebugGroup(const char* name) {
+            GLDebug::PushGroup(name);
+        }
+
+        ~GLDebugGroup() {
+            GLDebug::PopGroup();
+        }
+    };
+}
+
+#endif /* GLDebug_hpp */
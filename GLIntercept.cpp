@@ -0,0 +1,212 @@
+#include "GLIntercept.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+namespace gps {
+
+    struct GLCallCount {
+        int calls = 0;
+        long long nanoseconds = 0;
+    };
+
+    struct GLCallSite {
+        const char* name;
+        const char* file;
+        int line;
+        GLCallCount count;
+    };
+
+    static const char* categoryNames[GL_CALL_CATEGORY_COUNT] = {
+        "uniform", "uniform_location", "texture", "program", "draw", "state", "resource", "shader", "query"
+    };
+
+    //GL calls only happen on the main thread, so nothing here is locked
+    //the keys are the string literals of the forwarders and __FILE__, so pointers are enough
+    //entries stay once seen and only their counts are reset, so Record allocates only for new entry points and sites
+    static std::map<const char*, GLCallCount> frameCalls;
+    static std::map<std::pair<const char*, int>, GLCallSite> frameSites;
+    static GLCallCount frameCategories[GL_CALL_CATEGORY_COUNT];
+
+    //the last finished frame, for the summary
+    static std::map<const char*, GLCallCount> lastCalls;
+    static std::vector<GLCallSite> lastSites;
+    static GLCallCount lastCategories[GL_CALL_CATEGORY_COUNT];
+    static long long lastFrame = -1;
+
+    static std::vector<int> budgets(GL_CALL_CATEGORY_COUNT, -1);
+    static long long frameIndex = 0;
+    static int budgetViolations = 0;
+
+    //the call sites of the summary and of a budget violation
+    static const int SUMMARY_SITES = 10;
+
+    void GLIntercept::Record(const char* name, GL_CALL_CATEGORY category, const char* file, int line, long long nanoseconds) {
+        GLCallCount& call = frameCalls[name];
+        call.calls++;
+        call.nanoseconds += nanoseconds;
+
+        GLCallSite& site = frameSites[std::make_pair(file, line)];
+        site.name = name;
+        site.file = file;
+        site.line = line;
+        site.count.calls++;
+        site.count.nanoseconds += nanoseconds;
+
+        frameCategories[category].calls++;
+        frameCategories[category].nanoseconds += nanoseconds;
+    }
+
+    void GLIntercept::SetBudget(GL_CALL_CATEGORY category, int maxCallsPerFrame) {
+        budgets[category] = maxCallsPerFrame;
+    }
+
+    bool GLIntercept::ParseBudgets(std::string list) {
+        std::stringstream stream(list);
+        std::string entry;
+        while (std::getline(stream, entry, ',')) {
+            size_t separator = entry.find('=');
+            if (separator == std::string::npos) {
+                std::cerr << "GL budget without a value: " << entry << std::endl;
+                return false;
+            }
+
+            std::string name = entry.substr(0, separator);
+            int category = 0;
+            while (category < GL_CALL_CATEGORY_COUNT && name != categoryNames[category]) {
+                category++;
+            }
+            if (category == GL_CALL_CATEGORY_COUNT) {
+                std::cerr << "Unknown GL budget category: " << name << std::endl;
+                return false;
+            }
+
+            std::string value = entry.substr(separator + 1);
+            char* end = nullptr;
+            long maxCalls = strtol(value.c_str(), &end, 10);
+            if (value.empty() || *end != '\0' || maxCalls < 0) {
+                std::cerr << "GL budget is not a call count: " << entry << std::endl;
+                return false;
+            }
+            SetBudget((GL_CALL_CATEGORY)category, (int)maxCalls);
+        }
+        return true;
+    }
+
+    const char* GLIntercept::GetCategoryName(GL_CALL_CATEGORY category) {
+        return categoryNames[category];
+    }
+
+    bool GLIntercept::EndFrame() {
+        for (auto& call : frameCalls) {
+            lastCalls[call.first] = call.second;
+            call.second = GLCallCount();
+        }
+
+        lastSites.clear();
+        for (auto& site : frameSites) {
+            if (site.second.count.calls > 0) {
+                lastSites.push_back(site.second);
+            }
+            site.second.count = GLCallCount();
+        }
+        std::sort(lastSites.begin(), lastSites.end(), [](const GLCallSite& a, const GLCallSite& b) {
+            return a.count.calls > b.count.calls;
+        });
+
+        std::copy(frameCategories, frameCategories + GL_CALL_CATEGORY_COUNT, lastCategories);
+        std::fill(frameCategories, frameCategories + GL_CALL_CATEGORY_COUNT, GLCallCount());
+        lastFrame = frameIndex++;
+
+        bool withinBudget = true;
+        for (int category = 0; category < GL_CALL_CATEGORY_COUNT; category++) {
+            if (budgets[category] < 0 || lastCategories[category].calls <= budgets[category]) {
+                continue;
+            }
+
+            std::cerr << "GL budget exceeded in frame " << lastFrame << ": " << lastCategories[category].calls
+                << " " << categoryNames[category] << " calls, budget " << budgets[category] << std::endl;
+            withinBudget = false;
+        }
+
+        if (!withinBudget) {
+            budgetViolations++;
+            PrintFrameSummary();
+        }
+        return withinBudget;
+    }
+
+    void GLIntercept::ResetFrame() {
+        for (auto& call : frameCalls) {
+            call.second = GLCallCount();
+        }
+        for (auto& site : frameSites) {
+            site.second.count = GLCallCount();
+        }
+        std::fill(frameCategories, frameCategories + GL_CALL_CATEGORY_COUNT, GLCallCount());
+    }
+
+    void GLIntercept::PrintFrameSummary() {
+        if (lastFrame < 0) {
+            std::cout << "No GL calls recorded" << (IsEnabled() ? "" : " (build with GPS_GL_INTERCEPT)") << std::endl;
+            return;
+        }
+
+        std::cout << "GL calls in frame " << lastFrame << std::endl;
+        std::cout << std::fixed << std::setprecision(3);
+        for (int category = 0; category < GL_CALL_CATEGORY_COUNT; category++) {
+            std::cout << "  " << std::left << std::setw(18) << categoryNames[category] << std::right
+                << std::setw(7) << lastCategories[category].calls
+                << std::setw(10) << lastCategories[category].nanoseconds / 1000000.0 << " ms";
+            if (budgets[category] >= 0) {
+                std::cout << "  (budget " << budgets[category] << ")";
+            }
+            std::cout << std::endl;
+        }
+
+        //entry points not called in that frame are still in the map with no calls
+        std::vector<std::pair<const char*, GLCallCount>> calls;
+        for (auto& call : lastCalls) {
+            if (call.second.calls > 0) {
+                calls.push_back(call);
+            }
+        }
+        std::sort(calls.begin(), calls.end(), [](const std::pair<const char*, GLCallCount>& a, const std::pair<const char*, GLCallCount>& b) {
+            return a.second.calls > b.second.calls;
+        });
+        std::cout << " by entry point" << std::endl;
+        for (auto& call : calls) {
+            std::cout << "  " << std::left << std::setw(24) << call.first << std::right
+                << std::setw(7) << call.second.calls
+                << std::setw(10) << call.second.nanoseconds / 1000000.0 << " ms" << std::endl;
+        }
+
+        std::cout << " by call site" << std::endl;
+        for (size_t i = 0; i < lastSites.size() && i < SUMMARY_SITES; i++) {
+            const GLCallSite& site = lastSites[i];
+            std::cout << "  " << std::left << std::setw(24) << site.name << std::right
+                << std::setw(7) << site.count.calls
+                << std::setw(10) << site.count.nanoseconds / 1000000.0 << " ms  "
+                << site.file << ":" << site.line << std::endl;
+        }
+        std::cout << std::defaultfloat;
+    }
+
+    int GLIntercept::GetBudgetViolationCount() {
+        return budgetViolations;
+    }
+
+    bool GLIntercept::IsEnabled() {
+#if defined (GPS_GL_INTERCEPT)
+        return true;
+#else
+        return false;
+#endif
+    }
+}
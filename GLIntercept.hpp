@@ -0,0 +1,362 @@
+#ifndef GLIntercept_hpp
+#define GLIntercept_hpp
+
+#if defined (__APPLE__)
+    #define GL_SILENCE_DEPRECATION
+    #include <OpenGL/gl3.h>
+#else
+    #define GLEW_STATIC
+    #include <GL/glew.h>
+#endif
+
+#include "GLTrace.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <string>
+
+namespace gps {
+
+    //the groups budgets are set for
+    enum GL_CALL_CATEGORY {
+        GL_CALLS_UNIFORM,
+        GL_CALLS_UNIFORM_LOCATION,
+        GL_CALLS_TEXTURE,
+        GL_CALLS_PROGRAM,
+        GL_CALLS_DRAW,
+        GL_CALLS_STATE,
+        GL_CALLS_RESOURCE,
+        GL_CALLS_SHADER,
+        GL_CALLS_QUERY,
+        GL_CALL_CATEGORY_COUNT
+    };
+
+    //counts of the intercepted GL calls by entry point and by call site, and the CPU time spent in them
+    //only builds with GPS_GL_INTERCEPT route the calls through here, see the end of this header
+    class GLIntercept {
+
+    public:
+        static void Record(const char* name, GL_CALL_CATEGORY category, const char* file, int line, long long nanoseconds);
+        //-1 is no budget
+        static void SetBudget(GL_CALL_CATEGORY category, int maxCallsPerFrame);
+        //"uniform=200,draw=100", the names are those of GetCategoryName
+        static bool ParseBudgets(std::string budgets);
+        static const char* GetCategoryName(GL_CALL_CATEGORY category);
+        //GL thread, once per frame: false when the frame went over a budget
+        static bool EndFrame();
+        //drops the calls counted since the last EndFrame, before the first frame so the setup is not counted
+        static void ResetFrame();
+        //the calls of the last finished frame, the busiest call sites first
+        static void PrintFrameSummary();
+        static int GetBudgetViolationCount();
+        static bool IsEnabled();
+    };
+
+    class GLCallTimer {
+
+    public:
+        GLCallTimer(const char* name, GL_CALL_CATEGORY category, const char* file, int line)
+            : name(name), category(category), file(file), line(line), start(std::chrono::steady_clock::now()) {
+        }
+
+        ~GLCallTimer() {
+            long long nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+            GLIntercept::Record(name, category, file, line, nanoseconds);
+        }
+
+    private:
+        const char* name;
+        GL_CALL_CATEGORY category;
+        const char* file;
+        int line;
+        std::chrono::steady_clock::time_point start;
+    };
+}
+
+#if defined (GPS_GL_INTERCEPT)
+
+//timed forwarders to the real entry points, defined while the names still refer to them (GLEW pointers or exports)
+//the arguments are converted and evaluated before the timer starts, so only the driver call is measured,
+//a running capture records the call after it returned, with the names it generated
+#define GPS_GL_UNPACK(...) __VA_ARGS__
+#define GPS_GL_TRACE(function, traced) \
+    if (gps::GLTrace::IsCapturing()) { \
+        gps::GLTrace::BeginCommand(gps::GL_TRACE_##function); \
+        gps::GLTrace::Write traced; \
+    }
+#define GPS_GL_FORWARD(function, category, parameters, arguments, traced) \
+    inline void gpsIntercepted_##function(const char* file, int line, GPS_GL_UNPACK parameters) { \
+        { \
+            gps::GLCallTimer timer(#function, category, file, line); \
+            function arguments; \
+        } \
+        GPS_GL_TRACE(function, traced) \
+    }
+#define GPS_GL_FORWARD_RESULT(function, category, result, parameters, arguments, traced) \
+    inline result gpsIntercepted_##function(const char* file, int line, GPS_GL_UNPACK parameters) { \
+        result value; \
+        { \
+            gps::GLCallTimer timer(#function, category, file, line); \
+            value = function arguments; \
+        } \
+        GPS_GL_TRACE(function, traced) \
+        return value; \
+    }
+
+GPS_GL_FORWARD(glUniform1i, gps::GL_CALLS_UNIFORM, (GLint location, GLint v0), (location, v0), (location, v0))
+GPS_GL_FORWARD(glUniform1f, gps::GL_CALLS_UNIFORM, (GLint location, GLfloat v0), (location, v0), (location, v0))
+GPS_GL_FORWARD(glUniform1fv, gps::GL_CALLS_UNIFORM, (GLint location, GLsizei count, const GLfloat* value), (location, count, value), (location, count, gps::GLTraceData(value, count * sizeof(GLfloat))))
+GPS_GL_FORWARD(glUniform2f, gps::GL_CALLS_UNIFORM, (GLint location, GLfloat v0, GLfloat v1), (location, v0, v1), (location, v0, v1))
+GPS_GL_FORWARD(glUniform3fv, gps::GL_CALLS_UNIFORM, (GLint location, GLsizei count, const GLfloat* value), (location, count, value), (location, count, gps::GLTraceData(value, count * 3 * sizeof(GLfloat))))
+GPS_GL_FORWARD(glUniform3i, gps::GL_CALLS_UNIFORM, (GLint location, GLint v0, GLint v1, GLint v2), (location, v0, v1, v2), (location, v0, v1, v2))
+GPS_GL_FORWARD(glUniformMatrix3fv, gps::GL_CALLS_UNIFORM, (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value), (location, count, transpose, value), (location, count, transpose, gps::GLTraceData(value, count * 9 * sizeof(GLfloat))))
+GPS_GL_FORWARD(glUniformMatrix4fv, gps::GL_CALLS_UNIFORM, (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value), (location, count, transpose, value), (location, count, transpose, gps::GLTraceData(value, count * 16 * sizeof(GLfloat))))
+GPS_GL_FORWARD_RESULT(glGetUniformLocation, gps::GL_CALLS_UNIFORM_LOCATION, GLint, (GLuint program, const GLchar* name), (program, name), (program, gps::GLTraceData(name, strlen(name) + 1), value))
+GPS_GL_FORWARD(glBindTexture, gps::GL_CALLS_TEXTURE, (GLenum target, GLuint texture), (target, texture), (target, texture))
+GPS_GL_FORWARD(glActiveTexture, gps::GL_CALLS_TEXTURE, (GLenum texture), (texture), (texture))
+GPS_GL_FORWARD(glUseProgram, gps::GL_CALLS_PROGRAM, (GLuint program), (program), (program))
+GPS_GL_FORWARD(glDrawElements, gps::GL_CALLS_DRAW, (GLenum mode, GLsizei count, GLenum type, const void* indices), (mode, count, type, indices), (mode, count, type, gps::GLTraceOffset(indices)))
+GPS_GL_FORWARD(glDrawArrays, gps::GL_CALLS_DRAW, (GLenum mode, GLint first, GLsizei count), (mode, first, count), (mode, first, count))
+GPS_GL_FORWARD(glBindVertexArray, gps::GL_CALLS_STATE, (GLuint array), (array), (array))
+GPS_GL_FORWARD(glBindFramebuffer, gps::GL_CALLS_STATE, (GLenum target, GLuint framebuffer), (target, framebuffer), (target, framebuffer))
+GPS_GL_FORWARD(glBindBuffer, gps::GL_CALLS_STATE, (GLenum target, GLuint buffer), (target, buffer), (target, buffer))
+GPS_GL_FORWARD(glClear, gps::GL_CALLS_STATE, (GLbitfield mask), (mask), (mask))
+GPS_GL_FORWARD(glClearColor, gps::GL_CALLS_STATE, (GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha), (red, green, blue, alpha), (red, green, blue, alpha))
+GPS_GL_FORWARD(glViewport, gps::GL_CALLS_STATE, (GLint x, GLint y, GLsizei width, GLsizei height), (x, y, width, height), (x, y, width, height))
+GPS_GL_FORWARD(glEnable, gps::GL_CALLS_STATE, (GLenum cap), (cap), (cap))
+GPS_GL_FORWARD(glDisable, gps::GL_CALLS_STATE, (GLenum cap), (cap), (cap))
+GPS_GL_FORWARD(glDepthFunc, gps::GL_CALLS_STATE, (GLenum func), (func), (func))
+GPS_GL_FORWARD(glDepthMask, gps::GL_CALLS_STATE, (GLboolean flag), (flag), (flag))
+GPS_GL_FORWARD(glColorMask, gps::GL_CALLS_STATE, (GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha), (red, green, blue, alpha), (red, green, blue, alpha))
+GPS_GL_FORWARD(glCullFace, gps::GL_CALLS_STATE, (GLenum mode), (mode), (mode))
+GPS_GL_FORWARD(glFrontFace, gps::GL_CALLS_STATE, (GLenum mode), (mode), (mode))
+GPS_GL_FORWARD(glPolygonMode, gps::GL_CALLS_STATE, (GLenum face, GLenum mode), (face, mode), (face, mode))
+GPS_GL_FORWARD(glDrawBuffer, gps::GL_CALLS_STATE, (GLenum buf), (buf), (buf))
+GPS_GL_FORWARD(glDrawBuffers, gps::GL_CALLS_STATE, (GLsizei n, const GLenum* bufs), (n, bufs), (n, gps::GLTraceData(bufs, n * sizeof(GLenum))))
+GPS_GL_FORWARD(glReadBuffer, gps::GL_CALLS_STATE, (GLenum src), (src), (src))
+GPS_GL_FORWARD(glPixelStorei, gps::GL_CALLS_STATE, (GLenum pname, GLint param), (pname, param), (pname, param))
+GPS_GL_FORWARD(glBindRenderbuffer, gps::GL_CALLS_STATE, (GLenum target, GLuint renderbuffer), (target, renderbuffer), (target, renderbuffer))
+GPS_GL_FORWARD(glGenBuffers, gps::GL_CALLS_RESOURCE, (GLsizei n, GLuint* buffers), (n, buffers), (n, gps::GLTraceData(buffers, n * sizeof(GLuint))))
+GPS_GL_FORWARD(glDeleteBuffers, gps::GL_CALLS_RESOURCE, (GLsizei n, const GLuint* buffers), (n, buffers), (n, gps::GLTraceData(buffers, n * sizeof(GLuint))))
+GPS_GL_FORWARD(glBufferData, gps::GL_CALLS_RESOURCE, (GLenum target, GLsizeiptr size, const void* data, GLenum usage), (target, size, data, usage), (target, size, gps::GLTraceData(data, size), usage))
+GPS_GL_FORWARD(glTexBuffer, gps::GL_CALLS_RESOURCE, (GLenum target, GLenum internalformat, GLuint buffer), (target, internalformat, buffer), (target, internalformat, buffer))
+GPS_GL_FORWARD(glGenTextures, gps::GL_CALLS_RESOURCE, (GLsizei n, GLuint* textures), (n, textures), (n, gps::GLTraceData(textures, n * sizeof(GLuint))))
+GPS_GL_FORWARD(glDeleteTextures, gps::GL_CALLS_RESOURCE, (GLsizei n, const GLuint* textures), (n, textures), (n, gps::GLTraceData(textures, n * sizeof(GLuint))))
+GPS_GL_FORWARD(glTexImage2D, gps::GL_CALLS_RESOURCE, (GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels), (target, level, internalformat, width, height, border, format, type, pixels), (target, level, internalformat, width, height, border, format, type, gps::GLTraceData(pixels, gps::GLTrace::ImageSize(width, height, 1, format, type, gps::GLTrace::GetUnpackAlignment()))))
+GPS_GL_FORWARD(glTexImage3D, gps::GL_CALLS_RESOURCE, (GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLsizei depth, GLint border, GLenum format, GLenum type, const void* pixels), (target, level, internalformat, width, height, depth, border, format, type, pixels), (target, level, internalformat, width, height, depth, border, format, type, gps::GLTraceData(pixels, gps::GLTrace::ImageSize(width, height, depth, format, type, gps::GLTrace::GetUnpackAlignment()))))
+GPS_GL_FORWARD(glTexParameteri, gps::GL_CALLS_RESOURCE, (GLenum target, GLenum pname, GLint param), (target, pname, param), (target, pname, param))
+GPS_GL_FORWARD(glTexParameterfv, gps::GL_CALLS_RESOURCE, (GLenum target, GLenum pname, const GLfloat* params), (target, pname, params), (target, pname, gps::GLTraceData(params, (pname == GL_TEXTURE_BORDER_COLOR ? 4 : 1) * sizeof(GLfloat))))
+GPS_GL_FORWARD(glGenerateMipmap, gps::GL_CALLS_RESOURCE, (GLenum target), (target), (target))
+GPS_GL_FORWARD(glGenVertexArrays, gps::GL_CALLS_RESOURCE, (GLsizei n, GLuint* arrays), (n, arrays), (n, gps::GLTraceData(arrays, n * sizeof(GLuint))))
+GPS_GL_FORWARD(glDeleteVertexArrays, gps::GL_CALLS_RESOURCE, (GLsizei n, const GLuint* arrays), (n, arrays), (n, gps::GLTraceData(arrays, n * sizeof(GLuint))))
+GPS_GL_FORWARD(glVertexAttribPointer, gps::GL_CALLS_RESOURCE, (GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer), (index, size, type, normalized, stride, pointer), (index, size, type, normalized, stride, gps::GLTraceOffset(pointer)))
+GPS_GL_FORWARD(glEnableVertexAttribArray, gps::GL_CALLS_RESOURCE, (GLuint index), (index), (index))
+GPS_GL_FORWARD(glGenFramebuffers, gps::GL_CALLS_RESOURCE, (GLsizei n, GLuint* framebuffers), (n, framebuffers), (n, gps::GLTraceData(framebuffers, n * sizeof(GLuint))))
+GPS_GL_FORWARD(glDeleteFramebuffers, gps::GL_CALLS_RESOURCE, (GLsizei n, const GLuint* framebuffers), (n, framebuffers), (n, gps::GLTraceData(framebuffers, n * sizeof(GLuint))))
+GPS_GL_FORWARD(glFramebufferTexture2D, gps::GL_CALLS_RESOURCE, (GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level), (target, attachment, textarget, texture, level), (target, attachment, textarget, texture, level))
+GPS_GL_FORWARD(glFramebufferTextureLayer, gps::GL_CALLS_RESOURCE, (GLenum target, GLenum attachment, GLuint texture, GLint level, GLint layer), (target, attachment, texture, level, layer), (target, attachment, texture, level, layer))
+GPS_GL_FORWARD(glFramebufferRenderbuffer, gps::GL_CALLS_RESOURCE, (GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer), (target, attachment, renderbuffertarget, renderbuffer), (target, attachment, renderbuffertarget, renderbuffer))
+GPS_GL_FORWARD(glGenRenderbuffers, gps::GL_CALLS_RESOURCE, (GLsizei n, GLuint* renderbuffers), (n, renderbuffers), (n, gps::GLTraceData(renderbuffers, n * sizeof(GLuint))))
+GPS_GL_FORWARD(glDeleteRenderbuffers, gps::GL_CALLS_RESOURCE, (GLsizei n, const GLuint* renderbuffers), (n, renderbuffers), (n, gps::GLTraceData(renderbuffers, n * sizeof(GLuint))))
+GPS_GL_FORWARD(glRenderbufferStorage, gps::GL_CALLS_RESOURCE, (GLenum target, GLenum internalformat, GLsizei width, GLsizei height), (target, internalformat, width, height), (target, internalformat, width, height))
+GPS_GL_FORWARD_RESULT(glCreateShader, gps::GL_CALLS_SHADER, GLuint, (GLenum type), (type), (type, value))
+GPS_GL_FORWARD(glShaderSource, gps::GL_CALLS_SHADER, (GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length), (shader, count, string, length), (shader, gps::GLTraceSource(count, string, length)))
+GPS_GL_FORWARD(glCompileShader, gps::GL_CALLS_SHADER, (GLuint shader), (shader), (shader))
+GPS_GL_FORWARD(glDeleteShader, gps::GL_CALLS_SHADER, (GLuint shader), (shader), (shader))
+GPS_GL_FORWARD(glAttachShader, gps::GL_CALLS_SHADER, (GLuint program, GLuint shader), (program, shader), (program, shader))
+GPS_GL_FORWARD(glDetachShader, gps::GL_CALLS_SHADER, (GLuint program, GLuint shader), (program, shader), (program, shader))
+GPS_GL_FORWARD(glLinkProgram, gps::GL_CALLS_SHADER, (GLuint program), (program), (program))
+GPS_GL_FORWARD(glDeleteProgram, gps::GL_CALLS_SHADER, (GLuint program), (program), (program))
+GPS_GL_FORWARD(glGetShaderiv, gps::GL_CALLS_SHADER, (GLuint shader, GLenum pname, GLint* params), (shader, pname, params), (shader, pname))
+GPS_GL_FORWARD(glGetProgramiv, gps::GL_CALLS_SHADER, (GLuint program, GLenum pname, GLint* params), (program, pname, params), (program, pname))
+GPS_GL_FORWARD(glGenQueries, gps::GL_CALLS_QUERY, (GLsizei n, GLuint* ids), (n, ids), (n, gps::GLTraceData(ids, n * sizeof(GLuint))))
+GPS_GL_FORWARD(glDeleteQueries, gps::GL_CALLS_QUERY, (GLsizei n, const GLuint* ids), (n, ids), (n, gps::GLTraceData(ids, n * sizeof(GLuint))))
+GPS_GL_FORWARD(glBeginQuery, gps::GL_CALLS_QUERY, (GLenum target, GLuint id), (target, id), (target, id))
+GPS_GL_FORWARD(glEndQuery, gps::GL_CALLS_QUERY, (GLenum target), (target), (target))
+GPS_GL_FORWARD(glQueryCounter, gps::GL_CALLS_QUERY, (GLuint id, GLenum target), (id, target), (id, target))
+GPS_GL_FORWARD(glGetQueryObjectuiv, gps::GL_CALLS_QUERY, (GLuint id, GLenum pname, GLuint* params), (id, pname, params), (id, pname))
+GPS_GL_FORWARD(glGetQueryObjectui64v, gps::GL_CALLS_QUERY, (GLuint id, GLenum pname, GLuint64* params), (id, pname, params), (id, pname))
+GPS_GL_FORWARD(glReadPixels, gps::GL_CALLS_QUERY, (GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void* pixels), (x, y, width, height, format, type, pixels), (x, y, width, height, format, type))
+GPS_GL_FORWARD(glBlendFunc, gps::GL_CALLS_STATE, (GLenum sfactor, GLenum dfactor), (sfactor, dfactor), (sfactor, dfactor))
+
+//the entry points without parameters
+inline void gpsIntercepted_glFlush(const char* file, int line) {
+    {
+        gps::GLCallTimer timer("glFlush", gps::GL_CALLS_STATE, file, line);
+        glFlush();
+    }
+    GPS_GL_TRACE(glFlush, ())
+}
+
+inline GLuint gpsIntercepted_glCreateProgram(const char* file, int line) {
+    GLuint value;
+    {
+        gps::GLCallTimer timer("glCreateProgram", gps::GL_CALLS_SHADER, file, line);
+        value = glCreateProgram();
+    }
+    GPS_GL_TRACE(glCreateProgram, (value))
+    return value;
+}
+
+#undef GPS_GL_FORWARD
+#undef GPS_GL_FORWARD_RESULT
+
+//from here on the calls of every file including this header are counted
+#undef glUniform1i
+#define glUniform1i(...) gpsIntercepted_glUniform1i(__FILE__, __LINE__, __VA_ARGS__)
+#undef glUniform1f
+#define glUniform1f(...) gpsIntercepted_glUniform1f(__FILE__, __LINE__, __VA_ARGS__)
+#undef glUniform1fv
+#define glUniform1fv(...) gpsIntercepted_glUniform1fv(__FILE__, __LINE__, __VA_ARGS__)
+#undef glUniform2f
+#define glUniform2f(...) gpsIntercepted_glUniform2f(__FILE__, __LINE__, __VA_ARGS__)
+#undef glUniform3fv
+#define glUniform3fv(...) gpsIntercepted_glUniform3fv(__FILE__, __LINE__, __VA_ARGS__)
+#undef glUniform3i
+#define glUniform3i(...) gpsIntercepted_glUniform3i(__FILE__, __LINE__, __VA_ARGS__)
+#undef glUniformMatrix3fv
+#define glUniformMatrix3fv(...) gpsIntercepted_glUniformMatrix3fv(__FILE__, __LINE__, __VA_ARGS__)
+#undef glUniformMatrix4fv
+#define glUniformMatrix4fv(...) gpsIntercepted_glUniformMatrix4fv(__FILE__, __LINE__, __VA_ARGS__)
+#undef glGetUniformLocation
+#define glGetUniformLocation(...) gpsIntercepted_glGetUniformLocation(__FILE__, __LINE__, __VA_ARGS__)
+#undef glBindTexture
+#define glBindTexture(...) gpsIntercepted_glBindTexture(__FILE__, __LINE__, __VA_ARGS__)
+#undef glActiveTexture
+#define glActiveTexture(...) gpsIntercepted_glActiveTexture(__FILE__, __LINE__, __VA_ARGS__)
+#undef glUseProgram
+#define glUseProgram(...) gpsIntercepted_glUseProgram(__FILE__, __LINE__, __VA_ARGS__)
+#undef glDrawElements
+#define glDrawElements(...) gpsIntercepted_glDrawElements(__FILE__, __LINE__, __VA_ARGS__)
+#undef glDrawArrays
+#define glDrawArrays(...) gpsIntercepted_glDrawArrays(__FILE__, __LINE__, __VA_ARGS__)
+#undef glBindVertexArray
+#define glBindVertexArray(...) gpsIntercepted_glBindVertexArray(__FILE__, __LINE__, __VA_ARGS__)
+#undef glBindFramebuffer
+#define glBindFramebuffer(...) gpsIntercepted_glBindFramebuffer(__FILE__, __LINE__, __VA_ARGS__)
+#undef glBindBuffer
+#define glBindBuffer(...) gpsIntercepted_glBindBuffer(__FILE__, __LINE__, __VA_ARGS__)
+#undef glClear
+#define glClear(...) gpsIntercepted_glClear(__FILE__, __LINE__, __VA_ARGS__)
+#undef glClearColor
+#define glClearColor(...) gpsIntercepted_glClearColor(__FILE__, __LINE__, __VA_ARGS__)
+#undef glViewport
+#define glViewport(...) gpsIntercepted_glViewport(__FILE__, __LINE__, __VA_ARGS__)
+#undef glEnable
+#define glEnable(...) gpsIntercepted_glEnable(__FILE__, __LINE__, __VA_ARGS__)
+#undef glDisable
+#define glDisable(...) gpsIntercepted_glDisable(__FILE__, __LINE__, __VA_ARGS__)
+#undef glDepthFunc
+#define glDepthFunc(...) gpsIntercepted_glDepthFunc(__FILE__, __LINE__, __VA_ARGS__)
+#undef glDepthMask
+#define glDepthMask(...) gpsIntercepted_glDepthMask(__FILE__, __LINE__, __VA_ARGS__)
+#undef glColorMask
+#define glColorMask(...) gpsIntercepted_glColorMask(__FILE__, __LINE__, __VA_ARGS__)
+#undef glCullFace
+#define glCullFace(...) gpsIntercepted_glCullFace(__FILE__, __LINE__, __VA_ARGS__)
+#undef glFrontFace
+#define glFrontFace(...) gpsIntercepted_glFrontFace(__FILE__, __LINE__, __VA_ARGS__)
+#undef glPolygonMode
+#define glPolygonMode(...) gpsIntercepted_glPolygonMode(__FILE__, __LINE__, __VA_ARGS__)
+#undef glDrawBuffer
+#define glDrawBuffer(...) gpsIntercepted_glDrawBuffer(__FILE__, __LINE__, __VA_ARGS__)
+#undef glDrawBuffers
+#define glDrawBuffers(...) gpsIntercepted_glDrawBuffers(__FILE__, __LINE__, __VA_ARGS__)
+#undef glReadBuffer
+#define glReadBuffer(...) gpsIntercepted_glReadBuffer(__FILE__, __LINE__, __VA_ARGS__)
+#undef glPixelStorei
+#define glPixelStorei(...) gpsIntercepted_glPixelStorei(__FILE__, __LINE__, __VA_ARGS__)
+#undef glBindRenderbuffer
+#define glBindRenderbuffer(...) gpsIntercepted_glBindRenderbuffer(__FILE__, __LINE__, __VA_ARGS__)
+#undef glFlush
+#define glFlush() gpsIntercepted_glFlush(__FILE__, __LINE__)
+#undef glGenBuffers
+#define glGenBuffers(...) gpsIntercepted_glGenBuffers(__FILE__, __LINE__, __VA_ARGS__)
+#undef glDeleteBuffers
+#define glDeleteBuffers(...) gpsIntercepted_glDeleteBuffers(__FILE__, __LINE__, __VA_ARGS__)
+#undef glBufferData
+#define glBufferData(...) gpsIntercepted_glBufferData(__FILE__, __LINE__, __VA_ARGS__)
+#undef glTexBuffer
+#define glTexBuffer(...) gpsIntercepted_glTexBuffer(__FILE__, __LINE__, __VA_ARGS__)
+#undef glGenTextures
+#define glGenTextures(...) gpsIntercepted_glGenTextures(__FILE__, __LINE__, __VA_ARGS__)
+#undef glDeleteTextures
+#define glDeleteTextures(...) gpsIntercepted_glDeleteTextures(__FILE__, __LINE__, __VA_ARGS__)
+#undef glTexImage2D
+#define glTexImage2D(...) gpsIntercepted_glTexImage2D(__FILE__, __LINE__, __VA_ARGS__)
+#undef glTexImage3D
+#define glTexImage3D(...) gpsIntercepted_glTexImage3D(__FILE__, __LINE__, __VA_ARGS__)
+#undef glTexParameteri
+#define glTexParameteri(...) gpsIntercepted_glTexParameteri(__FILE__, __LINE__, __VA_ARGS__)
+#undef glTexParameterfv
+#define glTexParameterfv(...) gpsIntercepted_glTexParameterfv(__FILE__, __LINE__, __VA_ARGS__)
+#undef glGenerateMipmap
+#define glGenerateMipmap(...) gpsIntercepted_glGenerateMipmap(__FILE__, __LINE__, __VA_ARGS__)
+#undef glGenVertexArrays
+#define glGenVertexArrays(...) gpsIntercepted_glGenVertexArrays(__FILE__, __LINE__, __VA_ARGS__)
+#undef glDeleteVertexArrays
+#define glDeleteVertexArrays(...) gpsIntercepted_glDeleteVertexArrays(__FILE__, __LINE__, __VA_ARGS__)
+#undef glVertexAttribPointer
+#define glVertexAttribPointer(...) gpsIntercepted_glVertexAttribPointer(__FILE__, __LINE__, __VA_ARGS__)
+#undef glEnableVertexAttribArray
+#define glEnableVertexAttribArray(...) gpsIntercepted_glEnableVertexAttribArray(__FILE__, __LINE__, __VA_ARGS__)
+#undef glGenFramebuffers
+#define glGenFramebuffers(...) gpsIntercepted_glGenFramebuffers(__FILE__, __LINE__, __VA_ARGS__)
+#undef glDeleteFramebuffers
+#define glDeleteFramebuffers(...) gpsIntercepted_glDeleteFramebuffers(__FILE__, __LINE__, __VA_ARGS__)
+#undef glFramebufferTexture2D
+#define glFramebufferTexture2D(...) gpsIntercepted_glFramebufferTexture2D(__FILE__, __LINE__, __VA_ARGS__)
+#undef glFramebufferTextureLayer
+#define glFramebufferTextureLayer(...) gpsIntercepted_glFramebufferTextureLayer(__FILE__, __LINE__, __VA_ARGS__)
+#undef glFramebufferRenderbuffer
+#define glFramebufferRenderbuffer(...) gpsIntercepted_glFramebufferRenderbuffer(__FILE__, __LINE__, __VA_ARGS__)
+#undef glGenRenderbuffers
+#define glGenRenderbuffers(...) gpsIntercepted_glGenRenderbuffers(__FILE__, __LINE__, __VA_ARGS__)
+#undef glDeleteRenderbuffers
+#define glDeleteRenderbuffers(...) gpsIntercepted_glDeleteRenderbuffers(__FILE__, __LINE__, __VA_ARGS__)
+#undef glRenderbufferStorage
+#define glRenderbufferStorage(...) gpsIntercepted_glRenderbufferStorage(__FILE__, __LINE__, __VA_ARGS__)
+#undef glCreateShader
+#define glCreateShader(...) gpsIntercepted_glCreateShader(__FILE__, __LINE__, __VA_ARGS__)
+#undef glShaderSource
+#define glShaderSource(...) gpsIntercepted_glShaderSource(__FILE__, __LINE__, __VA_ARGS__)
+#undef glCompileShader
+#define glCompileShader(...) gpsIntercepted_glCompileShader(__FILE__, __LINE__, __VA_ARGS__)
+#undef glDeleteShader
+#define glDeleteShader(...) gpsIntercepted_glDeleteShader(__FILE__, __LINE__, __VA_ARGS__)
+#undef glCreateProgram
+#define glCreateProgram() gpsIntercepted_glCreateProgram(__FILE__, __LINE__)
+#undef glAttachShader
+#define glAttachShader(...) gpsIntercepted_glAttachShader(__FILE__, __LINE__, __VA_ARGS__)
+#undef glDetachShader
+#define glDetachShader(...) gpsIntercepted_glDetachShader(__FILE__, __LINE__, __VA_ARGS__)
+#undef glLinkProgram
+#define glLinkProgram(...) gpsIntercepted_glLinkProgram(__FILE__, __LINE__, __VA_ARGS__)
+#undef glDeleteProgram
+#define glDeleteProgram(...) gpsIntercepted_glDeleteProgram(__FILE__, __LINE__, __VA_ARGS__)
+#undef glGetShaderiv
+#define glGetShaderiv(...) gpsIntercepted_glGetShaderiv(__FILE__, __LINE__, __VA_ARGS__)
+#undef glGetProgramiv
+#define glGetProgramiv(...) gpsIntercepted_glGetProgramiv(__FILE__, __LINE__, __VA_ARGS__)
+#undef glGenQueries
+#define glGenQueries(...) gpsIntercepted_glGenQueries(__FILE__, __LINE__, __VA_ARGS__)
+#undef glDeleteQueries
+#define glDeleteQueries(...) gpsIntercepted_glDeleteQueries(__FILE__, __LINE__, __VA_ARGS__)
+#undef glBeginQuery
+#define glBeginQuery(...) gpsIntercepted_glBeginQuery(__FILE__, __LINE__, __VA_ARGS__)
+#undef glEndQuery
+#define glEndQuery(...) gpsIntercepted_glEndQuery(__FILE__, __LINE__, __VA_ARGS__)
+#undef glQueryCounter
+#define glQueryCounter(...) gpsIntercepted_glQueryCounter(__FILE__, __LINE__, __VA_ARGS__)
+#undef glGetQueryObjectuiv
+#define glGetQueryObjectuiv(...) gpsIntercepted_glGetQueryObjectuiv(__FILE__, __LINE__, __VA_ARGS__)
+#undef glGetQueryObjectui64v
+#define glGetQueryObjectui64v(...) gpsIntercepted_glGetQueryObjectui64v(__FILE__, __LINE__, __VA_ARGS__)
+#undef glReadPixels
+#define glReadPixels(...) gpsIntercepted_glReadPixels(__FILE__, __LINE__, __VA_ARGS__)
+#undef glBlendFunc
+#define glBlendFunc(...) gpsIntercepted_glBlendFunc(__FILE__, __LINE__, __VA_ARGS__)
+
+#endif
+
+#endif /* GLIntercept_hpp */
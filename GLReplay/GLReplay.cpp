@@ -0,0 +1,609 @@
+//GLReplay: re-issues a GL trace written by the app with --capture as fast as the driver allows
+//usage: GLReplay TRACE [--loop N] (replays the frames after the first N more times)
+//build: GLReplay.vcxproj, or the Makefile here for a headless Linux build (GPS_HEADLESS, EGL)
+//sources: GLReplay.cpp, GLTrace.cpp, GpuMemory.cpp, GLDebug.cpp and Window.cpp
+
+#include "../GLTrace.hpp"
+#include "../Window.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <utility>
+#include <vector>
+
+gps::Window replayWindow;
+gps::GLTraceReader trace;
+
+//names recorded by the app to names generated here
+std::map<GLuint, GLuint> buffers;
+std::map<GLuint, GLuint> textures;
+std::map<GLuint, GLuint> vertexArrays;
+std::map<GLuint, GLuint> framebuffers;
+std::map<GLuint, GLuint> renderbuffers;
+std::map<GLuint, GLuint> queries;
+std::map<GLuint, GLuint> shaders;
+std::map<GLuint, GLuint> programs;
+//locations are per program, keyed by the recorded program and location
+std::map<std::pair<GLuint, GLint>, GLint> uniformLocations;
+GLuint currentProgram = 0;
+
+//readbacks of the trace go here, their results were not recorded
+std::vector<unsigned char> scratch;
+
+GLuint mapName(std::map<GLuint, GLuint>& names, GLuint recorded) {
+    if (recorded == 0) {
+        return 0;
+    }
+    std::map<GLuint, GLuint>::iterator name = names.find(recorded);
+    return name != names.end() ? name->second : 0;
+}
+
+GLuint mapFramebuffer(GLuint recorded) {
+    //the app's window becomes ours, the offscreen one for headless replays
+    return recorded == 0 ? replayWindow.getFramebuffer() : mapName(framebuffers, recorded);
+}
+
+GLint mapLocation(GLint recorded) {
+    if (recorded < 0) {
+        return recorded;
+    }
+    std::map<std::pair<GLuint, GLint>, GLint>::iterator location = uniformLocations.find(std::make_pair(currentProgram, recorded));
+    return location != uniformLocations.end() ? location->second : -1;
+}
+
+//glGen* with the recorded names, which are mapped to the new ones
+void replayGen(void (*generate)(GLsizei, GLuint*), std::map<GLuint, GLuint>& names) {
+    GLsizei count = trace.Read<GLsizei>();
+    const GLuint* recorded = (const GLuint*)trace.ReadData();
+    std::vector<GLuint> generated(count);
+    generate(count, generated.data());
+    for (GLsizei i = 0; i < count; i++) {
+        names[recorded[i]] = generated[i];
+    }
+}
+
+void replayDelete(void (*destroy)(GLsizei, const GLuint*), std::map<GLuint, GLuint>& names) {
+    GLsizei count = trace.Read<GLsizei>();
+    const GLuint* recorded = (const GLuint*)trace.ReadData();
+    std::vector<GLuint> deleted(count);
+    for (GLsizei i = 0; i < count; i++) {
+        deleted[i] = mapName(names, recorded[i]);
+        names.erase(recorded[i]);
+    }
+    destroy(count, deleted.data());
+}
+
+void* getScratch(size_t size) {
+    if (scratch.size() < size) {
+        scratch.resize(size);
+    }
+    return scratch.data();
+}
+
+//GLEW entry points are function pointers, these give glGen* and glDelete* one signature for replayGen and replayDelete
+void genBuffers(GLsizei n, GLuint* names) { glGenBuffers(n, names); }
+void genTextures(GLsizei n, GLuint* names) { glGenTextures(n, names); }
+void genVertexArrays(GLsizei n, GLuint* names) { glGenVertexArrays(n, names); }
+void genFramebuffers(GLsizei n, GLuint* names) { glGenFramebuffers(n, names); }
+void genRenderbuffers(GLsizei n, GLuint* names) { glGenRenderbuffers(n, names); }
+void genQueries(GLsizei n, GLuint* names) { glGenQueries(n, names); }
+void deleteBuffers(GLsizei n, const GLuint* names) { glDeleteBuffers(n, names); }
+void deleteTextures(GLsizei n, const GLuint* names) { glDeleteTextures(n, names); }
+void deleteVertexArrays(GLsizei n, const GLuint* names) { glDeleteVertexArrays(n, names); }
+void deleteFramebuffers(GLsizei n, const GLuint* names) { glDeleteFramebuffers(n, names); }
+void deleteRenderbuffers(GLsizei n, const GLuint* names) { glDeleteRenderbuffers(n, names); }
+void deleteQueries(GLsizei n, const GLuint* names) { glDeleteQueries(n, names); }
+
+//one call, false for a command this replayer does not know (a newer or damaged trace)
+bool replayCommand(gps::GL_TRACE_COMMAND command) {
+    switch (command) {
+    case gps::GL_TRACE_glUniform1i: {
+        GLint location = mapLocation(trace.Read<GLint>());
+        glUniform1i(location, trace.Read<GLint>());
+        break;
+    }
+    case gps::GL_TRACE_glUniform1f: {
+        GLint location = mapLocation(trace.Read<GLint>());
+        glUniform1f(location, trace.Read<GLfloat>());
+        break;
+    }
+    case gps::GL_TRACE_glUniform1fv: {
+        GLint location = mapLocation(trace.Read<GLint>());
+        GLsizei count = trace.Read<GLsizei>();
+        glUniform1fv(location, count, (const GLfloat*)trace.ReadData());
+        break;
+    }
+    case gps::GL_TRACE_glUniform2f: {
+        GLint location = mapLocation(trace.Read<GLint>());
+        GLfloat v0 = trace.Read<GLfloat>();
+        GLfloat v1 = trace.Read<GLfloat>();
+        glUniform2f(location, v0, v1);
+        break;
+    }
+    case gps::GL_TRACE_glUniform3fv: {
+        GLint location = mapLocation(trace.Read<GLint>());
+        GLsizei count = trace.Read<GLsizei>();
+        glUniform3fv(location, count, (const GLfloat*)trace.ReadData());
+        break;
+    }
+    case gps::GL_TRACE_glUniform3i: {
+        GLint location = mapLocation(trace.Read<GLint>());
+        GLint v0 = trace.Read<GLint>();
+        GLint v1 = trace.Read<GLint>();
+        GLint v2 = trace.Read<GLint>();
+        glUniform3i(location, v0, v1, v2);
+        break;
+    }
+    case gps::GL_TRACE_glUniformMatrix3fv: {
+        GLint location = mapLocation(trace.Read<GLint>());
+        GLsizei count = trace.Read<GLsizei>();
+        GLboolean transpose = trace.Read<GLboolean>();
+        glUniformMatrix3fv(location, count, transpose, (const GLfloat*)trace.ReadData());
+        break;
+    }
+    case gps::GL_TRACE_glUniformMatrix4fv: {
+        GLint location = mapLocation(trace.Read<GLint>());
+        GLsizei count = trace.Read<GLsizei>();
+        GLboolean transpose = trace.Read<GLboolean>();
+        glUniformMatrix4fv(location, count, transpose, (const GLfloat*)trace.ReadData());
+        break;
+    }
+    case gps::GL_TRACE_glGetUniformLocation: {
+        GLuint program = trace.Read<GLuint>();
+        const GLchar* name = (const GLchar*)trace.ReadData();
+        GLint recorded = trace.Read<GLint>();
+        GLint location = glGetUniformLocation(mapName(programs, program), name);
+        if (recorded >= 0) {
+            uniformLocations[std::make_pair(program, recorded)] = location;
+        }
+        break;
+    }
+    case gps::GL_TRACE_glBindTexture: {
+        GLenum target = trace.Read<GLenum>();
+        glBindTexture(target, mapName(textures, trace.Read<GLuint>()));
+        break;
+    }
+    case gps::GL_TRACE_glActiveTexture:
+        glActiveTexture(trace.Read<GLenum>());
+        break;
+    case gps::GL_TRACE_glUseProgram:
+        currentProgram = trace.Read<GLuint>();
+        glUseProgram(mapName(programs, currentProgram));
+        break;
+    case gps::GL_TRACE_glDrawElements: {
+        GLenum mode = trace.Read<GLenum>();
+        GLsizei count = trace.Read<GLsizei>();
+        GLenum type = trace.Read<GLenum>();
+        glDrawElements(mode, count, type, trace.ReadOffset());
+        break;
+    }
+    case gps::GL_TRACE_glDrawArrays: {
+        GLenum mode = trace.Read<GLenum>();
+        GLint first = trace.Read<GLint>();
+        glDrawArrays(mode, first, trace.Read<GLsizei>());
+        break;
+    }
+    case gps::GL_TRACE_glBindVertexArray:
+        glBindVertexArray(mapName(vertexArrays, trace.Read<GLuint>()));
+        break;
+    case gps::GL_TRACE_glBindFramebuffer: {
+        GLenum target = trace.Read<GLenum>();
+        glBindFramebuffer(target, mapFramebuffer(trace.Read<GLuint>()));
+        break;
+    }
+    case gps::GL_TRACE_glBindBuffer: {
+        GLenum target = trace.Read<GLenum>();
+        glBindBuffer(target, mapName(buffers, trace.Read<GLuint>()));
+        break;
+    }
+    case gps::GL_TRACE_glClear:
+        glClear(trace.Read<GLbitfield>());
+        break;
+    case gps::GL_TRACE_glClearColor: {
+        GLfloat red = trace.Read<GLfloat>();
+        GLfloat green = trace.Read<GLfloat>();
+        GLfloat blue = trace.Read<GLfloat>();
+        glClearColor(red, green, blue, trace.Read<GLfloat>());
+        break;
+    }
+    case gps::GL_TRACE_glViewport: {
+        GLint x = trace.Read<GLint>();
+        GLint y = trace.Read<GLint>();
+        GLsizei width = trace.Read<GLsizei>();
+        glViewport(x, y, width, trace.Read<GLsizei>());
+        break;
+    }
+    case gps::GL_TRACE_glEnable:
+        glEnable(trace.Read<GLenum>());
+        break;
+    case gps::GL_TRACE_glDisable:
+        glDisable(trace.Read<GLenum>());
+        break;
+    case gps::GL_TRACE_glDepthFunc:
+        glDepthFunc(trace.Read<GLenum>());
+        break;
+    case gps::GL_TRACE_glDepthMask:
+        glDepthMask(trace.Read<GLboolean>());
+        break;
+    case gps::GL_TRACE_glColorMask: {
+        GLboolean red = trace.Read<GLboolean>();
+        GLboolean green = trace.Read<GLboolean>();
+        GLboolean blue = trace.Read<GLboolean>();
+        glColorMask(red, green, blue, trace.Read<GLboolean>());
+        break;
+    }
+    case gps::GL_TRACE_glCullFace:
+        glCullFace(trace.Read<GLenum>());
+        break;
+    case gps::GL_TRACE_glFrontFace:
+        glFrontFace(trace.Read<GLenum>());
+        break;
+    case gps::GL_TRACE_glPolygonMode: {
+        GLenum face = trace.Read<GLenum>();
+        glPolygonMode(face, trace.Read<GLenum>());
+        break;
+    }
+    case gps::GL_TRACE_glDrawBuffer:
+        glDrawBuffer(trace.Read<GLenum>());
+        break;
+    case gps::GL_TRACE_glDrawBuffers: {
+        GLsizei count = trace.Read<GLsizei>();
+        glDrawBuffers(count, (const GLenum*)trace.ReadData());
+        break;
+    }
+    case gps::GL_TRACE_glReadBuffer:
+        glReadBuffer(trace.Read<GLenum>());
+        break;
+    case gps::GL_TRACE_glPixelStorei: {
+        GLenum pname = trace.Read<GLenum>();
+        glPixelStorei(pname, trace.Read<GLint>());
+        break;
+    }
+    case gps::GL_TRACE_glBindRenderbuffer: {
+        GLenum target = trace.Read<GLenum>();
+        glBindRenderbuffer(target, mapName(renderbuffers, trace.Read<GLuint>()));
+        break;
+    }
+    case gps::GL_TRACE_glFlush:
+        glFlush();
+        break;
+    case gps::GL_TRACE_glGenBuffers:
+        replayGen(genBuffers, buffers);
+        break;
+    case gps::GL_TRACE_glDeleteBuffers:
+        replayDelete(deleteBuffers, buffers);
+        break;
+    case gps::GL_TRACE_glBufferData: {
+        GLenum target = trace.Read<GLenum>();
+        GLsizeiptr size = trace.Read<GLsizeiptr>();
+        const void* data = trace.ReadData();
+        glBufferData(target, size, data, trace.Read<GLenum>());
+        break;
+    }
+    case gps::GL_TRACE_glTexBuffer: {
+        GLenum target = trace.Read<GLenum>();
+        GLenum internalFormat = trace.Read<GLenum>();
+        glTexBuffer(target, internalFormat, mapName(buffers, trace.Read<GLuint>()));
+        break;
+    }
+    case gps::GL_TRACE_glGenTextures:
+        replayGen(genTextures, textures);
+        break;
+    case gps::GL_TRACE_glDeleteTextures:
+        replayDelete(deleteTextures, textures);
+        break;
+    case gps::GL_TRACE_glTexImage2D: {
+        GLenum target = trace.Read<GLenum>();
+        GLint level = trace.Read<GLint>();
+        GLint internalFormat = trace.Read<GLint>();
+        GLsizei width = trace.Read<GLsizei>();
+        GLsizei height = trace.Read<GLsizei>();
+        GLint border = trace.Read<GLint>();
+        GLenum format = trace.Read<GLenum>();
+        GLenum type = trace.Read<GLenum>();
+        glTexImage2D(target, level, internalFormat, width, height, border, format, type, trace.ReadData());
+        break;
+    }
+    case gps::GL_TRACE_glTexImage3D: {
+        GLenum target = trace.Read<GLenum>();
+        GLint level = trace.Read<GLint>();
+        GLint internalFormat = trace.Read<GLint>();
+        GLsizei width = trace.Read<GLsizei>();
+        GLsizei height = trace.Read<GLsizei>();
+        GLsizei depth = trace.Read<GLsizei>();
+        GLint border = trace.Read<GLint>();
+        GLenum format = trace.Read<GLenum>();
+        GLenum type = trace.Read<GLenum>();
+        glTexImage3D(target, level, internalFormat, width, height, depth, border, format, type, trace.ReadData());
+        break;
+    }
+    case gps::GL_TRACE_glTexParameteri: {
+        GLenum target = trace.Read<GLenum>();
+        GLenum pname = trace.Read<GLenum>();
+        glTexParameteri(target, pname, trace.Read<GLint>());
+        break;
+    }
+    case gps::GL_TRACE_glTexParameterfv: {
+        GLenum target = trace.Read<GLenum>();
+        GLenum pname = trace.Read<GLenum>();
+        glTexParameterfv(target, pname, (const GLfloat*)trace.ReadData());
+        break;
+    }
+    case gps::GL_TRACE_glGenerateMipmap:
+        glGenerateMipmap(trace.Read<GLenum>());
+        break;
+    case gps::GL_TRACE_glGenVertexArrays:
+        replayGen(genVertexArrays, vertexArrays);
+        break;
+    case gps::GL_TRACE_glDeleteVertexArrays:
+        replayDelete(deleteVertexArrays, vertexArrays);
+        break;
+    case gps::GL_TRACE_glVertexAttribPointer: {
+        GLuint index = trace.Read<GLuint>();
+        GLint size = trace.Read<GLint>();
+        GLenum type = trace.Read<GLenum>();
+        GLboolean normalized = trace.Read<GLboolean>();
+        GLsizei stride = trace.Read<GLsizei>();
+        glVertexAttribPointer(index, size, type, normalized, stride, trace.ReadOffset());
+        break;
+    }
+    case gps::GL_TRACE_glEnableVertexAttribArray:
+        glEnableVertexAttribArray(trace.Read<GLuint>());
+        break;
+    case gps::GL_TRACE_glGenFramebuffers:
+        replayGen(genFramebuffers, framebuffers);
+        break;
+    case gps::GL_TRACE_glDeleteFramebuffers:
+        replayDelete(deleteFramebuffers, framebuffers);
+        break;
+    case gps::GL_TRACE_glFramebufferTexture2D: {
+        GLenum target = trace.Read<GLenum>();
+        GLenum attachment = trace.Read<GLenum>();
+        GLenum textureTarget = trace.Read<GLenum>();
+        GLuint texture = mapName(textures, trace.Read<GLuint>());
+        glFramebufferTexture2D(target, attachment, textureTarget, texture, trace.Read<GLint>());
+        break;
+    }
+    case gps::GL_TRACE_glFramebufferTextureLayer: {
+        GLenum target = trace.Read<GLenum>();
+        GLenum attachment = trace.Read<GLenum>();
+        GLuint texture = mapName(textures, trace.Read<GLuint>());
+        GLint level = trace.Read<GLint>();
+        glFramebufferTextureLayer(target, attachment, texture, level, trace.Read<GLint>());
+        break;
+    }
+    case gps::GL_TRACE_glFramebufferRenderbuffer: {
+        GLenum target = trace.Read<GLenum>();
+        GLenum attachment = trace.Read<GLenum>();
+        GLenum renderbufferTarget = trace.Read<GLenum>();
+        glFramebufferRenderbuffer(target, attachment, renderbufferTarget, mapName(renderbuffers, trace.Read<GLuint>()));
+        break;
+    }
+    case gps::GL_TRACE_glGenRenderbuffers:
+        replayGen(genRenderbuffers, renderbuffers);
+        break;
+    case gps::GL_TRACE_glDeleteRenderbuffers:
+        replayDelete(deleteRenderbuffers, renderbuffers);
+        break;
+    case gps::GL_TRACE_glRenderbufferStorage: {
+        GLenum target = trace.Read<GLenum>();
+        GLenum internalFormat = trace.Read<GLenum>();
+        GLsizei width = trace.Read<GLsizei>();
+        glRenderbufferStorage(target, internalFormat, width, trace.Read<GLsizei>());
+        break;
+    }
+    case gps::GL_TRACE_glCreateShader: {
+        GLenum type = trace.Read<GLenum>();
+        shaders[trace.Read<GLuint>()] = glCreateShader(type);
+        break;
+    }
+    case gps::GL_TRACE_glShaderSource: {
+        GLuint shader = mapName(shaders, trace.Read<GLuint>());
+        const GLchar* source = (const GLchar*)trace.ReadData();
+        glShaderSource(shader, 1, &source, NULL);
+        break;
+    }
+    case gps::GL_TRACE_glCompileShader:
+        glCompileShader(mapName(shaders, trace.Read<GLuint>()));
+        break;
+    case gps::GL_TRACE_glDeleteShader: {
+        GLuint recorded = trace.Read<GLuint>();
+        glDeleteShader(mapName(shaders, recorded));
+        shaders.erase(recorded);
+        break;
+    }
+    case gps::GL_TRACE_glCreateProgram:
+        programs[trace.Read<GLuint>()] = glCreateProgram();
+        break;
+    case gps::GL_TRACE_glAttachShader: {
+        GLuint program = mapName(programs, trace.Read<GLuint>());
+        glAttachShader(program, mapName(shaders, trace.Read<GLuint>()));
+        break;
+    }
+    case gps::GL_TRACE_glDetachShader: {
+        GLuint program = mapName(programs, trace.Read<GLuint>());
+        glDetachShader(program, mapName(shaders, trace.Read<GLuint>()));
+        break;
+    }
+    case gps::GL_TRACE_glLinkProgram:
+        glLinkProgram(mapName(programs, trace.Read<GLuint>()));
+        break;
+    case gps::GL_TRACE_glDeleteProgram: {
+        GLuint recorded = trace.Read<GLuint>();
+        glDeleteProgram(mapName(programs, recorded));
+        programs.erase(recorded);
+        break;
+    }
+    case gps::GL_TRACE_glGetShaderiv: {
+        GLuint shader = mapName(shaders, trace.Read<GLuint>());
+        glGetShaderiv(shader, trace.Read<GLenum>(), (GLint*)getScratch(sizeof(GLint)));
+        break;
+    }
+    case gps::GL_TRACE_glGetProgramiv: {
+        GLuint program = mapName(programs, trace.Read<GLuint>());
+        glGetProgramiv(program, trace.Read<GLenum>(), (GLint*)getScratch(sizeof(GLint)));
+        break;
+    }
+    case gps::GL_TRACE_glGenQueries:
+        replayGen(genQueries, queries);
+        break;
+    case gps::GL_TRACE_glDeleteQueries:
+        replayDelete(deleteQueries, queries);
+        break;
+    case gps::GL_TRACE_glBeginQuery: {
+        GLenum target = trace.Read<GLenum>();
+        glBeginQuery(target, mapName(queries, trace.Read<GLuint>()));
+        break;
+    }
+    case gps::GL_TRACE_glEndQuery:
+        glEndQuery(trace.Read<GLenum>());
+        break;
+    case gps::GL_TRACE_glQueryCounter: {
+        GLuint query = mapName(queries, trace.Read<GLuint>());
+        glQueryCounter(query, trace.Read<GLenum>());
+        break;
+    }
+    case gps::GL_TRACE_glGetQueryObjectuiv: {
+        GLuint query = mapName(queries, trace.Read<GLuint>());
+        glGetQueryObjectuiv(query, trace.Read<GLenum>(), (GLuint*)getScratch(sizeof(GLuint)));
+        break;
+    }
+    case gps::GL_TRACE_glGetQueryObjectui64v: {
+        GLuint query = mapName(queries, trace.Read<GLuint>());
+        glGetQueryObjectui64v(query, trace.Read<GLenum>(), (GLuint64*)getScratch(sizeof(GLuint64)));
+        break;
+    }
+    case gps::GL_TRACE_glReadPixels: {
+        GLint x = trace.Read<GLint>();
+        GLint y = trace.Read<GLint>();
+        GLsizei width = trace.Read<GLsizei>();
+        GLsizei height = trace.Read<GLsizei>();
+        GLenum format = trace.Read<GLenum>();
+        GLenum type = trace.Read<GLenum>();
+        //room for the largest pack alignment
+        glReadPixels(x, y, width, height, format, type, getScratch(gps::GLTrace::ImageSize(width, height, 1, format, type, 8)));
+        break;
+    }
+    case gps::GL_TRACE_glBlendFunc: {
+        GLenum sfactor = trace.Read<GLenum>();
+        glBlendFunc(sfactor, trace.Read<GLenum>());
+        break;
+    }
+    default:
+        return false;
+    }
+    return true;
+}
+
+void enableParallelCompile() {
+#if !defined (__APPLE__)
+    //the app asked for the same, programs compile in the background while the replay continues
+    if (GLEW_KHR_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+    }
+    else if (GLEW_ARB_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+    }
+#endif
+}
+
+double percentile(std::vector<double> sorted, double fraction) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    return sorted[std::min(sorted.size() - 1, (size_t)(fraction * sorted.size()))];
+}
+
+int main(int argc, const char* argv[]) {
+
+    if (argc < 2) {
+        std::cout << "usage: GLReplay TRACE [--loop N]" << std::endl;
+        return EXIT_FAILURE;
+    }
+    int loops = 0;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--loop") == 0 && i + 1 < argc) {
+            loops = atoi(argv[++i]);
+        }
+        else {
+            std::cout << "Unknown argument " << argv[i] << std::endl;
+        }
+    }
+
+    if (!trace.Open(argv[1])) {
+        return EXIT_FAILURE;
+    }
+    try {
+        replayWindow.Create(trace.GetHeader().width, trace.GetHeader().height, "GL Replay");
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    replayWindow.setVSync(false);
+    enableParallelCompile();
+
+    //the first frame also holds the setup (resources and programs), it is timed separately
+    typedef std::chrono::steady_clock Clock;
+    std::vector<double> frameTimes;
+    double setupTime = 0.0;
+    size_t firstFramePosition = 0;
+    long long commands = 0;
+    Clock::time_point replayStart = Clock::now();
+    Clock::time_point frameStart = replayStart;
+
+    while (!trace.AtEnd() || (loops > 0 && firstFramePosition != 0)) {
+        if (trace.AtEnd()) {
+            loops--;
+            trace.Seek(firstFramePosition);
+            if (trace.AtEnd()) {
+                break;
+            }
+        }
+
+        gps::GL_TRACE_COMMAND command = trace.ReadCommand();
+        commands++;
+        if (command == gps::GL_TRACE_FRAME) {
+            replayWindow.swapBuffers();
+            replayWindow.pollEvents();
+
+            Clock::time_point frameEnd = Clock::now();
+            double milliseconds = std::chrono::duration<double, std::milli>(frameEnd - frameStart).count();
+            if (firstFramePosition == 0) {
+                setupTime = milliseconds;
+                firstFramePosition = trace.GetPosition();
+            }
+            else {
+                frameTimes.push_back(milliseconds);
+            }
+            frameStart = frameEnd;
+            continue;
+        }
+
+        if (!replayCommand(command)) {
+            std::cerr << "Unknown command " << command << " in the trace, stopping" << std::endl;
+            break;
+        }
+    }
+    glFinish();
+    double totalTime = std::chrono::duration<double, std::milli>(Clock::now() - replayStart).count();
+
+    std::vector<double> sorted = frameTimes;
+    std::sort(sorted.begin(), sorted.end());
+    double frameSum = 0.0;
+    for (double frameTime : frameTimes) {
+        frameSum += frameTime;
+    }
+    double mean = frameTimes.empty() ? 0.0 : frameSum / frameTimes.size();
+
+    std::cout << commands << " calls in " << totalTime << " ms, setup and first frame " << setupTime << " ms" << std::endl;
+    std::cout << frameTimes.size() << " frames: mean " << mean << " ms, p50 " << percentile(sorted, 0.5)
+        << " ms, p95 " << percentile(sorted, 0.95) << " ms, max " << (sorted.empty() ? 0.0 : sorted.back())
+        << " ms, " << (mean > 0.0 ? 1000.0 / mean : 0.0) << " fps" << std::endl;
+
+    replayWindow.Delete();
+    return EXIT_SUCCESS;
+}
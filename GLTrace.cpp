@@ -0,0 +1,210 @@
+#include "GLTrace.hpp"
+
+#include <fstream>
+#include <iostream>
+
+namespace gps {
+
+    static const char traceMagic[8] = { 'G', 'P', 'S', 'T', 'R', 'A', 'C', 'E' };
+    static const uint32_t TRACE_VERSION = 1;
+    //the byte count of data recorded from a NULL pointer
+    static const uint32_t TRACE_NULL_DATA = 0xFFFFFFFF;
+    //words collected before they go to the file
+    static const size_t TRACE_FLUSH_WORDS = 1 << 20;
+
+    bool GLTrace::capturing = false;
+    static std::ofstream traceFile;
+    static std::string traceFileName;
+    static std::vector<uint32_t> traceWords;
+    static int traceFrames = 0;
+    static int capturedFrames = 0;
+    static uint64_t traceCommands = 0;
+
+    static void FlushTrace() {
+        traceFile.write((const char*)traceWords.data(), traceWords.size() * sizeof(uint32_t));
+        traceWords.clear();
+    }
+
+    bool GLTrace::BeginCapture(std::string fileName, int frames, int width, int height) {
+        traceFile.open(fileName, std::ios::binary | std::ios::trunc);
+        if (!traceFile.is_open()) {
+            std::cerr << "Could not create the GL trace " << fileName << std::endl;
+            return false;
+        }
+
+        GLTraceHeader header = {};
+        memcpy(header.magic, traceMagic, sizeof(traceMagic));
+        header.version = TRACE_VERSION;
+        header.width = (uint32_t)width;
+        header.height = (uint32_t)height;
+        traceFile.write((const char*)&header, sizeof(header));
+
+        traceFileName = fileName;
+        traceFrames = frames;
+        capturedFrames = 0;
+        traceCommands = 0;
+        traceWords.reserve(TRACE_FLUSH_WORDS);
+        capturing = true;
+        return true;
+    }
+
+    void GLTrace::EndFrame() {
+        if (!capturing) {
+            return;
+        }
+
+        BeginCommand(GL_TRACE_FRAME);
+        if (++capturedFrames >= traceFrames) {
+            EndCapture();
+        }
+    }
+
+    void GLTrace::EndCapture() {
+        if (!capturing) {
+            return;
+        }
+
+        FlushTrace();
+        traceFile.close();
+        capturing = false;
+        std::cout << "GL trace " << traceFileName << ": " << capturedFrames << " frames, "
+            << traceCommands << " calls" << std::endl;
+    }
+
+    void GLTrace::BeginCommand(GL_TRACE_COMMAND command) {
+        if (command != GL_TRACE_FRAME) {
+            traceCommands++;
+        }
+        traceWords.push_back((uint32_t)command);
+        if (traceWords.size() >= TRACE_FLUSH_WORDS) {
+            FlushTrace();
+        }
+    }
+
+    void GLTrace::WriteBytes(const void* data, size_t size, size_t slotSize) {
+        size_t first = traceWords.size();
+        traceWords.resize(first + (slotSize + 3) / 4, 0);
+        if (size > 0) {
+            memcpy(traceWords.data() + first, data, size);
+        }
+    }
+
+    void GLTrace::WriteArgument(const GLTraceData& data) {
+        uint32_t size = data.data != NULL ? (uint32_t)data.size : TRACE_NULL_DATA;
+        WriteBytes(&size, sizeof(size), sizeof(size));
+        if (data.data != NULL) {
+            WriteBytes(data.data, data.size, data.size);
+        }
+    }
+
+    void GLTrace::WriteArgument(const GLTraceOffset& offset) {
+        WriteBytes(&offset.offset, sizeof(offset.offset), sizeof(offset.offset));
+    }
+
+    void GLTrace::WriteArgument(const GLTraceSource& source) {
+        std::string text;
+        for (GLsizei i = 0; i < source.count; i++) {
+            if (source.lengths != NULL && source.lengths[i] >= 0) {
+                text.append(source.strings[i], source.lengths[i]);
+            }
+            else {
+                text.append(source.strings[i]);
+            }
+        }
+        WriteArgument(GLTraceData(text.c_str(), text.size() + 1));
+    }
+
+    size_t GLTrace::ImageSize(GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, GLint alignment) {
+        size_t components = 4;
+        switch (format) {
+        case GL_RED:
+        case GL_DEPTH_COMPONENT:
+            components = 1;
+            break;
+        case GL_RG:
+        case GL_DEPTH_STENCIL:
+            components = 2;
+            break;
+        case GL_RGB:
+        case GL_BGR:
+            components = 3;
+            break;
+        }
+
+        size_t componentSize = 1;
+        switch (type) {
+        case GL_UNSIGNED_SHORT:
+        case GL_SHORT:
+        case GL_HALF_FLOAT:
+            componentSize = 2;
+            break;
+        case GL_UNSIGNED_INT:
+        case GL_INT:
+        case GL_FLOAT:
+            componentSize = 4;
+            break;
+        case GL_UNSIGNED_INT_24_8:
+            //one packed value per pixel
+            components = 1;
+            componentSize = 4;
+            break;
+        }
+
+        size_t rowSize = (size_t)width * components * componentSize;
+        rowSize = (rowSize + alignment - 1) / alignment * alignment;
+        return rowSize * height * depth;
+    }
+
+    GLint GLTrace::GetUnpackAlignment() {
+        GLint alignment = 4;
+        glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+        return alignment;
+    }
+
+    bool GLTraceReader::Open(std::string fileName) {
+        std::ifstream file(fileName, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) {
+            std::cerr << "Could not open the GL trace " << fileName << std::endl;
+            return false;
+        }
+
+        std::streamsize size = file.tellg();
+        file.seekg(0);
+        if (size < (std::streamsize)sizeof(header) || !file.read((char*)&header, sizeof(header)) ||
+            memcmp(header.magic, traceMagic, sizeof(traceMagic)) != 0 || header.version != TRACE_VERSION) {
+            std::cerr << fileName << " is not a GL trace of this version" << std::endl;
+            return false;
+        }
+
+        words.resize((size_t)(size - sizeof(header)) / sizeof(uint32_t));
+        file.read((char*)words.data(), words.size() * sizeof(uint32_t));
+        position = 0;
+        return true;
+    }
+
+    const void* GLTraceReader::ReadData(size_t* size) {
+        uint32_t byteCount = Read<uint32_t>();
+        if (byteCount == TRACE_NULL_DATA) {
+            if (size != NULL) {
+                *size = 0;
+            }
+            return NULL;
+        }
+
+        size_t dataWords = (byteCount + 3) / 4;
+        if (position + dataWords > words.size()) {
+            position = words.size();
+            if (size != NULL) {
+                *size = 0;
+            }
+            return NULL;
+        }
+
+        const void* data = words.data() + position;
+        position += dataWords;
+        if (size != NULL) {
+            *size = byteCount;
+        }
+        return data;
+    }
+}
@@ -0,0 +1,208 @@
+#ifndef GLTrace_hpp
+#define GLTrace_hpp
+
+#if defined (__APPLE__)
+    #define GL_SILENCE_DEPRECATION
+    #include <OpenGL/gl3.h>
+#else
+    #define GLEW_STATIC
+    #include <GL/glew.h>
+#endif
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace gps {
+
+    //the recorded entry points, new ones go at the end so older traces still replay
+    enum GL_TRACE_COMMAND {
+        GL_TRACE_FRAME,
+        GL_TRACE_glUniform1i,
+        GL_TRACE_glUniform1f,
+        GL_TRACE_glUniform1fv,
+        GL_TRACE_glUniform2f,
+        GL_TRACE_glUniform3fv,
+        GL_TRACE_glUniform3i,
+        GL_TRACE_glUniformMatrix3fv,
+        GL_TRACE_glUniformMatrix4fv,
+        GL_TRACE_glGetUniformLocation,
+        GL_TRACE_glBindTexture,
+        GL_TRACE_glActiveTexture,
+        GL_TRACE_glUseProgram,
+        GL_TRACE_glDrawElements,
+        GL_TRACE_glDrawArrays,
+        GL_TRACE_glBindVertexArray,
+        GL_TRACE_glBindFramebuffer,
+        GL_TRACE_glBindBuffer,
+        GL_TRACE_glClear,
+        GL_TRACE_glClearColor,
+        GL_TRACE_glViewport,
+        GL_TRACE_glEnable,
+        GL_TRACE_glDisable,
+        GL_TRACE_glDepthFunc,
+        GL_TRACE_glDepthMask,
+        GL_TRACE_glColorMask,
+        GL_TRACE_glCullFace,
+        GL_TRACE_glFrontFace,
+        GL_TRACE_glPolygonMode,
+        GL_TRACE_glDrawBuffer,
+        GL_TRACE_glDrawBuffers,
+        GL_TRACE_glReadBuffer,
+        GL_TRACE_glPixelStorei,
+        GL_TRACE_glBindRenderbuffer,
+        GL_TRACE_glFlush,
+        GL_TRACE_glGenBuffers,
+        GL_TRACE_glDeleteBuffers,
+        GL_TRACE_glBufferData,
+        GL_TRACE_glTexBuffer,
+        GL_TRACE_glGenTextures,
+        GL_TRACE_glDeleteTextures,
+        GL_TRACE_glTexImage2D,
+        GL_TRACE_glTexImage3D,
+        GL_TRACE_glTexParameteri,
+        GL_TRACE_glTexParameterfv,
+        GL_TRACE_glGenerateMipmap,
+        GL_TRACE_glGenVertexArrays,
+        GL_TRACE_glDeleteVertexArrays,
+        GL_TRACE_glVertexAttribPointer,
+        GL_TRACE_glEnableVertexAttribArray,
+        GL_TRACE_glGenFramebuffers,
+        GL_TRACE_glDeleteFramebuffers,
+        GL_TRACE_glFramebufferTexture2D,
+        GL_TRACE_glFramebufferTextureLayer,
+        GL_TRACE_glFramebufferRenderbuffer,
+        GL_TRACE_glGenRenderbuffers,
+        GL_TRACE_glDeleteRenderbuffers,
+        GL_TRACE_glRenderbufferStorage,
+        GL_TRACE_glCreateShader,
+        GL_TRACE_glShaderSource,
+        GL_TRACE_glCompileShader,
+        GL_TRACE_glDeleteShader,
+        GL_TRACE_glCreateProgram,
+        GL_TRACE_glAttachShader,
+        GL_TRACE_glDetachShader,
+        GL_TRACE_glLinkProgram,
+        GL_TRACE_glDeleteProgram,
+        GL_TRACE_glGetShaderiv,
+        GL_TRACE_glGetProgramiv,
+        GL_TRACE_glGenQueries,
+        GL_TRACE_glDeleteQueries,
+        GL_TRACE_glBeginQuery,
+        GL_TRACE_glEndQuery,
+        GL_TRACE_glQueryCounter,
+        GL_TRACE_glGetQueryObjectuiv,
+        GL_TRACE_glGetQueryObjectui64v,
+        GL_TRACE_glReadPixels,
+        GL_TRACE_glBlendFunc,
+        GL_TRACE_COMMAND_COUNT
+    };
+
+    //client memory copied into the trace, a NULL pointer stays NULL on replay
+    struct GLTraceData {
+        GLTraceData(const void* data, size_t size) : data(data), size(data != NULL ? size : 0) {}
+        const void* data;
+        size_t size;
+    };
+
+    //a pointer argument that is an offset into a bound buffer
+    struct GLTraceOffset {
+        explicit GLTraceOffset(const void* pointer) : offset((uint64_t)(uintptr_t)pointer) {}
+        uint64_t offset;
+    };
+
+    //the strings of glShaderSource, recorded as one source
+    struct GLTraceSource {
+        GLTraceSource(GLsizei count, const GLchar* const* strings, const GLint* lengths)
+            : count(count), strings(strings), lengths(lengths) {}
+        GLsizei count;
+        const GLchar* const* strings;
+        const GLint* lengths;
+    };
+
+    //file layout: header, then per command its id and arguments, every value in 4 byte words
+    //(8 for 64 bit values), client memory as a byte count and the bytes padded to a word
+    struct GLTraceHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t width;
+        uint32_t height;
+        uint32_t reserved;
+    };
+
+    //records every GL call of the intercepted entry points (GPS_GL_INTERCEPT builds) from the start
+    //of the program for a number of frames, for GLReplay
+    class GLTrace {
+
+    public:
+        //before the window is created, so the setup calls are in the trace too
+        static bool BeginCapture(std::string fileName, int frames, int width, int height);
+        static bool IsCapturing() { return capturing; }
+        //once per frame after the swap, ends the capture after the requested frames
+        static void EndFrame();
+        static void EndCapture();
+
+        static void BeginCommand(GL_TRACE_COMMAND command);
+        static void Write() {}
+        template <typename T, typename... Rest>
+        static void Write(const T& value, const Rest&... rest) {
+            WriteArgument(value);
+            Write(rest...);
+        }
+
+        //bytes of a glTexImage upload or glReadPixels with the current pixel store alignment
+        static size_t ImageSize(GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, GLint alignment);
+        static GLint GetUnpackAlignment();
+
+    private:
+        static bool capturing;
+
+        template <typename T>
+        static void WriteArgument(const T& value) {
+            static_assert(std::is_arithmetic<T>::value && sizeof(T) <= 8, "unsupported GL trace argument");
+            WriteBytes(&value, sizeof(T), sizeof(T) <= 4 ? 4 : 8);
+        }
+        static void WriteArgument(const GLTraceData& data);
+        static void WriteArgument(const GLTraceOffset& offset);
+        static void WriteArgument(const GLTraceSource& source);
+        //size bytes of data in a slot of slotSize bytes, zero padded
+        static void WriteBytes(const void* data, size_t size, size_t slotSize);
+    };
+
+    //reads a whole trace into memory, so the replay does not wait for the disk
+    class GLTraceReader {
+
+    public:
+        bool Open(std::string fileName);
+        const GLTraceHeader& GetHeader() { return header; }
+        bool AtEnd() { return position >= words.size(); }
+        size_t GetPosition() { return position; }
+        void Seek(size_t position) { this->position = position; }
+
+        GL_TRACE_COMMAND ReadCommand() { return (GL_TRACE_COMMAND)Read<uint32_t>(); }
+        template <typename T>
+        T Read() {
+            T value = T();
+            size_t slotWords = sizeof(T) <= 4 ? 1 : 2;
+            if (position + slotWords > words.size()) {
+                position = words.size();
+                return value;
+            }
+            memcpy(&value, &words[position], sizeof(T));
+            position += slotWords;
+            return value;
+        }
+        //NULL when NULL was recorded
+        const void* ReadData(size_t* size = NULL);
+        const void* ReadOffset() { return (const void*)(uintptr_t)Read<uint64_t>(); }
+
+    private:
+        GLTraceHeader header;
+        std::vector<uint32_t> words;
+        size_t position = 0;
+    };
+}
+
+#endif /* GLTrace_hpp */
@@ -0,0 +1,76 @@
+#include "GpuMemory.hpp"
+
+#include <map>
+#include <utility>
+
+namespace gps {
+
+    //GL thread only, objects are created and deleted there
+    static std::map<std::pair<int, GLuint>, long long> objects;
+    static long long totals[GPU_MEMORY_KIND_COUNT] = {};
+    static int counts[GPU_MEMORY_KIND_COUNT] = {};
+
+    void GpuMemory::Track(GPU_MEMORY_KIND kind, GLuint name, long long bytes) {
+        if (name == 0) {
+            return;
+        }
+
+        std::pair<std::map<std::pair<int, GLuint>, long long>::iterator, bool> inserted =
+            objects.insert(std::make_pair(std::make_pair((int)kind, name), bytes));
+        if (inserted.second) {
+            counts[kind]++;
+        }
+        else {
+            totals[kind] -= inserted.first->second;
+            inserted.first->second = bytes;
+        }
+        totals[kind] += bytes;
+    }
+
+    void GpuMemory::Release(GPU_MEMORY_KIND kind, GLuint name) {
+        std::map<std::pair<int, GLuint>, long long>::iterator found = objects.find(std::make_pair((int)kind, name));
+        if (found == objects.end()) {
+            return;
+        }
+
+        totals[kind] -= found->second;
+        counts[kind]--;
+        objects.erase(found);
+    }
+
+    long long GpuMemory::GetBytes(GPU_MEMORY_KIND kind) {
+        return totals[kind];
+    }
+
+    int GpuMemory::GetObjectCount(GPU_MEMORY_KIND kind) {
+        return counts[kind];
+    }
+
+    //three component formats are counted as four, drivers store them padded
+    static int BytesPerTexel(GLenum internalFormat) {
+        switch (internalFormat) {
+        case GL_R8:
+            return 1;
+        case GL_RG8:
+        case GL_R16:
+        case GL_R16F:
+        case GL_DEPTH_COMPONENT16:
+            return 2;
+        case GL_RGBA16F:
+        case GL_RGBA16:
+        case GL_RG32F:
+            return 8;
+        case GL_RGB32F:
+        case GL_RGBA32F:
+            return 16;
+        default:
+            //RGB(A)8, sRGB, RG16, R32F, 24 and 32 bit depth, depth stencil
+            return 4;
+        }
+    }
+
+    long long GpuMemory::ImageBytes(GLsizei width, GLsizei height, GLsizei depth, GLenum internalFormat, bool mipmaps) {
+        long long bytes = (long long)width * height * depth * BytesPerTexel(internalFormat);
+        return mipmaps ? bytes * 4 / 3 : bytes;
+    }
+}
@@ -0,0 +1,36 @@
+#ifndef GpuMemory_hpp
+#define GpuMemory_hpp
+
+#if defined (__APPLE__)
+    #define GL_SILENCE_DEPRECATION
+    #include <OpenGL/gl3.h>
+#else
+    #define GLEW_STATIC
+    #include <GL/glew.h>
+#endif
+
+namespace gps {
+
+    enum GPU_MEMORY_KIND {
+        GPU_MEMORY_TEXTURE,
+        GPU_MEMORY_RENDERBUFFER,
+        GPU_MEMORY_BUFFER,
+        GPU_MEMORY_KIND_COUNT
+    };
+
+    //bytes of the GL objects we allocate, an estimate: the driver may pad, compress or keep copies
+    //objects are keyed by kind and name, tracking a name again replaces its old size
+    class GpuMemory {
+
+    public:
+        static void Track(GPU_MEMORY_KIND kind, GLuint name, long long bytes);
+        static void Release(GPU_MEMORY_KIND kind, GLuint name);
+        static long long GetBytes(GPU_MEMORY_KIND kind);
+        static int GetObjectCount(GPU_MEMORY_KIND kind);
+
+        //size of an image of the internal format, a full mip chain adds a third
+        static long long ImageBytes(GLsizei width, GLsizei height, GLsizei depth, GLenum internalFormat, bool mipmaps);
+    };
+}
+
+#endif /* GpuMemory_hpp */
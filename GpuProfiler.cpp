@@ -0,0 +1,209 @@
+#include "GpuProfiler.hpp"
+#include "AllocationTracker.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+//the ARB_pipeline_statistics_query tokens, missing from some GL headers
+#ifndef GL_VERTICES_SUBMITTED_ARB
+    #define GL_VERTICES_SUBMITTED_ARB 0x82EE
+    #define GL_PRIMITIVES_SUBMITTED_ARB 0x82EF
+    #define GL_FRAGMENT_SHADER_INVOCATIONS_ARB 0x82F4
+#endif
+
+namespace gps {
+
+    static const GLenum statisticTargets[GPU_STATISTICS_COUNT] = {
+        GL_VERTICES_SUBMITTED_ARB,
+        GL_PRIMITIVES_SUBMITTED_ARB,
+        GL_FRAGMENT_SHADER_INVOCATIONS_ARB
+    };
+
+    void GpuProfiler::Init(bool pipelineStatistics) {
+
+#if defined (__APPLE__)
+        this->pipelineStatistics = false;
+#else
+        this->pipelineStatistics = pipelineStatistics && GLEW_ARB_pipeline_statistics_query;
+        if (pipelineStatistics && !this->pipelineStatistics)
+            std::cout << "GPU profiler: ARB_pipeline_statistics_query is not available" << std::endl;
+#endif
+        if (track == nullptr)
+            track = Profiler::CreateTrack("GPU");
+    }
+
+    //looked up by the plain name, so a known name costs no allocation
+    const char* GpuProfiler::Intern(const std::string& name) {
+        std::map<std::string, std::string>::iterator found = names.find(name);
+        if (found == names.end())
+            found = names.insert(std::make_pair(name, "gpu " + name)).first;
+        return found->second.c_str();
+    }
+
+    void GpuProfiler::BeginFrame() {
+
+        GPS_ALLOC_TAG("gpu profiler");
+        //the slot about to be reused was recorded GPU_PROFILER_FRAMES frames ago
+        Frame& frame = frames[frameIndex % GPU_PROFILER_FRAMES];
+        ResolveFrame(frame);
+        frame.scopes.clear();
+        frame.lastQuery = 0;
+
+        //the GPU clock has its own origin, line it up with the CPU scopes
+        GLint64 gpuNow = 0;
+        glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+        frame.clockOffset = Profiler::Now() - (long long)gpuNow;
+
+        openScopes.clear();
+        active = true;
+    }
+
+    void GpuProfiler::BeginScope(const char* name) {
+
+        if (!active)
+            return;
+
+        Frame& frame = frames[frameIndex % GPU_PROFILER_FRAMES];
+        int index = (int)frame.scopes.size();
+
+        //only one statistics query per target can be active, so nested scopes go without
+        Scope scope;
+        scope.name = name;
+        scope.depth = (int)openScopes.size();
+        scope.statistics = pipelineStatistics && scope.depth == 0;
+        frame.scopes.push_back(scope);
+        openScopes.push_back(index);
+
+        //the query objects of a slot are reused frame after frame
+        if ((int)frame.timestamps.size() < 2 * (index + 1)) {
+            frame.timestamps.resize(2 * (index + 1));
+            glGenQueries(2, &frame.timestamps[2 * index]);
+        }
+        glQueryCounter(frame.timestamps[2 * index], GL_TIMESTAMP);
+
+        if (scope.statistics) {
+            if ((int)frame.statistics.size() < GPU_STATISTICS_COUNT * (index + 1)) {
+                size_t first = frame.statistics.size();
+                frame.statistics.resize(GPU_STATISTICS_COUNT * (index + 1));
+                glGenQueries((GLsizei)(frame.statistics.size() - first), &frame.statistics[first]);
+            }
+            for (int s = 0; s < GPU_STATISTICS_COUNT; s++)
+                glBeginQuery(statisticTargets[s], frame.statistics[GPU_STATISTICS_COUNT * index + s]);
+        }
+    }
+
+    void GpuProfiler::EndScope() {
+
+        if (!active || openScopes.empty())
+            return;
+
+        Frame& frame = frames[frameIndex % GPU_PROFILER_FRAMES];
+        int index = openScopes.back();
+        openScopes.pop_back();
+
+        if (frame.scopes[index].statistics) {
+            for (int s = 0; s < GPU_STATISTICS_COUNT; s++)
+                glEndQuery(statisticTargets[s]);
+        }
+        glQueryCounter(frame.timestamps[2 * index + 1], GL_TIMESTAMP);
+        frame.lastQuery = frame.timestamps[2 * index + 1];
+    }
+
+    void GpuProfiler::EndFrame() {
+
+        if (!active)
+            return;
+
+        //scopes left open would never get their end timestamp
+        while (!openScopes.empty())
+            EndScope();
+        active = false;
+        frameIndex++;
+    }
+
+    //never waits: when the last timestamp or any statistics query is not available the whole frame is dropped
+    void GpuProfiler::ResolveFrame(Frame& frame) {
+
+        if (frame.scopes.empty() || frame.lastQuery == 0)
+            return;
+
+        //timestamps complete in order, the statistics queries are not ordered with them
+        GLuint available = GL_FALSE;
+        glGetQueryObjectuiv(frame.lastQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+        for (size_t i = 0; i < frame.scopes.size() && available; i++) {
+
+            if (!frame.scopes[i].statistics)
+                continue;
+            for (int s = 0; s < GPU_STATISTICS_COUNT && available; s++)
+                glGetQueryObjectuiv(frame.statistics[GPU_STATISTICS_COUNT * i + s], GL_QUERY_RESULT_AVAILABLE, &available);
+        }
+        if (!available) {
+            droppedFrames++;
+            return;
+        }
+
+        for (std::map<const char*, double>::iterator it = lastMilliseconds.begin(); it != lastMilliseconds.end(); ++it)
+            it->second = -1.0;
+        for (size_t i = 0; i < frame.scopes.size(); i++) {
+
+            GLuint64 begin = 0, end = 0;
+            glGetQueryObjectui64v(frame.timestamps[2 * i], GL_QUERY_RESULT, &begin);
+            glGetQueryObjectui64v(frame.timestamps[2 * i + 1], GL_QUERY_RESULT, &end);
+            Profiler::Record(track, frame.scopes[i].name, (long long)begin + frame.clockOffset,
+                (long long)end + frame.clockOffset, frame.scopes[i].depth);
+            if (frame.scopes[i].depth == 0) {
+                double& milliseconds = lastMilliseconds[frame.scopes[i].name];
+                milliseconds = std::max(milliseconds, 0.0) + (end - begin) / 1000000.0;
+            }
+
+            if (frame.scopes[i].statistics) {
+                GLuint64 values[GPU_STATISTICS_COUNT];
+                for (int s = 0; s < GPU_STATISTICS_COUNT; s++)
+                    glGetQueryObjectui64v(frame.statistics[GPU_STATISTICS_COUNT * i + s], GL_QUERY_RESULT, &values[s]);
+
+                GpuStatistics statistics;
+                statistics.vertices = values[0];
+                statistics.primitives = values[1];
+                statistics.fragments = values[2];
+                lastStatistics[frame.scopes[i].name] = statistics;
+            }
+        }
+    }
+
+    void GpuProfiler::PrintStatistics() {
+
+        if (!pipelineStatistics) {
+            std::cout << "GPU profiler: no pipeline statistics" << std::endl;
+            return;
+        }
+
+        for (std::map<const char*, GpuStatistics>::iterator it = lastStatistics.begin(); it != lastStatistics.end(); ++it) {
+            std::cout << it->first << ": " << it->second.vertices << " vertices, " << it->second.primitives << " primitives, "
+                << it->second.fragments << " fragment invocations" << std::endl;
+        }
+        if (droppedFrames > 0)
+            std::cout << "GPU profiler: " << droppedFrames << " frames dropped, results not ready in time" << std::endl;
+    }
+
+    double GpuProfiler::GetLastMilliseconds(const char* name) {
+        std::map<const char*, double>::iterator found = lastMilliseconds.find(name);
+        return found != lastMilliseconds.end() ? found->second : -1.0;
+    }
+
+    int GpuProfiler::GetDroppedFrameCount() {
+        return droppedFrames;
+    }
+
+    void GpuProfiler::Delete() {
+
+        for (int f = 0; f < GPU_PROFILER_FRAMES; f++) {
+            if (!frames[f].timestamps.empty())
+                glDeleteQueries((GLsizei)frames[f].timestamps.size(), &frames[f].timestamps[0]);
+            if (!frames[f].statistics.empty())
+                glDeleteQueries((GLsizei)frames[f].statistics.size(), &frames[f].statistics[0]);
+            frames[f].timestamps.clear();
+            frames[f].statistics.clear();
+            frames[f].scopes.clear();
+        }
+    }
+}
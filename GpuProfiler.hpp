@@ -0,0 +1,90 @@
+#ifndef GpuProfiler_hpp
+#define GpuProfiler_hpp
+
+#if defined (__APPLE__)
+    #define GL_SILENCE_DEPRECATION
+    #include <OpenGL/gl3.h>
+#else
+    #define GLEW_STATIC
+    #include <GL/glew.h>
+#endif
+
+#include "GLIntercept.hpp"
+#include "Profiler.hpp"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace gps {
+
+    //frames a query waits before it is read, a frame whose results are still not there is dropped
+    const int GPU_PROFILER_FRAMES = 4;
+    //vertices, primitives and fragment shader invocations
+    const int GPU_STATISTICS_COUNT = 3;
+
+    struct GpuStatistics {
+        GLuint64 vertices;
+        GLuint64 primitives;
+        GLuint64 fragments;
+    };
+
+    //GL_TIMESTAMP pairs around nested GPU scopes, read back GPU_PROFILER_FRAMES frames later
+    //the intervals go to a "GPU" profiler track, so they show up in the averages and the trace
+    //outermost scopes can also count pipeline statistics (ARB_pipeline_statistics_query)
+    class GpuProfiler {
+
+    public:
+        //GL thread only
+        void Init(bool pipelineStatistics);
+        void BeginFrame();
+        //name has to live until the frame is read back, see Intern
+        void BeginScope(const char* name);
+        void EndScope();
+        void EndFrame();
+        //a stable copy of the name with a "gpu " prefix, apart from the CPU scope names
+        const char* Intern(const std::string& name);
+        //pipeline statistics of the outermost scopes of the last frame read back
+        void PrintStatistics();
+        //GPU time of an outermost scope in the last frame read back, -1 when it did not run
+        //name as returned by Intern
+        double GetLastMilliseconds(const char* name);
+        int GetDroppedFrameCount();
+        void Delete();
+
+    private:
+        struct Scope {
+            const char* name;
+            int depth;
+            bool statistics;
+        };
+
+        struct Frame {
+            std::vector<Scope> scopes;
+            //two timestamps per scope, GPU_STATISTICS_COUNT statistics queries per scope
+            std::vector<GLuint> timestamps;
+            std::vector<GLuint> statistics;
+            //Profiler::Now() minus the GPU clock when the frame began
+            long long clockOffset;
+            //the end timestamp issued last, enclosing scopes end after the scopes they contain
+            GLuint lastQuery = 0;
+        };
+
+        Frame frames[GPU_PROFILER_FRAMES];
+        int frameIndex = 0;
+        bool active = false;
+        bool pipelineStatistics = false;
+        std::vector<int> openScopes;
+        //plain name to prefixed name
+        std::map<std::string, std::string> names;
+        ProfileThreadBuffer* track = nullptr;
+        //keyed by the interned names, the entries stay so a frame does not allocate
+        std::map<const char*, GpuStatistics> lastStatistics;
+        std::map<const char*, double> lastMilliseconds;
+        int droppedFrames = 0;
+
+        void ResolveFrame(Frame& frame);
+    };
+}
+
+#endif /* GpuProfiler_hpp */
@@ -0,0 +1,317 @@
+#include "Hud.hpp"
+#include "GpuMemory.hpp"
+#include "Profiler.hpp"
+#include "AllocationTracker.hpp"
+
+#include <cstdarg>
+#include <cstddef>
+#include <cstdio>
+
+namespace gps {
+
+    //the atlas holds the printable ASCII range, 16 glyphs per row
+    const int ATLAS_FIRST_CHAR = 32;
+    const int ATLAS_COLUMNS = 16;
+    const int ATLAS_ROWS = 6;
+    //glyph 127 is filled, the solid quads sample its middle
+    const int SOLID_CHAR = 127;
+    //the graph never zooms in further than 30 fps
+    const float GRAPH_MIN_SCALE = 1000.0f / 30.0f;
+
+    //font8x8_basic by Daniel Hepper (public domain), one byte per row, bit 0 is the leftmost pixel
+    static const unsigned char font8x8[96][8] = {
+        { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // space
+        { 0x18, 0x3C, 0x3C, 0x18, 0x18, 0x00, 0x18, 0x00 }, // !
+        { 0x36, 0x36, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // "
+        { 0x36, 0x36, 0x7F, 0x36, 0x7F, 0x36, 0x36, 0x00 }, // #
+        { 0x0C, 0x3E, 0x03, 0x1E, 0x30, 0x1F, 0x0C, 0x00 }, // $
+        { 0x00, 0x63, 0x33, 0x18, 0x0C, 0x66, 0x63, 0x00 }, // %
+        { 0x1C, 0x36, 0x1C, 0x6E, 0x3B, 0x33, 0x6E, 0x00 }, // &
+        { 0x06, 0x06, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '
+        { 0x18, 0x0C, 0x06, 0x06, 0x06, 0x0C, 0x18, 0x00 }, // (
+        { 0x06, 0x0C, 0x18, 0x18, 0x18, 0x0C, 0x06, 0x00 }, // )
+        { 0x00, 0x66, 0x3C, 0xFF, 0x3C, 0x66, 0x00, 0x00 }, // *
+        { 0x00, 0x0C, 0x0C, 0x3F, 0x0C, 0x0C, 0x00, 0x00 }, // +
+        { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x06 }, // ,
+        { 0x00, 0x00, 0x00, 0x3F, 0x00, 0x00, 0x00, 0x00 }, // -
+        { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x00 }, // .
+        { 0x60, 0x30, 0x18, 0x0C, 0x06, 0x03, 0x01, 0x00 }, // /
+        { 0x3E, 0x63, 0x73, 0x7B, 0x6F, 0x67, 0x3E, 0x00 }, // 0
+        { 0x0C, 0x0E, 0x0C, 0x0C, 0x0C, 0x0C, 0x3F, 0x00 }, // 1
+        { 0x1E, 0x33, 0x30, 0x1C, 0x06, 0x33, 0x3F, 0x00 }, // 2
+        { 0x1E, 0x33, 0x30, 0x1C, 0x30, 0x33, 0x1E, 0x00 }, // 3
+        { 0x38, 0x3C, 0x36, 0x33, 0x7F, 0x30, 0x78, 0x00 }, // 4
+        { 0x3F, 0x03, 0x1F, 0x30, 0x30, 0x33, 0x1E, 0x00 }, // 5
+        { 0x1C, 0x06, 0x03, 0x1F, 0x33, 0x33, 0x1E, 0x00 }, // 6
+        { 0x3F, 0x33, 0x30, 0x18, 0x0C, 0x0C, 0x0C, 0x00 }, // 7
+        { 0x1E, 0x33, 0x33, 0x1E, 0x33, 0x33, 0x1E, 0x00 }, // 8
+        { 0x1E, 0x33, 0x33, 0x3E, 0x30, 0x18, 0x0E, 0x00 }, // 9
+        { 0x00, 0x0C, 0x0C, 0x00, 0x00, 0x0C, 0x0C, 0x00 }, // :
+        { 0x00, 0x0C, 0x0C, 0x00, 0x00, 0x0C, 0x0C, 0x06 }, // ;
+        { 0x18, 0x0C, 0x06, 0x03, 0x06, 0x0C, 0x18, 0x00 }, // <
+        { 0x00, 0x00, 0x3F, 0x00, 0x00, 0x3F, 0x00, 0x00 }, // =
+        { 0x06, 0x0C, 0x18, 0x30, 0x18, 0x0C, 0x06, 0x00 }, // >
+        { 0x1E, 0x33, 0x30, 0x18, 0x0C, 0x00, 0x0C, 0x00 }, // ?
+        { 0x3E, 0x63, 0x7B, 0x7B, 0x7B, 0x03, 0x1E, 0x00 }, // @
+        { 0x0C, 0x1E, 0x33, 0x33, 0x3F, 0x33, 0x33, 0x00 }, // A
+        { 0x3F, 0x66, 0x66, 0x3E, 0x66, 0x66, 0x3F, 0x00 }, // B
+        { 0x3C, 0x66, 0x03, 0x03, 0x03, 0x66, 0x3C, 0x00 }, // C
+        { 0x1F, 0x36, 0x66, 0x66, 0x66, 0x36, 0x1F, 0x00 }, // D
+        { 0x7F, 0x46, 0x16, 0x1E, 0x16, 0x46, 0x7F, 0x00 }, // E
+        { 0x7F, 0x46, 0x16, 0x1E, 0x16, 0x06, 0x0F, 0x00 }, // F
+        { 0x3C, 0x66, 0x03, 0x03, 0x73, 0x66, 0x7C, 0x00 }, // G
+        { 0x33, 0x33, 0x33, 0x3F, 0x33, 0x33, 0x33, 0x00 }, // H
+        { 0x1E, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00 }, // I
+        { 0x78, 0x30, 0x30, 0x30, 0x33, 0x33, 0x1E, 0x00 }, // J
+        { 0x67, 0x66, 0x36, 0x1E, 0x36, 0x66, 0x67, 0x00 }, // K
+        { 0x0F, 0x06, 0x06, 0x06, 0x46, 0x66, 0x7F, 0x00 }, // L
+        { 0x63, 0x77, 0x7F, 0x7F, 0x6B, 0x63, 0x63, 0x00 }, // M
+        { 0x63, 0x67, 0x6F, 0x7B, 0x73, 0x63, 0x63, 0x00 }, // N
+        { 0x1C, 0x36, 0x63, 0x63, 0x63, 0x36, 0x1C, 0x00 }, // O
+        { 0x3F, 0x66, 0x66, 0x3E, 0x06, 0x06, 0x0F, 0x00 }, // P
+        { 0x1E, 0x33, 0x33, 0x33, 0x3B, 0x1E, 0x38, 0x00 }, // Q
+        { 0x3F, 0x66, 0x66, 0x3E, 0x36, 0x66, 0x67, 0x00 }, // R
+        { 0x1E, 0x33, 0x07, 0x0E, 0x38, 0x33, 0x1E, 0x00 }, // S
+        { 0x3F, 0x2D, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00 }, // T
+        { 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x3F, 0x00 }, // U
+        { 0x33, 0x33, 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x00 }, // V
+        { 0x63, 0x63, 0x63, 0x6B, 0x7F, 0x77, 0x63, 0x00 }, // W
+        { 0x63, 0x63, 0x36, 0x1C, 0x1C, 0x36, 0x63, 0x00 }, // X
+        { 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x0C, 0x1E, 0x00 }, // Y
+        { 0x7F, 0x63, 0x31, 0x18, 0x4C, 0x66, 0x7F, 0x00 }, // Z
+        { 0x1E, 0x06, 0x06, 0x06, 0x06, 0x06, 0x1E, 0x00 }, // [
+        { 0x03, 0x06, 0x0C, 0x18, 0x30, 0x60, 0x40, 0x00 }, // backslash
+        { 0x1E, 0x18, 0x18, 0x18, 0x18, 0x18, 0x1E, 0x00 }, // ]
+        { 0x08, 0x1C, 0x36, 0x63, 0x00, 0x00, 0x00, 0x00 }, // ^
+        { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF }, // _
+        { 0x0C, 0x0C, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00 }, // `
+        { 0x00, 0x00, 0x1E, 0x30, 0x3E, 0x33, 0x6E, 0x00 }, // a
+        { 0x07, 0x06, 0x06, 0x3E, 0x66, 0x66, 0x3B, 0x00 }, // b
+        { 0x00, 0x00, 0x1E, 0x33, 0x03, 0x33, 0x1E, 0x00 }, // c
+        { 0x38, 0x30, 0x30, 0x3E, 0x33, 0x33, 0x6E, 0x00 }, // d
+        { 0x00, 0x00, 0x1E, 0x33, 0x3F, 0x03, 0x1E, 0x00 }, // e
+        { 0x1C, 0x36, 0x06, 0x0F, 0x06, 0x06, 0x0F, 0x00 }, // f
+        { 0x00, 0x00, 0x6E, 0x33, 0x33, 0x3E, 0x30, 0x1F }, // g
+        { 0x07, 0x06, 0x36, 0x6E, 0x66, 0x66, 0x67, 0x00 }, // h
+        { 0x0C, 0x00, 0x0E, 0x0C, 0x0C, 0x0C, 0x1E, 0x00 }, // i
+        { 0x30, 0x00, 0x30, 0x30, 0x30, 0x33, 0x33, 0x1E }, // j
+        { 0x07, 0x06, 0x66, 0x36, 0x1E, 0x36, 0x67, 0x00 }, // k
+        { 0x0E, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00 }, // l
+        { 0x00, 0x00, 0x33, 0x7F, 0x7F, 0x6B, 0x63, 0x00 }, // m
+        { 0x00, 0x00, 0x1F, 0x33, 0x33, 0x33, 0x33, 0x00 }, // n
+        { 0x00, 0x00, 0x1E, 0x33, 0x33, 0x33, 0x1E, 0x00 }, // o
+        { 0x00, 0x00, 0x3B, 0x66, 0x66, 0x3E, 0x06, 0x0F }, // p
+        { 0x00, 0x00, 0x6E, 0x33, 0x33, 0x3E, 0x30, 0x78 }, // q
+        { 0x00, 0x00, 0x3B, 0x6E, 0x66, 0x06, 0x0F, 0x00 }, // r
+        { 0x00, 0x00, 0x3E, 0x03, 0x1E, 0x30, 0x1F, 0x00 }, // s
+        { 0x08, 0x0C, 0x3E, 0x0C, 0x0C, 0x2C, 0x18, 0x00 }, // t
+        { 0x00, 0x00, 0x33, 0x33, 0x33, 0x33, 0x6E, 0x00 }, // u
+        { 0x00, 0x00, 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x00 }, // v
+        { 0x00, 0x00, 0x63, 0x6B, 0x7F, 0x7F, 0x36, 0x00 }, // w
+        { 0x00, 0x00, 0x63, 0x36, 0x1C, 0x36, 0x63, 0x00 }, // x
+        { 0x00, 0x00, 0x33, 0x33, 0x33, 0x3E, 0x30, 0x1F }, // y
+        { 0x00, 0x00, 0x3F, 0x19, 0x0C, 0x26, 0x3F, 0x00 }, // z
+        { 0x38, 0x0C, 0x0C, 0x07, 0x0C, 0x0C, 0x38, 0x00 }, // {
+        { 0x18, 0x18, 0x18, 0x00, 0x18, 0x18, 0x18, 0x00 }, // |
+        { 0x07, 0x0C, 0x0C, 0x38, 0x0C, 0x0C, 0x07, 0x00 }, // }
+        { 0x6E, 0x3B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // ~
+        { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF }  // solid
+    };
+
+    void Hud::Init() {
+        GPS_PROFILE_FUNCTION();
+        shader.loadShader("shaders/hud.vert", "shaders/hud.frag");
+        CreateAtlas();
+
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+
+        glBindVertexArray(VAO);
+        GPS_GL_LABEL(GL_VERTEX_ARRAY, VAO, "hud");
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(HudVertex), (GLvoid*)offsetof(HudVertex, position));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(HudVertex), (GLvoid*)offsetof(HudVertex, texCoords));
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(HudVertex), (GLvoid*)offsetof(HudVertex, color));
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    //one byte of coverage per pixel, the first row of the font is the first row of the texture
+    void Hud::CreateAtlas() {
+
+        int atlasWidth = ATLAS_COLUMNS * HUD_GLYPH_SIZE;
+        int atlasHeight = ATLAS_ROWS * HUD_GLYPH_SIZE;
+        std::vector<unsigned char> pixels(atlasWidth * atlasHeight, 0);
+        for (int glyph = 0; glyph < ATLAS_COLUMNS * ATLAS_ROWS; glyph++) {
+
+            int left = (glyph % ATLAS_COLUMNS) * HUD_GLYPH_SIZE;
+            int top = (glyph / ATLAS_COLUMNS) * HUD_GLYPH_SIZE;
+            for (int row = 0; row < HUD_GLYPH_SIZE; row++) {
+                for (int column = 0; column < HUD_GLYPH_SIZE; column++) {
+                    if (font8x8[glyph][row] & (1 << column))
+                        pixels[(top + row) * atlasWidth + left + column] = 255;
+                }
+            }
+        }
+
+        glGenTextures(1, &atlasTexture);
+        glBindTexture(GL_TEXTURE_2D, atlasTexture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, atlasWidth, atlasHeight, 0, GL_RED, GL_UNSIGNED_BYTE, &pixels[0]);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        GPS_GL_LABEL(GL_TEXTURE, atlasTexture, "hud font");
+        GpuMemory::Track(GPU_MEMORY_TEXTURE, atlasTexture, GpuMemory::ImageBytes(atlasWidth, atlasHeight, 1, GL_R8, false));
+    }
+
+    void Hud::BeginFrame(int width, int height) {
+        this->width = width;
+        this->height = height;
+        vertices.clear();
+    }
+
+    GLuint Hud::PackColor(glm::vec4 color) {
+        GLuint packed = 0;
+        for (int c = 0; c < 4; c++)
+            packed |= (GLuint)(glm::clamp(color[c], 0.0f, 1.0f) * 255.0f + 0.5f) << (8 * c);
+        return packed;
+    }
+
+    //two triangles, the texture rows grow downwards like the pixels
+    void Hud::Quad(float x, float y, float width, float height, glm::vec2 texMin, glm::vec2 texMax, GLuint color) {
+
+        HudVertex corners[4] = {
+            { glm::vec2(x, y), texMin, color },
+            { glm::vec2(x + width, y), glm::vec2(texMax.x, texMin.y), color },
+            { glm::vec2(x + width, y + height), texMax, color },
+            { glm::vec2(x, y + height), glm::vec2(texMin.x, texMax.y), color }
+        };
+        const int order[6] = { 0, 3, 2, 0, 2, 1 };
+        for (int i = 0; i < 6; i++)
+            vertices.push_back(corners[order[i]]);
+    }
+
+    void Hud::Rect(float x, float y, float width, float height, glm::vec4 color) {
+
+        int solid = SOLID_CHAR - ATLAS_FIRST_CHAR;
+        glm::vec2 middle = glm::vec2((solid % ATLAS_COLUMNS + 0.5f) / ATLAS_COLUMNS, (solid / ATLAS_COLUMNS + 0.5f) / ATLAS_ROWS);
+        Quad(x, y, width, height, middle, middle, PackColor(color));
+    }
+
+    void Hud::Print(float x, float y, float scale, glm::vec4 color, const char* format, ...) {
+
+        char text[512];
+        va_list arguments;
+        va_start(arguments, format);
+        vsnprintf(text, sizeof(text), format, arguments);
+        va_end(arguments);
+
+        GLuint packed = PackColor(color);
+        float size = HUD_GLYPH_SIZE * scale;
+        float cursorX = x;
+        for (const char* c = text; *c != '\0'; c++) {
+
+            if (*c == '\n') {
+                cursorX = x;
+                y += size;
+                continue;
+            }
+
+            int character = (unsigned char)*c;
+            if (character < ATLAS_FIRST_CHAR || character >= SOLID_CHAR)
+                character = '?';
+            if (character != ' ') {
+                int glyph = character - ATLAS_FIRST_CHAR;
+                glm::vec2 texMin = glm::vec2((float)(glyph % ATLAS_COLUMNS) / ATLAS_COLUMNS, (float)(glyph / ATLAS_COLUMNS) / ATLAS_ROWS);
+                glm::vec2 texMax = texMin + glm::vec2(1.0f / ATLAS_COLUMNS, 1.0f / ATLAS_ROWS);
+                Quad(cursorX, y, size, size, texMin, texMax, packed);
+            }
+            cursorX += size;
+        }
+    }
+
+    void Hud::AddFrameTime(float milliseconds) {
+        frameTimes[frameTimeIndex] = milliseconds;
+        frameTimeIndex = (frameTimeIndex + 1) % HUD_GRAPH_SAMPLES;
+        if (frameTimeCount < HUD_GRAPH_SAMPLES)
+            frameTimeCount++;
+    }
+
+    //green up to 60 fps, yellow up to 30 fps, red below
+    void Hud::FrameTimeGraph(float x, float y, float width, float height) {
+
+        float scale = GRAPH_MIN_SCALE;
+        for (int i = 0; i < frameTimeCount; i++)
+            scale = glm::max(scale, frameTimes[i]);
+
+        Rect(x, y, width, height, glm::vec4(0.0f, 0.0f, 0.0f, 0.5f));
+
+        float barWidth = width / HUD_GRAPH_SAMPLES;
+        for (int i = 0; i < frameTimeCount; i++) {
+
+            //oldest first, the newest frame is on the right edge
+            float frameTime = frameTimes[(frameTimeIndex - frameTimeCount + i + HUD_GRAPH_SAMPLES) % HUD_GRAPH_SAMPLES];
+            float barHeight = height * frameTime / scale;
+            glm::vec4 color = frameTime <= 1000.0f / 60.0f ? glm::vec4(0.2f, 0.9f, 0.2f, 0.9f) :
+                frameTime <= 1000.0f / 30.0f ? glm::vec4(0.9f, 0.8f, 0.1f, 0.9f) : glm::vec4(0.9f, 0.2f, 0.1f, 0.9f);
+            Rect(x + width - (frameTimeCount - i) * barWidth, y + height - barHeight, barWidth, barHeight, color);
+        }
+
+        const float targets[2] = { 1000.0f / 60.0f, 1000.0f / 30.0f };
+        for (int t = 0; t < 2; t++) {
+            float lineY = y + height - height * targets[t] / scale;
+            Rect(x, lineY, width, 1.0f, glm::vec4(1.0f, 1.0f, 1.0f, 0.6f));
+            Print(x + 2.0f, lineY - HUD_GLYPH_SIZE - 1.0f, 1.0f, glm::vec4(1.0f, 1.0f, 1.0f, 0.8f), "%.1f", targets[t]);
+        }
+    }
+
+    void Hud::Draw() {
+        GPS_PROFILE_FUNCTION();
+        GPS_ALLOC_TAG("hud");
+        if (vertices.empty())
+            return;
+
+        //a new store every frame, the driver does not wait for the draw of the previous frame
+        GLsizeiptr size = vertices.size() * sizeof(HudVertex);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, size, &vertices[0], GL_STREAM_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        GpuMemory::Track(GPU_MEMORY_BUFFER, VBO, size);
+
+        shader.useShaderProgram();
+        glUniform2f(glGetUniformLocation(shader.shaderProgram, "screenSize"), (float)width, (float)height);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, atlasTexture);
+        glUniform1i(glGetUniformLocation(shader.shaderProgram, "glyphAtlas"), 0);
+
+        glDisable(GL_DEPTH_TEST);
+        glDisable(GL_CULL_FACE);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+        glBindVertexArray(VAO);
+        glDrawArrays(GL_TRIANGLES, 0, (GLsizei)vertices.size());
+        glBindVertexArray(0);
+
+        glDisable(GL_BLEND);
+        glEnable(GL_CULL_FACE);
+        glEnable(GL_DEPTH_TEST);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    void Hud::Delete() {
+        GpuMemory::Release(GPU_MEMORY_TEXTURE, atlasTexture);
+        GpuMemory::Release(GPU_MEMORY_BUFFER, VBO);
+        glDeleteTextures(1, &atlasTexture);
+        glDeleteBuffers(1, &VBO);
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteProgram(shader.shaderProgram);
+    }
+}
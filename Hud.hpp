@@ -0,0 +1,73 @@
+#ifndef Hud_hpp
+#define Hud_hpp
+
+#if defined (__APPLE__)
+    #define GL_SILENCE_DEPRECATION
+    #include <OpenGL/gl3.h>
+#else
+    #define GLEW_STATIC
+    #include <GL/glew.h>
+#endif
+
+#include "GLDebug.hpp"
+#include "GLIntercept.hpp"
+
+#include <glm/glm.hpp>
+
+#include "Shader.hpp"
+
+#include <vector>
+
+namespace gps {
+
+    //frames the frame time graph covers
+    const int HUD_GRAPH_SAMPLES = 240;
+    //the glyphs of the atlas are 8x8 pixels
+    const int HUD_GLYPH_SIZE = 8;
+
+    struct HudVertex {
+        //pixels from the top left corner of the window
+        glm::vec2 position;
+        glm::vec2 texCoords;
+        //RGBA8
+        GLuint color;
+    };
+
+    //text and solid quads over the finished frame, collected on the CPU and drawn with one
+    //buffer upload and one draw call, the font is an 8x8 bitmap baked into the program
+    class Hud {
+
+    public:
+        //GL thread only, after the context is created
+        void Init();
+        void BeginFrame(int width, int height);
+        //printf formatting, one line per '\n', scale multiplies the glyph size
+        void Print(float x, float y, float scale, glm::vec4 color, const char* format, ...);
+        void Rect(float x, float y, float width, float height, glm::vec4 color);
+        //the graph keeps the last HUD_GRAPH_SAMPLES frames
+        void AddFrameTime(float milliseconds);
+        //bars of the frame times with 60 and 30 fps lines, scaled to the slowest frame shown
+        void FrameTimeGraph(float x, float y, float width, float height);
+        //over whatever is bound, without depth test and with alpha blending
+        void Draw();
+        void Delete();
+
+    private:
+        gps::Shader shader;
+        GLuint atlasTexture = 0;
+        GLuint VAO = 0;
+        GLuint VBO = 0;
+        int width = 0;
+        int height = 0;
+        std::vector<HudVertex> vertices;
+        float frameTimes[HUD_GRAPH_SAMPLES] = {};
+        int frameTimeIndex = 0;
+        int frameTimeCount = 0;
+
+        void CreateAtlas();
+        void Quad(float x, float y, float width, float height, glm::vec2 texMin, glm::vec2 texMax, GLuint color);
+        static GLuint PackColor(glm::vec4 color);
+    };
+}
+
+#endif /* Hud_hpp */
@@ -0,0 +1,121 @@
+#include "JobSystem.hpp"
+#include "Profiler.hpp"
+#include "AllocationTracker.hpp"
+
+namespace gps {
+
+    JobSystem::~JobSystem() {
+        Shutdown();
+    }
+
+    //workerCount - 0 uses one worker less than the number of hardware threads
+    void JobSystem::Init(int workerCount) {
+
+        if (workerCount <= 0) {
+            int hardwareThreads = (int)std::thread::hardware_concurrency();
+            workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+        }
+
+        stopping = false;
+        nextIndex = 0;
+        for (int i = 0; i < workerCount; i++)
+            workers.push_back(std::thread(&JobSystem::WorkerLoop, this));
+    }
+
+    void JobSystem::Shutdown() {
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wakeCondition.notify_all();
+
+        for (size_t i = 0; i < workers.size(); i++)
+            workers[i].join();
+        workers.clear();
+    }
+
+    //run body(begin, end) over [0, count) in chunks of batchSize and wait for all of them
+    void JobSystem::Run(int count, int batchSize, void (*call)(const void*, int, int), const void* body) {
+
+        if (count <= 0)
+            return;
+
+        if (batchSize < 1)
+            batchSize = 1;
+
+        //not worth waking anybody up
+        if (workers.empty() || count <= batchSize) {
+            call(body, 0, count);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            this->call = call;
+            this->body = body;
+            this->count = count;
+            this->batchSize = batchSize;
+            allocationTag = AllocationTracker::GetTag();
+            nextIndex = 0;
+            busyWorkers = (int)workers.size();
+            generation++;
+        }
+        wakeCondition.notify_all();
+
+        RunBatches();
+
+        //every worker has to check in before body goes out of scope
+        std::unique_lock<std::mutex> lock(mutex);
+        doneCondition.wait(lock, [this] { return busyWorkers == 0; });
+        this->call = nullptr;
+        this->body = nullptr;
+    }
+
+    void JobSystem::WorkerLoop() {
+
+        GPS_PROFILE_THREAD("worker");
+
+        unsigned long long seenGeneration = 0;
+        while (true) {
+
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wakeCondition.wait(lock, [this, seenGeneration] { return stopping || generation != seenGeneration; });
+                if (stopping)
+                    return;
+                seenGeneration = generation;
+            }
+
+            //allocations in the loop count for the subsystem that started it
+            AllocationTracker::SetTag(allocationTag);
+            RunBatches();
+            AllocationTracker::SetTag(nullptr);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                busyWorkers--;
+                if (busyWorkers == 0)
+                    doneCondition.notify_one();
+            }
+        }
+    }
+
+    void JobSystem::RunBatches() {
+        GPS_PROFILE_FUNCTION();
+
+        while (true) {
+
+            int begin = nextIndex.fetch_add(batchSize);
+            if (begin >= count)
+                break;
+
+            int end = begin + batchSize < count ? begin + batchSize : count;
+            call(body, begin, end);
+        }
+    }
+
+    int JobSystem::GetWorkerCount() {
+        return (int)workers.size();
+    }
+}
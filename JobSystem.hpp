@@ -0,0 +1,57 @@
+#ifndef JobSystem_hpp
+#define JobSystem_hpp
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gps {
+
+    //a pool of worker threads running data parallel loops
+    //ParallelFor is meant to be called from one thread (the GL thread), which also takes part in the work
+    class JobSystem {
+
+    public:
+        ~JobSystem();
+        //workerCount - 0 uses one worker less than the number of hardware threads
+        void Init(int workerCount = 0);
+        void Shutdown();
+        //run body(begin, end) over [0, count) in chunks of batchSize and wait for all of them
+        //body is called through a pointer, a lambda is not wrapped in a std::function that could allocate
+        template <typename Body>
+        void ParallelFor(int count, int batchSize, const Body& body) {
+            Run(count, batchSize, &CallBody<Body>, &body);
+        }
+        int GetWorkerCount();
+
+    private:
+        std::vector<std::thread> workers;
+        std::mutex mutex;
+        std::condition_variable wakeCondition;
+        std::condition_variable doneCondition;
+        bool stopping = false;
+        unsigned long long generation = 0;
+        int busyWorkers = 0;
+
+        //the loop being executed
+        void (*call)(const void* body, int begin, int end) = nullptr;
+        const void* body = nullptr;
+        int count = 0;
+        int batchSize = 1;
+        const char* allocationTag = nullptr;
+        std::atomic<int> nextIndex;
+
+        template <typename Body>
+        static void CallBody(const void* body, int begin, int end) {
+            (*(const Body*)body)(begin, end);
+        }
+
+        void Run(int count, int batchSize, void (*call)(const void*, int, int), const void* body);
+        void WorkerLoop();
+        void RunBatches();
+    };
+}
+
+#endif /* JobSystem_hpp */
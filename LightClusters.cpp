@@ -0,0 +1,241 @@
+#include "LightClusters.hpp"
+#include "GpuMemory.hpp"
+#include "Profiler.hpp"
+#include "AllocationTracker.hpp"
+
+#include <cmath>
+
+namespace gps {
+
+    void LightClusters::Init() {
+
+        glGenBuffers(1, &lightBuffer);
+        glGenBuffers(1, &clusterBuffer);
+        glGenBuffers(1, &indexBuffer);
+
+        //texture buffers need a data store before they are attached
+        unsigned int empty[4] = { 0, 0, 0, 0 };
+        Upload(lightBuffer, empty, sizeof(empty));
+        Upload(clusterBuffer, empty, sizeof(empty));
+        Upload(indexBuffer, empty, sizeof(empty));
+
+        lightTexture = CreateTextureBuffer(lightBuffer, GL_RGBA32F);
+        clusterTexture = CreateTextureBuffer(clusterBuffer, GL_RG32UI);
+        indexTexture = CreateTextureBuffer(indexBuffer, GL_R32UI);
+        GPS_GL_LABEL(GL_TEXTURE, lightTexture, "cluster lights");
+        GPS_GL_LABEL(GL_TEXTURE, clusterTexture, "cluster ranges");
+        GPS_GL_LABEL(GL_TEXTURE, indexTexture, "cluster light indices");
+
+        sliceIndices.resize(CLUSTER_SLICES);
+        sliceLightLists.resize(CLUSTER_SLICES);
+        clusterTable.resize(CLUSTER_TILES_X * CLUSTER_TILES_Y * CLUSTER_SLICES * 2);
+    }
+
+    GLuint LightClusters::CreateTextureBuffer(GLuint buffer, GLenum internalFormat) {
+
+        GLuint textureId;
+        glGenTextures(1, &textureId);
+        glBindTexture(GL_TEXTURE_BUFFER, textureId);
+        glTexBuffer(GL_TEXTURE_BUFFER, internalFormat, buffer);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+
+        return textureId;
+    }
+
+    //orphan the old store so the upload does not wait for the previous frame
+    void LightClusters::Upload(GLuint buffer, const void* data, size_t size) {
+
+        glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+        glBufferData(GL_TEXTURE_BUFFER, size, NULL, GL_STREAM_DRAW);
+        glBufferData(GL_TEXTURE_BUFFER, size, data, GL_STREAM_DRAW);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        GpuMemory::Track(GPU_MEMORY_BUFFER, buffer, size);
+    }
+
+    //distance at which the attenuation drops to LIGHT_CUTOFF
+    float LightClusters::ComputeRadius(const PointLight& light) {
+
+        float c = 1.0f - 1.0f / LIGHT_CUTOFF;
+        if (light.quadratic <= 0.0f)
+            return -c / glm::max(light.linear, 0.0001f);
+
+        return (-light.linear + std::sqrt(light.linear * light.linear - 4.0f * light.quadratic * c)) / (2.0f * light.quadratic);
+    }
+
+    //view space bounding box of every froxel, slices are spaced exponentially between the planes
+    void LightClusters::ComputeClusterBounds() {
+
+        for (int z = 0; z <= CLUSTER_SLICES; z++)
+            sliceDepths[z] = nearPlane * std::pow(farPlane / nearPlane, (float)z / (float)CLUSTER_SLICES);
+
+        float tanHalfHeight = std::tan(fov * 0.5f);
+        float tanHalfWidth = tanHalfHeight * aspect;
+
+        clusterBounds.resize(CLUSTER_TILES_X * CLUSTER_TILES_Y * CLUSTER_SLICES);
+        for (int z = 0; z < CLUSTER_SLICES; z++) {
+            for (int y = 0; y < CLUSTER_TILES_Y; y++) {
+                for (int x = 0; x < CLUSTER_TILES_X; x++) {
+
+                    //tile edges on the z = -1 plane, scaled to the slice depths
+                    float left = (-1.0f + 2.0f * x / CLUSTER_TILES_X) * tanHalfWidth;
+                    float right = (-1.0f + 2.0f * (x + 1) / CLUSTER_TILES_X) * tanHalfWidth;
+                    float bottom = (-1.0f + 2.0f * y / CLUSTER_TILES_Y) * tanHalfHeight;
+                    float top = (-1.0f + 2.0f * (y + 1) / CLUSTER_TILES_Y) * tanHalfHeight;
+
+                    BoundingBox& bounds = clusterBounds[x + CLUSTER_TILES_X * (y + CLUSTER_TILES_Y * z)];
+                    bounds.min = glm::vec3(1e30f);
+                    bounds.max = glm::vec3(-1e30f);
+                    for (int d = 0; d < 2; d++) {
+
+                        float depth = sliceDepths[z + d];
+                        glm::vec3 corners[2] = { glm::vec3(left * depth, bottom * depth, -depth), glm::vec3(right * depth, top * depth, -depth) };
+                        for (int c = 0; c < 2; c++) {
+                            bounds.min = glm::min(bounds.min, corners[c]);
+                            bounds.max = glm::max(bounds.max, corners[c]);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    //bin the world space lights into the clusters of the current camera
+    void LightClusters::Build(gps::JobSystem& jobs, const std::vector<PointLight>& lights, const glm::mat4& viewMatrix,
+        float fov, float aspect, float nearPlane, float farPlane, int screenWidth, int screenHeight) {
+        GPS_PROFILE_FUNCTION();
+        GPS_ALLOC_TAG("light clusters");
+
+        if (fov != this->fov || aspect != this->aspect || nearPlane != this->nearPlane || farPlane != this->farPlane) {
+
+            this->fov = fov;
+            this->aspect = aspect;
+            this->nearPlane = nearPlane;
+            this->farPlane = farPlane;
+            ComputeClusterBounds();
+        }
+        tileSize = glm::vec2((float)screenWidth / CLUSTER_TILES_X, (float)screenHeight / CLUSTER_TILES_Y);
+
+        //the shader reads view space positions, so the lights are transformed once here
+        int lightCount = (int)lights.size();
+        viewLights.resize(lightCount);
+        lightTexels.resize(lightCount * 2);
+        for (int i = 0; i < lightCount; i++) {
+
+            glm::vec3 position = glm::vec3(viewMatrix * glm::vec4(lights[i].position, 1.0f));
+            viewLights[i] = glm::vec4(position, ComputeRadius(lights[i]));
+            lightTexels[i * 2] = glm::vec4(position, lights[i].linear);
+            lightTexels[i * 2 + 1] = glm::vec4(lights[i].color, lights[i].quadratic);
+        }
+
+        //one job per depth slice, the slices write disjoint parts of the cluster table
+        const int tilesPerSlice = CLUSTER_TILES_X * CLUSTER_TILES_Y;
+        jobs.ParallelFor(CLUSTER_SLICES, 1, [&](int begin, int end) {
+
+            for (int z = begin; z < end; z++) {
+
+                //lights whose depth range touches the slice, the list keeps its capacity between frames
+                std::vector<int>& sliceLights = sliceLightLists[z];
+                sliceLights.clear();
+                for (int i = 0; i < lightCount; i++) {
+
+                    float depth = -viewLights[i].z;
+                    float radius = viewLights[i].w;
+                    if (depth + radius >= sliceDepths[z] && depth - radius <= sliceDepths[z + 1])
+                        sliceLights.push_back(i);
+                }
+
+                std::vector<unsigned int>& list = sliceIndices[z];
+                list.clear();
+                for (int tile = 0; tile < tilesPerSlice; tile++) {
+
+                    int cluster = tile + tilesPerSlice * z;
+                    const BoundingBox& bounds = clusterBounds[cluster];
+                    unsigned int first = (unsigned int)list.size();
+                    for (size_t l = 0; l < sliceLights.size(); l++) {
+
+                        glm::vec3 center = glm::vec3(viewLights[sliceLights[l]]);
+                        float radius = viewLights[sliceLights[l]].w;
+                        glm::vec3 closest = glm::clamp(center, bounds.min, bounds.max);
+                        glm::vec3 offset = closest - center;
+                        if (glm::dot(offset, offset) <= radius * radius)
+                            list.push_back((unsigned int)sliceLights[l]);
+                    }
+                    //offsets are relative to the slice until the lists are concatenated
+                    clusterTable[cluster * 2] = first;
+                    clusterTable[cluster * 2 + 1] = (unsigned int)list.size() - first;
+                }
+            }
+        });
+
+        indices.clear();
+        maxLightsPerCluster = 0;
+        for (int z = 0; z < CLUSTER_SLICES; z++) {
+
+            unsigned int sliceOffset = (unsigned int)indices.size();
+            for (int tile = 0; tile < tilesPerSlice; tile++) {
+
+                int cluster = tile + tilesPerSlice * z;
+                clusterTable[cluster * 2] += sliceOffset;
+                maxLightsPerCluster = glm::max(maxLightsPerCluster, (int)clusterTable[cluster * 2 + 1]);
+            }
+            indices.insert(indices.end(), sliceIndices[z].begin(), sliceIndices[z].end());
+        }
+
+        if (!lightTexels.empty())
+            Upload(lightBuffer, &lightTexels[0], lightTexels.size() * sizeof(glm::vec4));
+        Upload(clusterBuffer, &clusterTable[0], clusterTable.size() * sizeof(unsigned int));
+        if (!indices.empty())
+            Upload(indexBuffer, &indices[0], indices.size() * sizeof(unsigned int));
+    }
+
+    //bind the three texture buffers starting at textureUnit and send the grid parameters
+    void LightClusters::SetUniforms(gps::Shader& shader, GLint textureUnit) {
+
+        shader.useShaderProgram();
+
+        glActiveTexture(GL_TEXTURE0 + textureUnit);
+        glBindTexture(GL_TEXTURE_BUFFER, lightTexture);
+        glUniform1i(glGetUniformLocation(shader.shaderProgram, "clusterLights"), textureUnit);
+
+        glActiveTexture(GL_TEXTURE0 + textureUnit + 1);
+        glBindTexture(GL_TEXTURE_BUFFER, clusterTexture);
+        glUniform1i(glGetUniformLocation(shader.shaderProgram, "clusterTable"), textureUnit + 1);
+
+        glActiveTexture(GL_TEXTURE0 + textureUnit + 2);
+        glBindTexture(GL_TEXTURE_BUFFER, indexTexture);
+        glUniform1i(glGetUniformLocation(shader.shaderProgram, "clusterIndices"), textureUnit + 2);
+
+        //slice = log(depth) * scale + bias
+        float logRatio = std::log(farPlane / nearPlane);
+        float scale = CLUSTER_SLICES / logRatio;
+        float bias = -CLUSTER_SLICES * std::log(nearPlane) / logRatio;
+        glUniform2f(glGetUniformLocation(shader.shaderProgram, "clusterDepthParams"), scale, bias);
+        glUniform2f(glGetUniformLocation(shader.shaderProgram, "clusterTileSize"), tileSize.x, tileSize.y);
+        glUniform3i(glGetUniformLocation(shader.shaderProgram, "clusterDims"), CLUSTER_TILES_X, CLUSTER_TILES_Y, CLUSTER_SLICES);
+    }
+
+    void LightClusters::Delete() {
+
+        glDeleteTextures(1, &lightTexture);
+        glDeleteTextures(1, &clusterTexture);
+        glDeleteTextures(1, &indexTexture);
+        GpuMemory::Release(GPU_MEMORY_BUFFER, lightBuffer);
+        GpuMemory::Release(GPU_MEMORY_BUFFER, clusterBuffer);
+        GpuMemory::Release(GPU_MEMORY_BUFFER, indexBuffer);
+        glDeleteBuffers(1, &lightBuffer);
+        glDeleteBuffers(1, &clusterBuffer);
+        glDeleteBuffers(1, &indexBuffer);
+    }
+
+    int LightClusters::GetLightCount() {
+        return (int)viewLights.size();
+    }
+
+    int LightClusters::GetIndexCount() {
+        return (int)indices.size();
+    }
+
+    int LightClusters::GetMaxLightsPerCluster() {
+        return maxLightsPerCluster;
+    }
+}
@@ -0,0 +1,88 @@
+#ifndef LightClusters_hpp
+#define LightClusters_hpp
+
+#if defined (__APPLE__)
+    #define GL_SILENCE_DEPRECATION
+    #include <OpenGL/gl3.h>
+#else
+    #define GLEW_STATIC
+    #include <GL/glew.h>
+#endif
+
+#include "GLDebug.hpp"
+#include "GLIntercept.hpp"
+
+#include <glm/glm.hpp>
+
+#include "Shader.hpp"
+#include "JobSystem.hpp"
+#include "Frustum.hpp"
+
+#include <vector>
+
+namespace gps {
+
+    //froxel grid: screen tiles times exponential depth slices
+    const int CLUSTER_TILES_X = 16;
+    const int CLUSTER_TILES_Y = 9;
+    const int CLUSTER_SLICES = 24;
+    //attenuation below this fraction is treated as zero, basic.frag uses the same value
+    const float LIGHT_CUTOFF = 0.01f;
+
+    //attenuation is 1 / (1 + linear * d + quadratic * d^2)
+    struct PointLight {
+        glm::vec3 position;
+        glm::vec3 color;
+        float linear;
+        float quadratic;
+    };
+
+    //assigns point lights to view space clusters every frame on the job system
+    //the lights, the per cluster (offset, count) table and the light index list are
+    //sent to the shader through texture buffers, GL 4.1 has no storage buffers
+    class LightClusters {
+
+    public:
+        void Init();
+        //bin the world space lights into the clusters of the current camera
+        //fov - vertical field of view in radians
+        void Build(gps::JobSystem& jobs, const std::vector<PointLight>& lights, const glm::mat4& viewMatrix,
+            float fov, float aspect, float nearPlane, float farPlane, int screenWidth, int screenHeight);
+        //bind the three texture buffers starting at textureUnit and send the grid parameters
+        void SetUniforms(gps::Shader& shader, GLint textureUnit);
+        void Delete();
+
+        int GetLightCount();
+        int GetIndexCount();
+        int GetMaxLightsPerCluster();
+
+    private:
+        GLuint lightBuffer, lightTexture;
+        GLuint clusterBuffer, clusterTexture;
+        GLuint indexBuffer, indexTexture;
+
+        //view space bounds of every cluster, rebuilt when the projection changes
+        std::vector<BoundingBox> clusterBounds;
+        float sliceDepths[CLUSTER_SLICES + 1];
+        float fov = 0.0f, aspect = 0.0f, nearPlane = 0.0f, farPlane = 0.0f;
+        glm::vec2 tileSize;
+
+        //view space position and radius of every light of the frame
+        std::vector<glm::vec4> viewLights;
+        //per slice light lists, filled in parallel and concatenated afterwards
+        std::vector<std::vector<unsigned int> > sliceIndices;
+        //lights touching each slice, one list per slice so the jobs share nothing
+        std::vector<std::vector<int> > sliceLightLists;
+        std::vector<unsigned int> clusterTable;
+        std::vector<unsigned int> indices;
+        std::vector<glm::vec4> lightTexels;
+        int maxLightsPerCluster = 0;
+
+        void ComputeClusterBounds();
+        static float ComputeRadius(const PointLight& light);
+        static GLuint CreateTextureBuffer(GLuint buffer, GLenum internalFormat);
+        static void Upload(GLuint buffer, const void* data, size_t size);
+    };
+}
+
+#endif /* LightClusters_hpp */
@@ -1,4 +1,9 @@
 #include "Mesh.hpp"
+#include "GpuMemory.hpp"
+#include "MeshProcessing.hpp"
+#include "Profiler.hpp"
+
+
 namespace gps {
 
 	/* Mesh Constructor */
@@ -9,36 +14,67 @@ namespace gps {
 		this->textures = textures;
 
 		this->setupMesh();
+		this->computeBounds();
+		this->materialId = registerMaterial(this->textures);
 	}
 
 	Buffers Mesh::getBuffers() {
 	    return this->buffers;
 	}
 
+	BoundingBox Mesh::getBounds() {
+	    return this->bounds;
+	}
+
+	GLuint Mesh::getMaterialId() {
+	    return this->materialId;
+	}
+
 	/* Mesh drawing function - also applies associated textures */
-	void Mesh::Draw(gps::Shader shader)	{
+	void Mesh::Draw(gps::Shader& shader)	{
+		GPS_PROFILE_FUNCTION();
 
 		shader.useShaderProgram();
 
-		//set textures
+		BindTextures(shader);
+		DrawGeometry();
+
+        for(GLuint i = 0; i < this->textures.size(); i++) {
+
+            glActiveTexture(GL_TEXTURE0 + i);
+            glBindTexture(GL_TEXTURE_2D, 0);
+        }
+
+    }
+
+	// Binds the textures to the shader samplers without drawing
+	void Mesh::BindTextures(gps::Shader& shader) {
+
 		for (GLuint i = 0; i < textures.size(); i++) {
 
 			glActiveTexture(GL_TEXTURE0 + i);
 			glUniform1i(glGetUniformLocation(shader.shaderProgram, this->textures[i].type.c_str()), i);
 			glBindTexture(GL_TEXTURE_2D, this->textures[i].id);
 		}
+	}
+
+	// Draws the triangles with whatever textures are currently bound
+	void Mesh::DrawGeometry() {
+		GPS_PROFILE_FUNCTION();
 
 		glBindVertexArray(this->buffers.VAO);
 		glDrawElements(GL_TRIANGLES, (GLsizei)this->indices.size(), GL_UNSIGNED_INT, 0);
 		glBindVertexArray(0);
+	}
 
-        for(GLuint i = 0; i < this->textures.size(); i++) {
-
-            glActiveTexture(GL_TEXTURE0 + i);
-            glBindTexture(GL_TEXTURE_2D, 0);
-        }
+	// Draws the triangles reading only the vertex positions, for depth only passes
+	void Mesh::DrawPositions() {
+		GPS_PROFILE_FUNCTION();
 
-    }
+		glBindVertexArray(this->buffers.positionVAO);
+		glDrawElements(GL_TRIANGLES, (GLsizei)this->indices.size(), GL_UNSIGNED_INT, 0);
+		glBindVertexArray(0);
+	}
 
 	// Initializes all the buffer objects/arrays
 	void Mesh::setupMesh() {
@@ -55,6 +91,8 @@ namespace gps {
 
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->buffers.EBO);
 		glBufferData(GL_ELEMENT_ARRAY_BUFFER, this->indices.size() * sizeof(GLuint), &this->indices[0], GL_STATIC_DRAW);
+		GpuMemory::Track(GPU_MEMORY_BUFFER, this->buffers.VBO, this->vertices.size() * sizeof(Vertex));
+		GpuMemory::Track(GPU_MEMORY_BUFFER, this->buffers.EBO, this->indices.size() * sizeof(GLuint));
 
 		// Set the vertex attribute pointers
 		// Vertex Positions
@@ -68,5 +106,59 @@ namespace gps {
 		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid*)offsetof(Vertex, TexCoords));
 
 		glBindVertexArray(0);
+
+		setupPositionStream();
+	}
+
+	// Builds the packed position buffer, vertices differing only in normal or UV share a position
+	void Mesh::setupPositionStream() {
+
+		std::vector<glm::vec3> positions;
+		std::vector<GLuint> positionIndices;
+		MeshProcessing::BuildPositionStream(this->vertices, this->indices, positions, positionIndices);
+
+		glGenVertexArrays(1, &this->buffers.positionVAO);
+		glGenBuffers(1, &this->buffers.positionVBO);
+		glGenBuffers(1, &this->buffers.positionEBO);
+
+		glBindVertexArray(this->buffers.positionVAO);
+		glBindBuffer(GL_ARRAY_BUFFER, this->buffers.positionVBO);
+		glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(glm::vec3), &positions[0], GL_STATIC_DRAW);
+
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->buffers.positionEBO);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, positionIndices.size() * sizeof(GLuint), &positionIndices[0], GL_STATIC_DRAW);
+		GpuMemory::Track(GPU_MEMORY_BUFFER, this->buffers.positionVBO, positions.size() * sizeof(glm::vec3));
+		GpuMemory::Track(GPU_MEMORY_BUFFER, this->buffers.positionEBO, positionIndices.size() * sizeof(GLuint));
+
+		// Vertex Positions, 12 bytes per vertex instead of 32
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (GLvoid*)0);
+
+		glBindVertexArray(0);
+	}
+
+	// Computes the model space bounding box of the vertices
+	void Mesh::computeBounds() {
+
+		this->bounds = MeshProcessing::ComputeBounds(this->vertices);
+	}
+
+	// Returns the id of the texture set, registering it on first use
+	GLuint Mesh::registerMaterial(const std::vector<Texture>& textures) {
+
+		static std::vector<std::vector<GLuint> > materials;
+
+		std::vector<GLuint> textureIds;
+		for (size_t i = 0; i < textures.size(); i++)
+			textureIds.push_back(textures[i].id);
+
+		for (size_t m = 0; m < materials.size(); m++) {
+
+			if (materials[m] == textureIds)
+				return (GLuint)m;
+		}
+
+		materials.push_back(textureIds);
+		return (GLuint)materials.size() - 1;
 	}
 }
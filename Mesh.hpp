@@ -9,9 +9,13 @@
     #include <GL/glew.h>
 #endif
 
+#include "GLDebug.hpp"
+#include "GLIntercept.hpp"
+
 #include <glm/glm.hpp>
 
 #include "Shader.hpp"
+#include "Frustum.hpp"
 
 #include <string>
 #include <vector>
@@ -45,6 +49,10 @@ namespace gps {
         GLuint VAO;
         GLuint VBO;
         GLuint EBO;
+        //tightly packed unique positions with their own index buffer, for depth only passes
+        GLuint positionVAO;
+        GLuint positionVBO;
+        GLuint positionEBO;
     };
 
     class Mesh {
@@ -58,15 +66,40 @@ namespace gps {
 
 	    Buffers getBuffers();
 
-	    void Draw(gps::Shader shader);
+	    BoundingBox getBounds();
+
+	    // Meshes with the same set of textures share a material id
+	    GLuint getMaterialId();
+
+	    void Draw(gps::Shader& shader);
+
+	    // Binds the textures to the shader samplers without drawing
+	    void BindTextures(gps::Shader& shader);
+
+	    // Draws the triangles with whatever textures are currently bound
+	    void DrawGeometry();
+
+	    // Draws the triangles reading only the vertex positions, for depth only passes
+	    void DrawPositions();
 
     private:
         /*  Render data  */
         Buffers buffers;
+        BoundingBox bounds;
+        GLuint materialId;
 
 	    // Initializes all the buffer objects/arrays
 	    void setupMesh();
 
+	    // Builds the packed position buffer, vertices differing only in normal or UV share a position
+	    void setupPositionStream();
+
+	    // Computes the model space bounding box of the vertices
+	    void computeBounds();
+
+	    // Returns the id of the texture set, registering it on first use
+	    static GLuint registerMaterial(const std::vector<Texture>& textures);
+
     };
 
 }
@@ -0,0 +1,124 @@
+#include "MeshProcessing.hpp"
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+namespace gps {
+
+    //one vertex per face corner, in face order, the layout ReadOBJ gives the meshes
+    void MeshProcessing::AssembleShape(const tinyobj::attrib_t& attrib, const tinyobj::shape_t& shape,
+        std::vector<Vertex>& vertices, std::vector<GLuint>& indices) {
+        GPS_PROFILE_FUNCTION();
+
+        vertices.clear();
+        indices.clear();
+        vertices.reserve(shape.mesh.indices.size());
+        indices.reserve(shape.mesh.indices.size());
+
+        // Loop over faces(polygon)
+        size_t index_offset = 0;
+        for (size_t f = 0; f < shape.mesh.num_face_vertices.size(); f++) {
+
+            int fv = shape.mesh.num_face_vertices[f];
+
+            // Loop over vertices in the face.
+            for (int v = 0; v < fv; v++) {
+
+                // access to vertex
+                tinyobj::index_t idx = shape.mesh.indices[index_offset + v];
+
+                Vertex currentVertex;
+                currentVertex.Position = glm::vec3(attrib.vertices[3 * idx.vertex_index + 0],
+                    attrib.vertices[3 * idx.vertex_index + 1], attrib.vertices[3 * idx.vertex_index + 2]);
+                currentVertex.Normal = glm::vec3(attrib.normals[3 * idx.normal_index + 0],
+                    attrib.normals[3 * idx.normal_index + 1], attrib.normals[3 * idx.normal_index + 2]);
+                currentVertex.TexCoords = glm::vec2(0.0f);
+
+                if (idx.texcoord_index != -1) {
+
+                    currentVertex.TexCoords = glm::vec2(attrib.texcoords[2 * idx.texcoord_index + 0],
+                        attrib.texcoords[2 * idx.texcoord_index + 1]);
+                }
+
+                vertices.push_back(currentVertex);
+                indices.push_back((GLuint)(index_offset + v));
+            }
+
+            index_offset += fv;
+        }
+    }
+
+    //unique positions and the indices into them, vertices differing only in normal or UV share a position
+    void MeshProcessing::BuildPositionStream(const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices,
+        std::vector<glm::vec3>& positions, std::vector<GLuint>& positionIndices) {
+        GPS_PROFILE_FUNCTION();
+
+        // positions are matched on their bit patterns
+        struct PositionKey {
+            GLuint x, y, z;
+            bool operator==(const PositionKey& other) const {
+                return x == other.x && y == other.y && z == other.z;
+            }
+        };
+        struct PositionHash {
+            size_t operator()(const PositionKey& key) const {
+                return (size_t)key.x * 73856093u ^ (size_t)key.y * 19349663u ^ (size_t)key.z * 83492791u;
+            }
+        };
+
+        positions.clear();
+        std::vector<GLuint> vertexToPosition(vertices.size());
+        std::unordered_map<PositionKey, GLuint, PositionHash> uniquePositions;
+        //most corners of a closed mesh share their position with a few others
+        uniquePositions.reserve(vertices.size() / 2);
+        for (size_t i = 0; i < vertices.size(); i++) {
+
+            PositionKey key;
+            std::memcpy(&key, &vertices[i].Position, sizeof(key));
+            std::pair<std::unordered_map<PositionKey, GLuint, PositionHash>::iterator, bool> found =
+                uniquePositions.insert(std::make_pair(key, (GLuint)positions.size()));
+            if (found.second) {
+                positions.push_back(vertices[i].Position);
+            }
+            vertexToPosition[i] = found.first->second;
+        }
+
+        positionIndices.resize(indices.size());
+        for (size_t i = 0; i < indices.size(); i++)
+            positionIndices[i] = vertexToPosition[indices[i]];
+    }
+
+    BoundingBox MeshProcessing::ComputeBounds(const std::vector<Vertex>& vertices) {
+
+        BoundingBox bounds;
+        if (vertices.empty()) {
+            bounds.min = glm::vec3(0.0f);
+            bounds.max = glm::vec3(0.0f);
+            return bounds;
+        }
+
+        bounds.min = vertices[0].Position;
+        bounds.max = vertices[0].Position;
+        for (size_t i = 1; i < vertices.size(); i++) {
+
+            bounds.min = glm::min(bounds.min, vertices[i].Position);
+            bounds.max = glm::max(bounds.max, vertices[i].Position);
+        }
+        return bounds;
+    }
+
+    //in place, images are decoded top row first and GL expects the bottom row first
+    void MeshProcessing::FlipRows(unsigned char* pixels, int width, int height, int channels) {
+        GPS_PROFILE_FUNCTION();
+
+        size_t rowBytes = (size_t)width * channels;
+        for (int row = 0; row < height / 2; row++) {
+
+            unsigned char* top = pixels + row * rowBytes;
+            unsigned char* bottom = pixels + (height - row - 1) * rowBytes;
+            std::swap_ranges(top, top + rowBytes, bottom);
+        }
+    }
+}
@@ -0,0 +1,30 @@
+#ifndef MeshProcessing_hpp
+#define MeshProcessing_hpp
+
+#include "Mesh.hpp"
+
+#include "tiny_obj_loader.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+namespace gps {
+
+    //the CPU side of loading a model, without any GL calls so the tools can run it without a context
+    class MeshProcessing {
+
+    public:
+        //one vertex per face corner, in face order, the layout ReadOBJ gives the meshes
+        static void AssembleShape(const tinyobj::attrib_t& attrib, const tinyobj::shape_t& shape,
+            std::vector<Vertex>& vertices, std::vector<GLuint>& indices);
+        //unique positions and the indices into them, vertices differing only in normal or UV share a position
+        static void BuildPositionStream(const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices,
+            std::vector<glm::vec3>& positions, std::vector<GLuint>& positionIndices);
+        static BoundingBox ComputeBounds(const std::vector<Vertex>& vertices);
+        //in place, images are decoded top row first and GL expects the bottom row first
+        static void FlipRows(unsigned char* pixels, int width, int height, int channels);
+    };
+}
+
+#endif /* MeshProcessing_hpp */
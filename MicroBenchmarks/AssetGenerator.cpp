@@ -0,0 +1,380 @@
+#include "AssetGenerator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+namespace gps {
+
+    //the grid spans GRID_EXTENT units around the origin and rolls GRID_WAVES times across
+    const float GRID_EXTENT = 10.0f;
+    const float GRID_WAVES = 8.0f;
+    const float GRID_HEIGHT = 0.25f;
+    //deflate looks back at most 32 KB, the hash of the next 3 bytes finds the candidates
+    const int DEFLATE_WINDOW = 32768;
+    const int DEFLATE_HASH_BITS = 15;
+    const int DEFLATE_MAX_CHAIN = 16;
+    const int DEFLATE_MIN_MATCH = 3;
+    const int DEFLATE_MAX_MATCH = 258;
+
+    //lines are formatted into a buffer and written in large pieces, formatting dominates otherwise
+    class LineWriter {
+
+    public:
+        explicit LineWriter(std::ostream& out) : out(out), used(0) {
+        }
+
+        ~LineWriter() {
+            Flush();
+        }
+
+        template <typename... Args>
+        void Line(const char* format, Args... args) {
+            if (used + LINE_MAX_BYTES > sizeof(buffer))
+                Flush();
+            used += snprintf(buffer + used, LINE_MAX_BYTES, format, args...);
+        }
+
+        void Flush() {
+            out.write(buffer, used);
+            used = 0;
+        }
+
+    private:
+        static const size_t LINE_MAX_BYTES = 128;
+        std::ostream& out;
+        char buffer[1 << 16];
+        size_t used;
+    };
+
+    //deflate packs its fields from the lowest bit of each byte up
+    class BitWriter {
+
+    public:
+        explicit BitWriter(std::vector<unsigned char>& out) : out(out), bits(0), count(0) {
+        }
+
+        void Put(unsigned int value, int length) {
+            bits |= value << count;
+            count += length;
+            while (count >= 8) {
+                out.push_back((unsigned char)(bits & 0xFF));
+                bits >>= 8;
+                count -= 8;
+            }
+        }
+
+        //Huffman codes go in most significant bit first
+        void PutCode(unsigned int code, int length) {
+            unsigned int reversed = 0;
+            for (int i = 0; i < length; i++) {
+                reversed = (reversed << 1) | (code & 1);
+                code >>= 1;
+            }
+            Put(reversed, length);
+        }
+
+        void Flush() {
+            if (count > 0)
+                out.push_back((unsigned char)(bits & 0xFF));
+            bits = 0;
+            count = 0;
+        }
+
+    private:
+        std::vector<unsigned char>& out;
+        unsigned int bits;
+        int count;
+    };
+
+    //the fixed Huffman codes of deflate for literals, lengths and the end of block
+    static void PutLiteralLength(BitWriter& writer, int symbol) {
+        if (symbol < 144)
+            writer.PutCode(0x30 + symbol, 8);
+        else if (symbol < 256)
+            writer.PutCode(0x190 + symbol - 144, 9);
+        else if (symbol < 280)
+            writer.PutCode(symbol - 256, 7);
+        else
+            writer.PutCode(0xC0 + symbol - 280, 8);
+    }
+
+    static void PutMatch(BitWriter& writer, int length, int distance) {
+
+        static const int lengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+            35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+        static const int lengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+            3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+        static const int distanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+            257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+        static const int distanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+            7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+        int code = 28;
+        while (lengthBase[code] > length)
+            code--;
+        PutLiteralLength(writer, 257 + code);
+        writer.Put(length - lengthBase[code], lengthExtra[code]);
+
+        code = 29;
+        while (distanceBase[code] > distance)
+            code--;
+        writer.PutCode(code, 5);
+        writer.Put(distance - distanceBase[code], distanceExtra[code]);
+    }
+
+    //one block of greedy LZ77 matches in the fixed Huffman codes, the scheme of stb_image_write,
+    //so inflate decodes symbols and copies matches as it does for the PNGs of real assets
+    static void Deflate(const std::vector<unsigned char>& data, std::vector<unsigned char>& out) {
+
+        BitWriter writer(out);
+        //last block, fixed Huffman codes
+        writer.Put(1, 1);
+        writer.Put(1, 2);
+
+        std::vector<int> head((size_t)1 << DEFLATE_HASH_BITS, -1);
+        std::vector<int> previous(DEFLATE_WINDOW, -1);
+        int size = (int)data.size();
+        int position = 0;
+        while (position < size) {
+
+            int bestLength = 0;
+            int bestDistance = 0;
+            if (position + DEFLATE_MIN_MATCH <= size) {
+
+                unsigned int key = (unsigned int)data[position] << 16 | (unsigned int)data[position + 1] << 8 | data[position + 2];
+                unsigned int hash = (key * 2654435761u) >> (32 - DEFLATE_HASH_BITS);
+                int maxLength = std::min(DEFLATE_MAX_MATCH, size - position);
+                int candidate = head[hash];
+                for (int chain = 0; chain < DEFLATE_MAX_CHAIN && candidate >= 0 && position - candidate <= DEFLATE_WINDOW; chain++) {
+
+                    int length = 0;
+                    while (length < maxLength && data[candidate + length] == data[position + length])
+                        length++;
+                    if (length > bestLength) {
+                        bestLength = length;
+                        bestDistance = position - candidate;
+                        if (length == maxLength)
+                            break;
+                    }
+                    candidate = previous[candidate % DEFLATE_WINDOW];
+                }
+                previous[position % DEFLATE_WINDOW] = head[hash];
+                head[hash] = position;
+            }
+
+            if (bestLength >= DEFLATE_MIN_MATCH) {
+                PutMatch(writer, bestLength, bestDistance);
+                //the skipped positions still go into the hash chains
+                for (int i = position + 1; i < position + bestLength && i + DEFLATE_MIN_MATCH <= size; i++) {
+                    unsigned int key = (unsigned int)data[i] << 16 | (unsigned int)data[i + 1] << 8 | data[i + 2];
+                    unsigned int hash = (key * 2654435761u) >> (32 - DEFLATE_HASH_BITS);
+                    previous[i % DEFLATE_WINDOW] = head[hash];
+                    head[hash] = i;
+                }
+                position += bestLength;
+            }
+            else {
+                PutLiteralLength(writer, data[position]);
+                position++;
+            }
+        }
+
+        PutLiteralLength(writer, 256);
+        writer.Flush();
+    }
+
+    static unsigned int Adler32(const std::vector<unsigned char>& data) {
+
+        unsigned int a = 1, b = 0;
+        for (size_t i = 0; i < data.size(); i++) {
+            a = (a + data[i]) % 65521u;
+            b = (b + a) % 65521u;
+        }
+        return (b << 16) | a;
+    }
+
+    static unsigned int Crc32(const unsigned char* data, size_t size, unsigned int crc = 0) {
+
+        static unsigned int table[256];
+        static bool tableReady = false;
+        if (!tableReady) {
+            for (unsigned int n = 0; n < 256; n++) {
+                unsigned int c = n;
+                for (int k = 0; k < 8; k++)
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                table[n] = c;
+            }
+            tableReady = true;
+        }
+
+        crc = ~crc;
+        for (size_t i = 0; i < size; i++)
+            crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        return ~crc;
+    }
+
+    static void PutBigEndian(std::vector<unsigned char>& out, unsigned int value) {
+        out.push_back((unsigned char)(value >> 24));
+        out.push_back((unsigned char)(value >> 16));
+        out.push_back((unsigned char)(value >> 8));
+        out.push_back((unsigned char)value);
+    }
+
+    static void PutChunk(std::vector<unsigned char>& png, const char* type, const std::vector<unsigned char>& data) {
+
+        PutBigEndian(png, (unsigned int)data.size());
+        size_t typeStart = png.size();
+        png.insert(png.end(), type, type + 4);
+        png.insert(png.end(), data.begin(), data.end());
+        PutBigEndian(png, Crc32(&png[typeStart], png.size() - typeStart));
+    }
+
+    //quads per side of the grid WriteOBJ makes for about this many triangles
+    int AssetGenerator::GridSize(long long triangles) {
+        int size = (int)std::ceil(std::sqrt((double)triangles / 2.0));
+        return size > 0 ? size : 1;
+    }
+
+    void AssetGenerator::WriteOBJ(std::ostream& out, long long triangles, int shapes, const std::string& materialLibrary) {
+
+        int size = GridSize(triangles);
+        int stride = size + 1;
+        if (shapes < 1)
+            shapes = 1;
+
+        LineWriter writer(out);
+        writer.Line("# synthetic grid, %lld triangles\n", 2LL * size * size);
+        writer.Line("mtllib %s\n", materialLibrary.c_str());
+
+        //height = GRID_HEIGHT * sin(f x) * cos(f z), the normals follow from its slopes
+        float frequency = 2.0f * 3.14159265f * GRID_WAVES / GRID_EXTENT;
+        for (int row = 0; row <= size; row++) {
+            for (int column = 0; column <= size; column++) {
+
+                float x = ((float)column / size - 0.5f) * GRID_EXTENT;
+                float z = ((float)row / size - 0.5f) * GRID_EXTENT;
+                float y = GRID_HEIGHT * std::sin(frequency * x) * std::cos(frequency * z);
+                writer.Line("v %.5f %.5f %.5f\n", x, y, z);
+            }
+        }
+        for (int row = 0; row <= size; row++) {
+            for (int column = 0; column <= size; column++) {
+
+                float x = ((float)column / size - 0.5f) * GRID_EXTENT;
+                float z = ((float)row / size - 0.5f) * GRID_EXTENT;
+                float slopeX = GRID_HEIGHT * frequency * std::cos(frequency * x) * std::cos(frequency * z);
+                float slopeZ = -GRID_HEIGHT * frequency * std::sin(frequency * x) * std::sin(frequency * z);
+                float length = std::sqrt(slopeX * slopeX + 1.0f + slopeZ * slopeZ);
+                writer.Line("vn %.4f %.4f %.4f\n", -slopeX / length, 1.0f / length, -slopeZ / length);
+            }
+        }
+        for (int row = 0; row <= size; row++) {
+            for (int column = 0; column <= size; column++)
+                writer.Line("vt %.5f %.5f\n", (float)column / size, 1.0f - (float)row / size);
+        }
+
+        //consecutive bands of rows, counter clockwise seen from above, OBJ indices start at 1
+        int rowsPerShape = (size + shapes - 1) / shapes;
+        for (int shape = 0; shape * rowsPerShape < size; shape++) {
+
+            writer.Line("o grid_%d\nusemtl grid\n", shape);
+            int lastRow = std::min(size, (shape + 1) * rowsPerShape);
+            for (int row = shape * rowsPerShape; row < lastRow; row++) {
+                for (int column = 0; column < size; column++) {
+
+                    long long a = (long long)row * stride + column + 1;
+                    long long b = a + 1;
+                    long long c = a + stride;
+                    long long d = c + 1;
+                    writer.Line("f %lld/%lld/%lld %lld/%lld/%lld %lld/%lld/%lld\n", a, a, a, c, c, c, b, b, b);
+                    writer.Line("f %lld/%lld/%lld %lld/%lld/%lld %lld/%lld/%lld\n", b, b, b, c, c, c, d, d, d);
+                }
+            }
+        }
+    }
+
+    void AssetGenerator::WriteMTL(std::ostream& out, const std::string& textureName) {
+
+        out << "newmtl grid\n"
+            << "Ka 0.2 0.2 0.2\n"
+            << "Kd 0.8 0.8 0.8\n"
+            << "Ks 0.1 0.1 0.1\n"
+            << "map_Kd " << textureName << "\n";
+    }
+
+    std::vector<unsigned char> AssetGenerator::EncodePNG(int width, int height) {
+
+        //each row is the Sub filter byte and the differences to the pixel on the left
+        size_t rowBytes = (size_t)width * 4 + 1;
+        std::vector<unsigned char> rows(rowBytes * height);
+        unsigned int noise = 12345u;
+        for (int y = 0; y < height; y++) {
+
+            unsigned char* row = &rows[y * rowBytes];
+            row[0] = 1;
+            unsigned char left[4] = { 0, 0, 0, 0 };
+            for (int x = 0; x < width; x++) {
+
+                noise = noise * 1664525u + 1013904223u;
+                unsigned char pixel[4] = {
+                    (unsigned char)(x * 255 / width + ((noise >> 24) & 15)),
+                    (unsigned char)(y * 255 / height + ((noise >> 16) & 15)),
+                    (unsigned char)(((x ^ y) & 64) + ((noise >> 8) & 31)),
+                    255
+                };
+                for (int c = 0; c < 4; c++) {
+                    row[1 + x * 4 + c] = (unsigned char)(pixel[c] - left[c]);
+                    left[c] = pixel[c];
+                }
+            }
+        }
+
+        //zlib header (32 KB window, default compression), deflate, adler32 of the uncompressed data
+        std::vector<unsigned char> zlib;
+        zlib.reserve(rows.size() / 2);
+        zlib.push_back(0x78);
+        zlib.push_back(0x9C);
+        Deflate(rows, zlib);
+        PutBigEndian(zlib, Adler32(rows));
+
+        std::vector<unsigned char> header;
+        PutBigEndian(header, (unsigned int)width);
+        PutBigEndian(header, (unsigned int)height);
+        //8 bits per channel, RGBA, deflate, adaptive filtering, no interlace
+        const unsigned char format[5] = { 8, 6, 0, 0, 0 };
+        header.insert(header.end(), format, format + 5);
+
+        const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+        std::vector<unsigned char> png(signature, signature + 8);
+        PutChunk(png, "IHDR", header);
+        PutChunk(png, "IDAT", zlib);
+        PutChunk(png, "IEND", std::vector<unsigned char>());
+        return png;
+    }
+
+    //grid.obj, grid.mtl and grid.png in directory, loadable by Model3D
+    bool AssetGenerator::WriteAssets(const std::string& directory, long long triangles, int shapes, int textureSize) {
+
+        std::string base = directory.empty() || directory.back() == '/' ? directory : directory + "/";
+        std::ofstream obj(base + "grid.obj", std::ios::binary);
+        std::ofstream mtl(base + "grid.mtl", std::ios::binary);
+        std::ofstream png(base + "grid.png", std::ios::binary);
+        if (!obj.is_open() || !mtl.is_open() || !png.is_open()) {
+            std::cout << "Could not write the assets to " << directory << std::endl;
+            return false;
+        }
+
+        WriteOBJ(obj, triangles, shapes, "grid.mtl");
+        WriteMTL(mtl, "grid.png");
+        std::vector<unsigned char> image = EncodePNG(textureSize, textureSize);
+        png.write((const char*)&image[0], image.size());
+
+        int size = GridSize(triangles);
+        std::cout << "Wrote " << base << "grid.obj (" << 2LL * size * size << " triangles, " << shapes << " shapes) and a "
+            << textureSize << "x" << textureSize << " texture" << std::endl;
+        return true;
+    }
+}
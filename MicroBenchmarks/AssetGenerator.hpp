@@ -0,0 +1,28 @@
+#ifndef AssetGenerator_hpp
+#define AssetGenerator_hpp
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace gps {
+
+    //synthetic models and textures of any size for the loading benchmarks
+    class AssetGenerator {
+
+    public:
+        //quads per side of the grid WriteOBJ makes for about this many triangles
+        static int GridSize(long long triangles);
+        //a rolling grid of GridSize(triangles)^2 quads as triangles with positions, normals and UVs,
+        //cut into `shapes` objects that share the vertices, the way exported scenes usually look
+        static void WriteOBJ(std::ostream& out, long long triangles, int shapes, const std::string& materialLibrary);
+        static void WriteMTL(std::ostream& out, const std::string& textureName);
+        //RGBA8 noise over a gradient, filtered per row like an encoder would and compressed with LZ77 and
+        //the fixed Huffman codes, so decoding it runs the Huffman decode, match copies and row filters of a real PNG
+        static std::vector<unsigned char> EncodePNG(int width, int height);
+        //grid.obj, grid.mtl and grid.png in directory, loadable by Model3D
+        static bool WriteAssets(const std::string& directory, long long triangles, int shapes, int textureSize);
+    };
+}
+
+#endif /* AssetGenerator_hpp */
@@ -0,0 +1,412 @@
+//MicroBenchmarks: throughput of the CPU side of model loading and of the transform updates, on synthetic assets
+//usage: MicroBenchmarks [--triangles N,N] [--textures N,N] [--entities N,N] [--threads N] [--repeat N]
+//                       [--memory-gb N] [--only NAME] [--json OUT]
+//       MicroBenchmarks --generate DIR [--triangles N] [--shapes N] [--textures N] (assets for the app)
+//build: MicroBenchmarks.vcxproj (Release), or the Makefile here on Linux, no GL libraries needed
+//sources: MicroBenchmarks.cpp, AssetGenerator.cpp, MeshProcessing.cpp, TransformStore.cpp, JobSystem.cpp,
+//AllocationTracker.cpp, tiny_obj_loader.cpp and stb_image.cpp
+
+#include "AssetGenerator.hpp"
+#include "../MeshProcessing.hpp"
+#include "../TransformStore.hpp"
+#include "../JobSystem.hpp"
+
+#include "../tiny_obj_loader.h"
+#include "../stb_image.h"
+
+#include <glm/gtc/quaternion.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+//sizes of each run, thousands up to tens of millions of triangles
+std::vector<long long> triangleCounts = { 2000, 32000, 512000, 2000000, 10000000 };
+std::vector<long long> textureSizes = { 256, 1024, 4096 };
+std::vector<long long> entityCounts = { 1000, 10000, 100000, 1000000 };
+int shapeCount = 16;
+int maxThreads = 0;
+int repeat = 3;
+//the copies of one run stay below this, 10M triangles need about 2 GB per parsing thread
+double memoryBudget = 8.0 * 1073741824.0;
+std::string onlyBenchmark;
+std::string jsonOutput;
+
+struct BenchmarkResult {
+    std::string name;
+    long long size;
+    int threads;
+    double milliseconds;
+    double megabytesPerSecond;
+    double itemsPerSecond;
+    std::string itemUnit;
+    double speedup;
+};
+
+std::vector<BenchmarkResult> results;
+//results of the work, stored so the compiler cannot drop it
+std::vector<long long> sinks;
+
+std::vector<long long> parseList(const char* list) {
+    std::vector<long long> values;
+    std::stringstream stream(list);
+    std::string value;
+    while (std::getline(stream, value, ',')) {
+        values.push_back(atoll(value.c_str()));
+    }
+    return values;
+}
+
+//1, 2, 4 ... and the hardware thread count
+std::vector<int> threadCounts() {
+    std::vector<int> counts;
+    for (int threads = 1; threads < maxThreads; threads *= 2) {
+        counts.push_back(threads);
+    }
+    counts.push_back(maxThreads);
+    return counts;
+}
+
+bool selected(const char* name) {
+    return onlyBenchmark.empty() || strstr(name, onlyBenchmark.c_str()) != nullptr;
+}
+
+//every thread works on its own copy of the input, the work grows with the threads, so perfect scaling keeps the time flat
+//prepare(copies) runs untimed before each repetition, work(copy) is the timed part, bytes and items are per copy
+//copyBytes is the memory one copy holds, thread counts whose copies go over the budget are skipped
+template <typename Prepare, typename Work>
+void runBenchmark(const char* name, long long size, double bytes, double items, const char* itemUnit, double copyBytes,
+    const Prepare& prepare, const Work& work) {
+
+    double singleThreadRate = 0.0;
+    std::vector<int> counts = threadCounts();
+    for (size_t t = 0; t < counts.size(); t++) {
+
+        int threads = counts[t];
+        if (threads > 1 && threads * copyBytes > memoryBudget) {
+            printf("%-18s %10lld %3d threads skipped, %.1f GB per copy is over --memory-gb\n", name, size, threads,
+                copyBytes / 1073741824.0);
+            continue;
+        }
+        //a pool per thread count, the calling thread is one of the threads
+        gps::JobSystem jobSystem;
+        if (threads > 1) {
+            jobSystem.Init(threads - 1);
+        }
+
+        typedef std::chrono::steady_clock Clock;
+        double best = 0.0;
+        for (int r = 0; r < repeat; r++) {
+
+            prepare(threads);
+            Clock::time_point start = Clock::now();
+            if (threads == 1) {
+                work(0);
+            }
+            else {
+                jobSystem.ParallelFor(threads, 1, [&](int begin, int end) {
+                    for (int copy = begin; copy < end; copy++) {
+                        work(copy);
+                    }
+                });
+            }
+            double milliseconds = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            best = r == 0 ? milliseconds : std::min(best, milliseconds);
+        }
+
+        BenchmarkResult result;
+        result.name = name;
+        result.size = size;
+        result.threads = threads;
+        result.milliseconds = best;
+        double seconds = std::max(best, 1e-6) / 1000.0;
+        result.megabytesPerSecond = bytes * threads / seconds / 1048576.0;
+        result.itemsPerSecond = items * threads / seconds;
+        result.itemUnit = itemUnit;
+        if (threads == 1) {
+            singleThreadRate = result.itemsPerSecond;
+        }
+        result.speedup = singleThreadRate > 0.0 ? result.itemsPerSecond / singleThreadRate : 0.0;
+        results.push_back(result);
+
+        printf("%-18s %10lld %3d threads %10.2f ms %10.1f MB/s %10.2f M%s/s %6.2fx\n", name, size, threads,
+            result.milliseconds, result.megabytesPerSecond, result.itemsPerSecond / 1e6, itemUnit, result.speedup);
+        fflush(stdout);
+    }
+}
+
+//tinyobj parsing, then what ReadOBJ does with the parsed data
+void benchmarkMeshes(long long requestedTriangles) {
+
+    std::ostringstream objStream;
+    gps::AssetGenerator::WriteOBJ(objStream, requestedTriangles, shapeCount, "grid.mtl");
+    std::string objText = objStream.str();
+    std::ostringstream mtlStream;
+    gps::AssetGenerator::WriteMTL(mtlStream, "grid.png");
+    std::string mtlText = mtlStream.str();
+    int gridSize = gps::AssetGenerator::GridSize(requestedTriangles);
+    long long triangles = 2LL * gridSize * gridSize;
+
+    if (selected("obj parse")) {
+
+        std::vector<std::unique_ptr<std::istringstream> > objInputs;
+        std::vector<std::unique_ptr<std::istringstream> > mtlInputs;
+        std::vector<std::unique_ptr<tinyobj::MaterialStreamReader> > materialReaders;
+        std::vector<tinyobj::attrib_t> attribs;
+        std::vector<std::vector<tinyobj::shape_t> > shapes;
+        std::vector<std::vector<tinyobj::material_t> > materials;
+        //the text and about as much again for the parsed attributes and indices
+        runBenchmark("obj parse", triangles, (double)objText.size(), (double)triangles, "tri", 2.0 * objText.size(),
+            [&](int copies) {
+                objInputs.clear();
+                mtlInputs.clear();
+                materialReaders.clear();
+                attribs.assign(copies, tinyobj::attrib_t());
+                shapes.assign(copies, std::vector<tinyobj::shape_t>());
+                materials.assign(copies, std::vector<tinyobj::material_t>());
+                for (int i = 0; i < copies; i++) {
+                    objInputs.emplace_back(new std::istringstream(objText));
+                    mtlInputs.emplace_back(new std::istringstream(mtlText));
+                    materialReaders.emplace_back(new tinyobj::MaterialStreamReader(*mtlInputs.back()));
+                }
+            },
+            [&](int copy) {
+                std::string err;
+                tinyobj::LoadObj(&attribs[copy], &shapes[copy], &materials[copy], &err, objInputs[copy].get(),
+                    materialReaders[copy].get(), true);
+            });
+    }
+
+    //the remaining steps start from one parse
+    tinyobj::attrib_t attrib;
+    std::vector<tinyobj::shape_t> shapes;
+    std::vector<tinyobj::material_t> materials;
+    std::string err;
+    std::istringstream objInput(objText);
+    std::istringstream mtlInput(mtlText);
+    tinyobj::MaterialStreamReader materialReader(mtlInput);
+    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &err, &objInput, &materialReader, true)) {
+        std::cerr << "The generated OBJ did not parse: " << err << std::endl;
+        return;
+    }
+    objText.clear();
+    objText.shrink_to_fit();
+
+    std::vector<std::vector<gps::Vertex> > vertices(shapes.size());
+    std::vector<std::vector<GLuint> > indices(shapes.size());
+    double vertexBytes = 0.0;
+    for (size_t s = 0; s < shapes.size(); s++) {
+        gps::MeshProcessing::AssembleShape(attrib, shapes[s], vertices[s], indices[s]);
+        vertexBytes += vertices[s].size() * sizeof(gps::Vertex) + indices[s].size() * sizeof(GLuint);
+    }
+
+    //fresh vectors per shape, as ReadOBJ has them, the bytes are the vertices and indices written
+    if (selected("vertex assembly")) {
+        runBenchmark("vertex assembly", triangles, vertexBytes, (double)triangles, "tri", vertexBytes / shapes.size(),
+            [&](int copies) {
+                sinks.assign(copies, 0);
+            },
+            [&](int copy) {
+                for (size_t s = 0; s < shapes.size(); s++) {
+                    std::vector<gps::Vertex> shapeVertices;
+                    std::vector<GLuint> shapeIndices;
+                    gps::MeshProcessing::AssembleShape(attrib, shapes[s], shapeVertices, shapeIndices);
+                    sinks[copy] += (long long)shapeVertices.size();
+                }
+            });
+    }
+
+    //the position stream and the bounds Mesh builds before uploading, the bytes are the vertices read
+    if (selected("mesh optimization")) {
+        runBenchmark("mesh optimization", triangles, vertexBytes, (double)triangles, "tri", vertexBytes / shapes.size(),
+            [&](int copies) {
+                sinks.assign(copies, 0);
+            },
+            [&](int copy) {
+                for (size_t s = 0; s < vertices.size(); s++) {
+                    std::vector<glm::vec3> positions;
+                    std::vector<GLuint> positionIndices;
+                    gps::MeshProcessing::BuildPositionStream(vertices[s], indices[s], positions, positionIndices);
+                    gps::BoundingBox bounds = gps::MeshProcessing::ComputeBounds(vertices[s]);
+                    sinks[copy] += (long long)positions.size() + (bounds.max.x > bounds.min.x ? 1 : 0);
+                }
+            });
+    }
+}
+
+//stbi_load and the row flip of ReadTextureFromFile, timed apart
+void benchmarkTexture(int size) {
+
+    std::vector<unsigned char> png = gps::AssetGenerator::EncodePNG(size, size);
+    double texels = (double)size * size;
+
+    if (selected("texture decode")) {
+        runBenchmark("texture decode", size, (double)png.size(), texels, "texel", texels * 4.0,
+            [&](int copies) {
+                sinks.assign(copies, 0);
+            },
+            [&](int copy) {
+                int width, height, channels;
+                unsigned char* pixels = stbi_load_from_memory(&png[0], (int)png.size(), &width, &height, &channels, 4);
+                if (pixels != nullptr) {
+                    sinks[copy] += pixels[0];
+                    stbi_image_free(pixels);
+                }
+            });
+    }
+
+    if (selected("texture flip")) {
+        int width, height, channels;
+        unsigned char* decoded = stbi_load_from_memory(&png[0], (int)png.size(), &width, &height, &channels, 4);
+        if (decoded == nullptr) {
+            std::cerr << "The generated PNG did not decode: " << stbi_failure_reason() << std::endl;
+            return;
+        }
+        std::vector<std::vector<unsigned char> > images;
+        runBenchmark("texture flip", size, texels * 4.0, texels, "texel", texels * 4.0,
+            [&](int copies) {
+                images.resize(copies);
+                for (int i = 0; i < copies; i++) {
+                    images[i].assign(decoded, decoded + (size_t)width * height * 4);
+                }
+            },
+            [&](int copy) {
+                gps::MeshProcessing::FlipRows(&images[copy][0], width, height, 4);
+            });
+        stbi_image_free(decoded);
+    }
+}
+
+//a flat hierarchy of groups of eight, every entity rotated each update like the animated parts of the scene
+void benchmarkTransforms(int entities) {
+
+    if (!selected("transform update")) {
+        return;
+    }
+
+    std::vector<std::unique_ptr<gps::TransformStore> > stores;
+    float angle = 0.0f;
+    //local, world and normal matrix written per entity
+    double bytes = (double)entities * (2 * sizeof(glm::mat4) + sizeof(glm::mat3));
+    runBenchmark("transform update", entities, bytes, (double)entities, "matrix", bytes,
+        [&](int copies) {
+            while ((int)stores.size() < copies) {
+                stores.emplace_back(new gps::TransformStore());
+                gps::TransformStore& store = *stores.back();
+                for (int e = 0; e < entities; e++) {
+                    gps::Entity entity = store.Create(e % 8 == 0 ? gps::NO_PARENT : e - e % 8);
+                    store.SetPosition(entity, glm::vec3((float)(e % 100), 0.0f, (float)(e / 100)));
+                }
+            }
+            angle += 0.01f;
+            glm::quat rotation = glm::angleAxis(angle, glm::vec3(0.0f, 1.0f, 0.0f));
+            for (int i = 0; i < copies; i++) {
+                for (int e = 0; e < entities; e++) {
+                    stores[i]->SetRotation(e, rotation);
+                }
+            }
+        },
+        [&](int copy) {
+            stores[copy]->Update();
+        });
+}
+
+bool writeJson(const std::string& fileName) {
+
+    std::ofstream file(fileName);
+    if (!file.is_open()) {
+        std::cout << "Could not write " << fileName << std::endl;
+        return false;
+    }
+
+    file << "{\n  \"results\": [";
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchmarkResult& result = results[i];
+        file << (i == 0 ? "\n" : ",\n") << "    { \"benchmark\": \"" << result.name << "\""
+            << ", \"size\": " << result.size
+            << ", \"threads\": " << result.threads
+            << ", \"ms\": " << result.milliseconds
+            << ", \"MBps\": " << result.megabytesPerSecond
+            << ", \"perSecond\": " << result.itemsPerSecond
+            << ", \"unit\": \"" << result.itemUnit << "\""
+            << ", \"speedup\": " << result.speedup << " }";
+    }
+    file << "\n  ]\n}\n";
+
+    std::cout << "Benchmark results written to " << fileName << std::endl;
+    return true;
+}
+
+int main(int argc, const char* argv[]) {
+
+    std::string generateDirectory;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--triangles") == 0 && i + 1 < argc) {
+            triangleCounts = parseList(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--textures") == 0 && i + 1 < argc) {
+            textureSizes = parseList(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--entities") == 0 && i + 1 < argc) {
+            entityCounts = parseList(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--shapes") == 0 && i + 1 < argc) {
+            shapeCount = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            maxThreads = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--memory-gb") == 0 && i + 1 < argc) {
+            memoryBudget = atof(argv[++i]) * 1073741824.0;
+        }
+        else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = std::max(atoi(argv[++i]), 1);
+        }
+        else if (strcmp(argv[i], "--only") == 0 && i + 1 < argc) {
+            onlyBenchmark = argv[++i];
+        }
+        else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            jsonOutput = argv[++i];
+        }
+        else if (strcmp(argv[i], "--generate") == 0 && i + 1 < argc) {
+            generateDirectory = argv[++i];
+        }
+        else {
+            std::cout << "Unknown argument " << argv[i] << std::endl;
+        }
+    }
+
+    if (!generateDirectory.empty()) {
+        bool written = gps::AssetGenerator::WriteAssets(generateDirectory, triangleCounts.back(), shapeCount, (int)textureSizes.back());
+        return written ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (maxThreads <= 0) {
+        maxThreads = std::max((int)std::thread::hardware_concurrency(), 1);
+    }
+
+    printf("%-18s %10s %11s %13s %15s %18s %7s\n", "benchmark", "size", "threads", "best time", "bytes", "items", "speedup");
+    for (size_t i = 0; i < triangleCounts.size(); i++) {
+        benchmarkMeshes(triangleCounts[i]);
+    }
+    for (size_t i = 0; i < textureSizes.size(); i++) {
+        benchmarkTexture((int)textureSizes[i]);
+    }
+    for (size_t i = 0; i < entityCounts.size(); i++) {
+        benchmarkTransforms((int)entityCounts[i]);
+    }
+
+    if (!jsonOutput.empty() && !writeJson(jsonOutput)) {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -1,4 +1,7 @@
 #include "Model3D.hpp"
+#include "GpuMemory.hpp"
+#include "MeshProcessing.hpp"
+#include "Profiler.hpp"
 
 namespace gps {
 
@@ -9,19 +12,37 @@ namespace gps {
 	}
 
     void Model3D::LoadModel(std::string fileName, std::string basePath)	{
+		GPS_PROFILE_FUNCTION();
 
 		ReadOBJ(fileName, basePath);
 	}
 
 	// Draw each mesh from the model
-	void Model3D::Draw(gps::Shader shaderProgram) {
+	void Model3D::Draw(gps::Shader& shaderProgram) {
 
 		for (int i = 0; i < meshes.size(); i++)
 			meshes[i].Draw(shaderProgram);
 	}
 
+	int Model3D::GetMeshCount() {
+
+		return (int)meshes.size();
+	}
+
+	gps::Mesh* Model3D::GetMesh(int index) {
+
+		return &meshes[index];
+	}
+
+	// Model space bounding box of all the meshes
+	gps::BoundingBox Model3D::GetBounds() {
+
+		return bounds;
+	}
+
 	// Does the parsing of the .obj file and fills in the data structure
 	void Model3D::ReadOBJ(std::string fileName, std::string basePath) {
+        GPS_PROFILE_FUNCTION();
 
         std::cout << "Loading : " << fileName << std::endl;
 		tinyobj::attrib_t attrib;
@@ -52,53 +73,7 @@ namespace gps {
 			std::vector<gps::Vertex> vertices;
 			std::vector<GLuint> indices;
 			std::vector<gps::Texture> textures;
-
-			// Loop over faces(polygon)
-			size_t index_offset = 0;
-			for (size_t f = 0; f < shapes[s].mesh.num_face_vertices.size(); f++) {
-
-				int fv = shapes[s].mesh.num_face_vertices[f];
-
-				//gps::Texture currentTexture = LoadTexture("index1.png", "ambientTexture");
-				//textures.push_back(currentTexture);
-
-				// Loop over vertices in the face.
-				for (size_t v = 0; v < fv; v++) {
-
-					// access to vertex
-					tinyobj::index_t idx = shapes[s].mesh.indices[index_offset + v];
-
-					float vx = attrib.vertices[3 * idx.vertex_index + 0];
-					float vy = attrib.vertices[3 * idx.vertex_index + 1];
-					float vz = attrib.vertices[3 * idx.vertex_index + 2];
-					float nx = attrib.normals[3 * idx.normal_index + 0];
-					float ny = attrib.normals[3 * idx.normal_index + 1];
-					float nz = attrib.normals[3 * idx.normal_index + 2];
-					float tx = 0.0f;
-					float ty = 0.0f;
-
-					if (idx.texcoord_index != -1) {
-
-						tx = attrib.texcoords[2 * idx.texcoord_index + 0];
-						ty = attrib.texcoords[2 * idx.texcoord_index + 1];
-					}
-
-					glm::vec3 vertexPosition(vx, vy, vz);
-					glm::vec3 vertexNormal(nx, ny, nz);
-					glm::vec2 vertexTexCoords(tx, ty);
-
-					gps::Vertex currentVertex;
-					currentVertex.Position = vertexPosition;
-					currentVertex.Normal = vertexNormal;
-					currentVertex.TexCoords = vertexTexCoords;
-
-					vertices.push_back(currentVertex);
-
-					indices.push_back((GLuint)(index_offset + v));
-				}
-
-				index_offset += fv;
-			}
+			MeshProcessing::AssembleShape(attrib, shapes[s], vertices, indices);
 
 			// get material id
 			// Only try to read materials if the .mtl file is present
@@ -147,6 +122,18 @@ namespace gps {
 			}
 
 			meshes.push_back(gps::Mesh(vertices, indices, textures));
+			GPS_GL_LABEL(GL_VERTEX_ARRAY, meshes.back().getBuffers().VAO, fileName + " mesh " + std::to_string(meshes.size() - 1));
+			GPS_GL_LABEL(GL_VERTEX_ARRAY, meshes.back().getBuffers().positionVAO, fileName + " mesh " + std::to_string(meshes.size() - 1) + " positions");
+
+			// grow the model bounds, LoadModel may be called several times on the same model
+			gps::BoundingBox meshBounds = meshes.back().getBounds();
+			if (meshes.size() == 1) {
+				bounds = meshBounds;
+			}
+			else {
+				bounds.min = glm::min(bounds.min, meshBounds.min);
+				bounds.max = glm::max(bounds.max, meshBounds.max);
+			}
 		}
 	}
 
@@ -174,10 +161,15 @@ namespace gps {
 
 	// Reads the pixel data from an image file and loads it into the video memory
 	GLuint Model3D::ReadTextureFromFile(const char* file_name) {
+		GPS_PROFILE_FUNCTION();
 
 		int x, y, n;
 		int force_channels = 4;
-		unsigned char* image_data = stbi_load(file_name, &x, &y, &n, force_channels);
+		unsigned char* image_data;
+		{
+			GPS_PROFILE_SCOPE("texture decode");
+			image_data = stbi_load(file_name, &x, &y, &n, force_channels);
+		}
 
 		if (!image_data) {
 			fprintf(stderr, "ERROR: could not load %s\n", file_name);
@@ -190,26 +182,7 @@ namespace gps {
 			);
 		}
 
-		int width_in_bytes = x * 4;
-		unsigned char *top = NULL;
-		unsigned char *bottom = NULL;
-		unsigned char temp = 0;
-		int half_height = y / 2;
-
-		for (int row = 0; row < half_height; row++) {
-
-			top = image_data + row * width_in_bytes;
-			bottom = image_data + (y - row - 1) * width_in_bytes;
-
-			for (int col = 0; col < width_in_bytes; col++) {
-
-				temp = *top;
-				*top = *bottom;
-				*bottom = temp;
-				top++;
-				bottom++;
-			}
-		}
+		MeshProcessing::FlipRows(image_data, x, y, 4);
 
 		GLuint textureID;
 		glGenTextures(1, &textureID);
@@ -226,6 +199,8 @@ namespace gps {
 			image_data
 		);
 		glGenerateMipmap(GL_TEXTURE_2D);
+		GPS_GL_LABEL(GL_TEXTURE, textureID, file_name);
+		GpuMemory::Track(GPU_MEMORY_TEXTURE, textureID, GpuMemory::ImageBytes(x, y, 1, GL_SRGB, true));
 
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
@@ -240,6 +215,7 @@ namespace gps {
 
         for (size_t i = 0; i < loadedTextures.size(); i++) {
 
+            GpuMemory::Release(GPU_MEMORY_TEXTURE, loadedTextures.at(i).id);
             glDeleteTextures(1, &loadedTextures.at(i).id);
         }
 
@@ -248,9 +224,21 @@ namespace gps {
             GLuint VBO = meshes.at(i).getBuffers().VBO;
             GLuint EBO = meshes.at(i).getBuffers().EBO;
             GLuint VAO = meshes.at(i).getBuffers().VAO;
+            GpuMemory::Release(GPU_MEMORY_BUFFER, VBO);
+            GpuMemory::Release(GPU_MEMORY_BUFFER, EBO);
             glDeleteBuffers(1, &VBO);
             glDeleteBuffers(1, &EBO);
             glDeleteVertexArrays(1, &VAO);
+
+            //the packed position stream of the depth only passes
+            GLuint positionVBO = meshes.at(i).getBuffers().positionVBO;
+            GLuint positionEBO = meshes.at(i).getBuffers().positionEBO;
+            GLuint positionVAO = meshes.at(i).getBuffers().positionVAO;
+            GpuMemory::Release(GPU_MEMORY_BUFFER, positionVBO);
+            GpuMemory::Release(GPU_MEMORY_BUFFER, positionEBO);
+            glDeleteBuffers(1, &positionVBO);
+            glDeleteBuffers(1, &positionEBO);
+            glDeleteVertexArrays(1, &positionVAO);
         }
 	}
 }
@@ -21,13 +21,22 @@ namespace gps {
 
 		void LoadModel(std::string fileName, std::string basePath);
 
-		void Draw(gps::Shader shaderProgram);
+		void Draw(gps::Shader& shaderProgram);
+
+		int GetMeshCount();
+
+		gps::Mesh* GetMesh(int index);
+
+		// Model space bounding box of all the meshes
+		gps::BoundingBox GetBounds();
 
     private:
 		// Component meshes - group of objects
         std::vector<gps::Mesh> meshes;
 		// Associated textures
         std::vector<gps::Texture> loadedTextures;
+		// Union of the mesh bounds
+		gps::BoundingBox bounds;
 
 		// Does the parsing of the .obj file and fills in the data structure
 		void ReadOBJ(std::string fileName, std::string basePath);
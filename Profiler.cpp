@@ -0,0 +1,241 @@
+#include "Profiler.hpp"
+#include "AllocationTracker.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace gps {
+
+    //a buffer is registered once per thread and kept after the thread ends, for the trace
+    static std::mutex buffersMutex;
+    static std::vector<ProfileThreadBuffer*> buffers;
+    static thread_local ProfileThreadBuffer* threadBuffer = nullptr;
+    static const std::chrono::steady_clock::time_point profilerEpoch = std::chrono::steady_clock::now();
+
+    //per frame totals of one scope name, in a ring over the last frames
+    struct ScopeAverage {
+        int depth;
+        double milliseconds[PROFILER_AVERAGE_FRAMES];
+        int calls[PROFILER_AVERAGE_FRAMES];
+    };
+    static std::map<std::string, ScopeAverage> averages;
+    //first seen order, so the printout follows the call hierarchy
+    static std::vector<std::string> averageOrder;
+    static long long averagedFrames = 0;
+    //the names are literals or interned, so after the first frames a pointer finds its average without a string
+    static std::map<const char*, ScopeAverage*> averagesByName;
+    //reused by EndFrame, a steady frame does not allocate
+    static std::vector<ProfileThreadBuffer*> endFrameThreads;
+    static std::vector<ProfileEvent> endFrameEvents;
+
+    long long Profiler::Now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - profilerEpoch).count();
+    }
+
+    ProfileThreadBuffer* Profiler::GetThreadBuffer() {
+
+        if (threadBuffer == nullptr)
+            threadBuffer = CreateTrack("");
+        return threadBuffer;
+    }
+
+    ProfileThreadBuffer* Profiler::CreateTrack(std::string name) {
+
+        ProfileThreadBuffer* buffer = new ProfileThreadBuffer();
+        buffer->depth = 0;
+        buffer->writeIndex.store(0);
+        buffer->averagedIndex = 0;
+
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        buffer->threadId = (int)buffers.size();
+        buffer->name = name.empty() ? "thread " + std::to_string(buffer->threadId) : name;
+        buffers.push_back(buffer);
+        return buffer;
+    }
+
+    void Profiler::Record(ProfileThreadBuffer* track, const char* name, long long start, long long end, int depth) {
+
+        unsigned long long index = track->writeIndex.load(std::memory_order_relaxed);
+        ProfileEvent& event = track->events[index % PROFILER_RING_SIZE];
+        event.name = name;
+        event.start = start;
+        event.end = end;
+        event.depth = depth;
+        track->writeIndex.store(index + 1, std::memory_order_release);
+    }
+
+    void Profiler::SetThreadName(std::string name) {
+
+        ProfileThreadBuffer* buffer = GetThreadBuffer();
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        buffer->name = name;
+    }
+
+    ProfileScope::ProfileScope(const char* name) {
+
+        this->name = name;
+        buffer = Profiler::GetThreadBuffer();
+        buffer->depth++;
+        start = Profiler::Now();
+    }
+
+    ProfileScope::~ProfileScope() {
+
+        long long end = Profiler::Now();
+        buffer->depth--;
+        Profiler::Record(buffer, name, start, end, buffer->depth);
+    }
+
+    //copies the events in [from, writeIndex) that were not overwritten while copying
+    static void ReadEvents(ProfileThreadBuffer* buffer, unsigned long long from, std::vector<ProfileEvent>& events,
+        unsigned long long& to) {
+
+        //the slot of the next index may be half written, it shares its slot with to - PROFILER_RING_SIZE
+        to = buffer->writeIndex.load(std::memory_order_acquire);
+        if (to - from >= (unsigned long long)PROFILER_RING_SIZE)
+            from = to - PROFILER_RING_SIZE + 1;
+
+        size_t first = events.size();
+        for (unsigned long long i = from; i < to; i++)
+            events.push_back(buffer->events[i % PROFILER_RING_SIZE]);
+
+        //the writer may have lapped the oldest copied events in the meantime
+        unsigned long long now = buffer->writeIndex.load(std::memory_order_acquire);
+        if (now + 1 - from > (unsigned long long)PROFILER_RING_SIZE) {
+            size_t lapped = (size_t)(now + 1 - from - PROFILER_RING_SIZE);
+            events.erase(events.begin() + first, events.begin() + first + std::min(lapped, events.size() - first));
+        }
+    }
+
+    void Profiler::EndFrame() {
+
+        GPS_ALLOC_TAG("profiler");
+        std::vector<ProfileThreadBuffer*>& threads = endFrameThreads;
+        {
+            std::lock_guard<std::mutex> lock(buffersMutex);
+            threads.assign(buffers.begin(), buffers.end());
+        }
+
+        int slot = (int)(averagedFrames % PROFILER_AVERAGE_FRAMES);
+        for (std::map<std::string, ScopeAverage>::iterator it = averages.begin(); it != averages.end(); ++it) {
+            it->second.milliseconds[slot] = 0.0;
+            it->second.calls[slot] = 0;
+        }
+
+        std::vector<ProfileEvent>& events = endFrameEvents;
+        for (size_t t = 0; t < threads.size(); t++) {
+
+            events.clear();
+            ReadEvents(threads[t], threads[t]->averagedIndex, events, threads[t]->averagedIndex);
+            //scopes are written when they end, a parent after its children
+            //std::sort works in place, stable_sort would take a temporary buffer every frame
+            std::sort(events.begin(), events.end(), [](const ProfileEvent& a, const ProfileEvent& b) {
+                return a.start != b.start ? a.start < b.start : a.depth < b.depth;
+            });
+            for (size_t e = 0; e < events.size(); e++) {
+
+                std::map<const char*, ScopeAverage*>::iterator cached = averagesByName.find(events[e].name);
+                if (cached == averagesByName.end()) {
+                    std::string name = events[e].name;
+                    std::map<std::string, ScopeAverage>::iterator found = averages.find(name);
+                    if (found == averages.end()) {
+                        ScopeAverage average = {};
+                        average.depth = events[e].depth;
+                        found = averages.insert(std::make_pair(name, average)).first;
+                        averageOrder.push_back(name);
+                    }
+                    cached = averagesByName.insert(std::make_pair(events[e].name, &found->second)).first;
+                }
+                cached->second->milliseconds[slot] += (double)(events[e].end - events[e].start) / 1000000.0;
+                cached->second->calls[slot]++;
+            }
+        }
+
+        averagedFrames++;
+    }
+
+    void Profiler::PrintAverages() {
+
+        int frames = (int)std::min(averagedFrames, (long long)PROFILER_AVERAGE_FRAMES);
+        if (frames == 0) {
+            std::cout << "Profiler: no frames recorded" << (averageOrder.empty() ? ", built without GPS_PROFILER?" : "") << std::endl;
+            return;
+        }
+
+        std::cout << "Profiler, average per frame over " << frames << " frames:" << std::endl;
+        for (size_t i = 0; i < averageOrder.size(); i++) {
+
+            const ScopeAverage& average = averages[averageOrder[i]];
+            double milliseconds = 0.0;
+            int calls = 0;
+            for (int f = 0; f < frames; f++) {
+                milliseconds += average.milliseconds[f];
+                calls += average.calls[f];
+            }
+
+            std::cout << std::string(average.depth * 2, ' ') << averageOrder[i] << ": "
+                << std::fixed << std::setprecision(3) << milliseconds / frames << " ms, "
+                << std::setprecision(1) << (double)calls / frames << " calls" << std::endl;
+        }
+        std::cout << std::defaultfloat;
+    }
+
+    static std::string EscapeJson(const std::string& text) {
+
+        std::string escaped;
+        for (size_t i = 0; i < text.size(); i++) {
+            if (text[i] == '"' || text[i] == '\\')
+                escaped += '\\';
+            escaped += text[i];
+        }
+        return escaped;
+    }
+
+    //complete ("X") events in microseconds, one track per thread
+    bool Profiler::WriteChromeTrace(std::string fileName) {
+
+        std::ofstream file(fileName);
+        if (!file.is_open()) {
+            std::cout << "Could not write " << fileName << std::endl;
+            return false;
+        }
+
+        std::vector<ProfileThreadBuffer*> threads;
+        {
+            std::lock_guard<std::mutex> lock(buffersMutex);
+            threads = buffers;
+        }
+
+        file << "{\"traceEvents\":[\n";
+        bool first = true;
+        size_t eventCount = 0;
+        std::vector<ProfileEvent> events;
+        for (size_t t = 0; t < threads.size(); t++) {
+
+            file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << threads[t]->threadId
+                << ",\"args\":{\"name\":\"" << EscapeJson(threads[t]->name) << "\"}}";
+            first = false;
+
+            events.clear();
+            unsigned long long end;
+            ReadEvents(threads[t], 0, events, end);
+            for (size_t e = 0; e < events.size(); e++) {
+                file << ",\n{\"name\":\"" << EscapeJson(events[e].name) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << threads[t]->threadId
+                    << std::fixed << std::setprecision(3)
+                    << ",\"ts\":" << (double)events[e].start / 1000.0
+                    << ",\"dur\":" << (double)(events[e].end - events[e].start) / 1000.0 << "}";
+            }
+            eventCount += events.size();
+        }
+        file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+        std::cout << "Profiler: " << eventCount << " scopes written to " << fileName << std::endl;
+        return true;
+    }
+}
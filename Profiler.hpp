@@ -0,0 +1,81 @@
+#ifndef Profiler_hpp
+#define Profiler_hpp
+
+#include <atomic>
+#include <string>
+
+//GPS_PROFILER turns the scope markers on, without it they compile to nothing
+#if defined (GPS_PROFILER)
+    #define GPS_PROFILE_CONCAT_(a, b) a##b
+    #define GPS_PROFILE_CONCAT(a, b) GPS_PROFILE_CONCAT_(a, b)
+    //name must outlive the profiler, a string literal
+    #define GPS_PROFILE_SCOPE(name) gps::ProfileScope GPS_PROFILE_CONCAT(profileScope, __LINE__)(name)
+    #define GPS_PROFILE_FUNCTION() GPS_PROFILE_SCOPE(__FUNCTION__)
+    #define GPS_PROFILE_THREAD(name) gps::Profiler::SetThreadName(name)
+#else
+    #define GPS_PROFILE_SCOPE(name) ((void)0)
+    #define GPS_PROFILE_FUNCTION() ((void)0)
+    #define GPS_PROFILE_THREAD(name) ((void)0)
+#endif
+
+namespace gps {
+
+    //scopes each thread keeps, older ones are overwritten
+    const int PROFILER_RING_SIZE = 1 << 16;
+    //frames the rolling averages cover
+    const int PROFILER_AVERAGE_FRAMES = 120;
+
+    //nanoseconds since the profiler started
+    struct ProfileEvent {
+        const char* name;
+        long long start;
+        long long end;
+        int depth;
+    };
+
+    //written only by its own thread, the write index is published with release semantics
+    //so readers on other threads never wait for the writer
+    struct ProfileThreadBuffer {
+        std::string name;
+        int threadId;
+        int depth;
+        std::atomic<unsigned long long> writeIndex;
+        //GL thread only, the events up to here are in the averages
+        unsigned long long averagedIndex;
+        ProfileEvent events[PROFILER_RING_SIZE];
+    };
+
+    //hierarchical CPU scope timing, see GPS_PROFILE_SCOPE
+    class Profiler {
+
+    public:
+        static long long Now();
+        static void SetThreadName(std::string name);
+        //GL thread, once per frame: folds the finished scopes into the rolling averages
+        static void EndFrame();
+        //per scope time and calls per frame, averaged over the last PROFILER_AVERAGE_FRAMES frames
+        static void PrintAverages();
+        //Chrome / Perfetto trace event JSON with the scopes still in the rings
+        static bool WriteChromeTrace(std::string fileName);
+
+        static ProfileThreadBuffer* GetThreadBuffer();
+        //a track for intervals measured elsewhere, e.g. on the GPU, written by one thread only
+        static ProfileThreadBuffer* CreateTrack(std::string name);
+        //start and end on the Now() clock
+        static void Record(ProfileThreadBuffer* track, const char* name, long long start, long long end, int depth);
+    };
+
+    class ProfileScope {
+
+    public:
+        ProfileScope(const char* name);
+        ~ProfileScope();
+
+    private:
+        const char* name;
+        long long start;
+        ProfileThreadBuffer* buffer;
+    };
+}
+
+#endif /* Profiler_hpp */
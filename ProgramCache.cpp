@@ -0,0 +1,158 @@
+#include "ProgramCache.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+
+#if defined (_WIN32)
+    #include <direct.h>
+#else
+    #include <sys/stat.h>
+#endif
+
+namespace gps {
+
+    //file layout: magic, version, key, binary format, binary length, binary
+    const unsigned int CACHE_MAGIC = 0x50535047; //"GPSP"
+    const unsigned int CACHE_VERSION = 1;
+
+    struct ProgramCacheHeader {
+        unsigned int magic;
+        unsigned int version;
+        unsigned long long key;
+        GLenum binaryFormat;
+        GLint binaryLength;
+    };
+
+    //64 bit FNV-1a
+    static unsigned long long HashBytes(unsigned long long hash, const char* data, size_t length) {
+
+        for (size_t i = 0; i < length; i++) {
+            hash ^= (unsigned char)data[i];
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    static std::string GetString(GLenum name) {
+
+        const GLubyte* value = glGetString(name);
+        return value != NULL ? std::string((const char*)value) : std::string();
+    }
+
+    void ProgramCache::Init(std::string directory) {
+
+        this->directory = directory;
+        driver = GetString(GL_VENDOR) + "\n" + GetString(GL_RENDERER) + "\n" + GetString(GL_VERSION);
+
+        GLint formatCount = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+        enabled = formatCount > 0;
+        if (!enabled) {
+            std::cout << "Program binaries are not supported, shaders are compiled on every start" << std::endl;
+            return;
+        }
+
+        //an existing directory is not an error
+#if defined (_WIN32)
+        _mkdir(directory.c_str());
+#else
+        mkdir(directory.c_str(), 0755);
+#endif
+    }
+
+    bool ProgramCache::IsEnabled() {
+        return enabled;
+    }
+
+    unsigned long long ProgramCache::MakeKey(const std::vector<std::string>& sources) {
+
+        unsigned long long hash = 14695981039346656037ull;
+        hash = HashBytes(hash, driver.c_str(), driver.size() + 1);
+        //the terminators keep "ab" + "c" apart from "a" + "bc"
+        for (size_t i = 0; i < sources.size(); i++)
+            hash = HashBytes(hash, sources[i].c_str(), sources[i].size() + 1);
+        return hash;
+    }
+
+    std::string ProgramCache::GetFileName(unsigned long long key) {
+
+        std::stringstream name;
+        name << directory << "/" << std::hex << std::setw(16) << std::setfill('0') << key << ".bin";
+        return name.str();
+    }
+
+    bool ProgramCache::Load(const std::vector<std::string>& sources, GLuint program) {
+
+        if (ReadBinary(sources, program)) {
+            loadedCount++;
+            return true;
+        }
+
+        compiledCount++;
+        return false;
+    }
+
+    bool ProgramCache::ReadBinary(const std::vector<std::string>& sources, GLuint program) {
+
+        if (!enabled)
+            return false;
+
+        unsigned long long key = MakeKey(sources);
+        std::ifstream file(GetFileName(key), std::ios::binary);
+        if (!file.is_open())
+            return false;
+
+        ProgramCacheHeader header;
+        file.read((char*)&header, sizeof(header));
+        if (!file || header.magic != CACHE_MAGIC || header.version != CACHE_VERSION || header.key != key || header.binaryLength <= 0)
+            return false;
+
+        std::vector<char> binary(header.binaryLength);
+        file.read(binary.data(), header.binaryLength);
+        if (!file)
+            return false;
+
+        //a driver update can reject binaries it wrote itself, the link status tells
+        glProgramBinary(program, header.binaryFormat, binary.data(), header.binaryLength);
+        GLint success = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        return success == GL_TRUE;
+    }
+
+    void ProgramCache::Store(const std::vector<std::string>& sources, GLuint program) {
+
+        if (!enabled)
+            return;
+
+        ProgramCacheHeader header;
+        header.magic = CACHE_MAGIC;
+        header.version = CACHE_VERSION;
+        header.key = MakeKey(sources);
+        header.binaryLength = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &header.binaryLength);
+        if (header.binaryLength <= 0)
+            return;
+
+        std::vector<char> binary(header.binaryLength);
+        glGetProgramBinary(program, header.binaryLength, NULL, &header.binaryFormat, binary.data());
+
+        //a stale entry with the same key is simply overwritten
+        std::ofstream file(GetFileName(header.key), std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            std::cout << "Could not write the program cache entry " << GetFileName(header.key) << std::endl;
+            return;
+        }
+        file.write((const char*)&header, sizeof(header));
+        file.write(binary.data(), header.binaryLength);
+    }
+
+    int ProgramCache::GetLoadedCount() {
+        return loadedCount;
+    }
+
+    int ProgramCache::GetCompiledCount() {
+        return compiledCount;
+    }
+}
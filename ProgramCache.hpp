@@ -0,0 +1,51 @@
+#ifndef ProgramCache_hpp
+#define ProgramCache_hpp
+
+#if defined (__APPLE__)
+    #define GL_SILENCE_DEPRECATION
+    #include <OpenGL/gl3.h>
+#else
+    #define GLEW_STATIC
+    #include <GL/glew.h>
+#endif
+
+#include "GLIntercept.hpp"
+
+#include <string>
+#include <vector>
+
+namespace gps {
+
+    //linked programs saved with glGetProgramBinary, one file per program
+    //an entry is keyed by the preprocessed sources (so the defines and includes too)
+    //and the vendor, renderer and version strings of the driver that produced it
+    class ProgramCache {
+
+    public:
+        //GL thread only, after the context is created
+        //the cache stays disabled when the driver offers no binary formats
+        void Init(std::string directory);
+        bool IsEnabled();
+        //false when the entry is missing, stale or rejected by the driver, compile from source then
+        bool Load(const std::vector<std::string>& sources, GLuint program);
+        //the program must have been linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+        void Store(const std::vector<std::string>& sources, GLuint program);
+        //programs served from the cache and programs that had to be compiled
+        int GetLoadedCount();
+        int GetCompiledCount();
+
+    private:
+        bool enabled = false;
+        std::string directory;
+        //vendor, renderer and version, part of every key
+        std::string driver;
+        int loadedCount = 0;
+        int compiledCount = 0;
+
+        bool ReadBinary(const std::vector<std::string>& sources, GLuint program);
+        unsigned long long MakeKey(const std::vector<std::string>& sources);
+        std::string GetFileName(unsigned long long key);
+    };
+}
+
+#endif /* ProgramCache_hpp */
@@ -0,0 +1,348 @@
+#include "RenderGraph.hpp"
+#include "GpuMemory.hpp"
+#include "AllocationTracker.hpp"
+
+namespace gps {
+
+    //a texture owned outside of the graph, e.g. a cached shadow map
+    RenderResource RenderGraph::ImportTexture(std::string name, GLuint textureId) {
+
+        Resource resource;
+        resource.name = name;
+        resource.imported = true;
+        resource.backbuffer = false;
+        resource.desc = RenderTargetDesc{ 0, 0, GL_NONE };
+        resource.physical = -1;
+        resource.textureId = textureId;
+        resources.push_back(resource);
+
+        return (RenderResource)resources.size() - 1;
+    }
+
+    //the default framebuffer - passes writing it are never culled
+    RenderResource RenderGraph::ImportBackbuffer(std::string name, GLuint framebuffer) {
+
+        backbufferFramebuffer = framebuffer;
+        RenderResource handle = ImportTexture(name, 0);
+        resources[handle].backbuffer = true;
+        return handle;
+    }
+
+    //a transient target, allocated by Compile and possibly aliased with other transients
+    RenderResource RenderGraph::CreateRenderTarget(std::string name, RenderTargetDesc desc) {
+
+        Resource resource;
+        resource.name = name;
+        resource.imported = false;
+        resource.backbuffer = false;
+        resource.desc = desc;
+        resource.physical = -1;
+        resource.textureId = 0;
+        resources.push_back(resource);
+
+        return (RenderResource)resources.size() - 1;
+    }
+
+    //passes run in the order they are added and must only read resources written before
+    void RenderGraph::AddPass(std::string name, std::vector<RenderResource> inputs, std::vector<RenderResource> outputs,
+        int objectSets, std::function<void(const RenderPass&)> execute) {
+
+        RenderPass pass;
+        pass.name = name;
+        pass.inputs = inputs;
+        pass.outputs = outputs;
+        pass.objectSets = objectSets;
+        pass.execute = execute;
+        pass.culled = false;
+        pass.framebuffer = 0;
+        passes.push_back(pass);
+    }
+
+    //cull passes whose outputs are never read and allocate the transient targets
+    void RenderGraph::Compile() {
+
+        ReleaseGLObjects();
+
+        //walk backwards: a pass is needed if it writes an imported resource
+        //or a transient read by a pass that is needed
+        std::vector<bool> needed(resources.size(), false);
+        for (int p = (int)passes.size() - 1; p >= 0; p--) {
+
+            RenderPass& pass = passes[p];
+            pass.culled = true;
+            for (size_t o = 0; o < pass.outputs.size(); o++) {
+
+                const Resource& output = resources[pass.outputs[o]];
+                if (output.imported || needed[pass.outputs[o]])
+                    pass.culled = false;
+            }
+
+            if (pass.culled)
+                continue;
+
+            for (size_t i = 0; i < pass.inputs.size(); i++)
+                needed[pass.inputs[i]] = true;
+        }
+
+        //lifetimes of the transients over the passes that survived
+        std::vector<int> firstUse(resources.size(), -1);
+        std::vector<int> lastUse(resources.size(), -1);
+        for (int p = 0; p < (int)passes.size(); p++) {
+
+            if (passes[p].culled)
+                continue;
+
+            std::vector<RenderResource> used = passes[p].inputs;
+            used.insert(used.end(), passes[p].outputs.begin(), passes[p].outputs.end());
+            for (size_t u = 0; u < used.size(); u++) {
+
+                if (firstUse[used[u]] < 0)
+                    firstUse[used[u]] = p;
+                lastUse[used[u]] = p;
+            }
+        }
+
+        //assign transients to physical textures in order of first use
+        //a texture with the same description is reused once its previous owner is dead
+        std::vector<int> order;
+        for (int r = 0; r < (int)resources.size(); r++) {
+
+            if (!resources[r].imported && firstUse[r] >= 0)
+                order.push_back(r);
+        }
+        for (size_t i = 1; i < order.size(); i++) {
+
+            int current = order[i];
+            size_t j = i;
+            while (j > 0 && firstUse[order[j - 1]] > firstUse[current]) {
+                order[j] = order[j - 1];
+                j--;
+            }
+            order[j] = current;
+        }
+
+        for (size_t i = 0; i < order.size(); i++) {
+
+            Resource& resource = resources[order[i]];
+            int physical = -1;
+            for (int t = 0; t < (int)physicalTargets.size(); t++) {
+
+                const PhysicalTarget& target = physicalTargets[t];
+                if (target.lastUse < firstUse[order[i]]
+                    && target.desc.width == resource.desc.width
+                    && target.desc.height == resource.desc.height
+                    && target.desc.internalFormat == resource.desc.internalFormat) {
+                    physical = t;
+                    break;
+                }
+            }
+
+            if (physical < 0) {
+                PhysicalTarget target;
+                target.desc = resource.desc;
+                target.textureId = CreateTexture(resource.desc);
+                //an aliased texture keeps the name of its first owner
+                GPS_GL_LABEL(GL_TEXTURE, target.textureId, resource.name);
+                target.lastUse = -1;
+                physicalTargets.push_back(target);
+                physical = (int)physicalTargets.size() - 1;
+            }
+
+            physicalTargets[physical].lastUse = lastUse[order[i]];
+            resource.physical = physical;
+            resource.textureId = physicalTargets[physical].textureId;
+        }
+
+        for (size_t p = 0; p < passes.size(); p++) {
+
+            if (!passes[p].culled)
+                CreateFramebuffer(passes[p]);
+        }
+
+        transientTargetCount = (int)order.size();
+    }
+
+    //passes writing only transients get a framebuffer built from their outputs
+    //passes writing imported resources bind their own targets
+    void RenderGraph::CreateFramebuffer(RenderPass& pass) {
+
+        pass.framebuffer = 0;
+        if (pass.outputs.empty())
+            return;
+
+        for (size_t o = 0; o < pass.outputs.size(); o++) {
+
+            if (resources[pass.outputs[o]].imported)
+                return;
+        }
+
+        glGenFramebuffers(1, &pass.framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, pass.framebuffer);
+        GPS_GL_LABEL(GL_FRAMEBUFFER, pass.framebuffer, pass.name);
+
+        std::vector<GLenum> drawBuffers;
+        for (size_t o = 0; o < pass.outputs.size(); o++) {
+
+            const Resource& output = resources[pass.outputs[o]];
+            if (IsDepthFormat(output.desc.internalFormat)) {
+                GLenum attachment = output.desc.internalFormat == GL_DEPTH24_STENCIL8 ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+                glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, output.textureId, 0);
+            }
+            else {
+                GLenum attachment = GL_COLOR_ATTACHMENT0 + (GLenum)drawBuffers.size();
+                glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, output.textureId, 0);
+                drawBuffers.push_back(attachment);
+            }
+        }
+
+        if (drawBuffers.empty()) {
+            glDrawBuffer(GL_NONE);
+            glReadBuffer(GL_NONE);
+        }
+        else {
+            glDrawBuffers((GLsizei)drawBuffers.size(), &drawBuffers[0]);
+        }
+
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cout << "Render graph: framebuffer of pass " << pass.name << " is incomplete" << std::endl;
+
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    //run the passes that survived compilation
+    void RenderGraph::Execute() {
+
+        GPS_ALLOC_TAG("render graph");
+        for (size_t p = 0; p < passes.size(); p++) {
+
+            const RenderPass& pass = passes[p];
+            if (pass.culled)
+                continue;
+
+            GPS_GL_DEBUG_GROUP(pass.name.c_str());
+            if (pass.framebuffer != 0) {
+                const RenderTargetDesc& desc = resources[pass.outputs[0]].desc;
+                glBindFramebuffer(GL_FRAMEBUFFER, pass.framebuffer);
+                glViewport(0, 0, desc.width, desc.height);
+            }
+            else if (WritesBackbuffer(pass)) {
+                glBindFramebuffer(GL_FRAMEBUFFER, backbufferFramebuffer);
+            }
+
+            if (beginPassHook)
+                beginPassHook(pass);
+            pass.execute(pass);
+            if (endPassHook)
+                endPassHook(pass);
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, backbufferFramebuffer);
+    }
+
+    void RenderGraph::SetPassHooks(std::function<void(const RenderPass&)> beginPass, std::function<void(const RenderPass&)> endPass) {
+
+        beginPassHook = beginPass;
+        endPassHook = endPass;
+    }
+
+    //release the transient textures and framebuffers, passes and resources
+    void RenderGraph::Reset() {
+
+        ReleaseGLObjects();
+        passes.clear();
+        resources.clear();
+    }
+
+    void RenderGraph::ReleaseGLObjects() {
+
+        for (size_t p = 0; p < passes.size(); p++) {
+
+            if (passes[p].framebuffer != 0)
+                glDeleteFramebuffers(1, &passes[p].framebuffer);
+            passes[p].framebuffer = 0;
+        }
+
+        for (size_t t = 0; t < physicalTargets.size(); t++) {
+
+            GpuMemory::Release(GPU_MEMORY_TEXTURE, physicalTargets[t].textureId);
+            glDeleteTextures(1, &physicalTargets[t].textureId);
+        }
+        physicalTargets.clear();
+        transientTargetCount = 0;
+
+        for (size_t r = 0; r < resources.size(); r++) {
+
+            if (!resources[r].imported) {
+                resources[r].physical = -1;
+                resources[r].textureId = 0;
+            }
+        }
+    }
+
+    GLuint RenderGraph::CreateTexture(RenderTargetDesc desc) {
+
+        GLenum format = GL_RGBA;
+        GLenum type = GL_UNSIGNED_BYTE;
+        if (desc.internalFormat == GL_DEPTH24_STENCIL8) {
+            format = GL_DEPTH_STENCIL;
+            type = GL_UNSIGNED_INT_24_8;
+        }
+        else if (IsDepthFormat(desc.internalFormat)) {
+            format = GL_DEPTH_COMPONENT;
+            type = GL_FLOAT;
+        }
+
+        GLuint textureId;
+        glGenTextures(1, &textureId);
+        glBindTexture(GL_TEXTURE_2D, textureId);
+        glTexImage2D(GL_TEXTURE_2D, 0, desc.internalFormat, desc.width, desc.height, 0, format, type, NULL);
+        GpuMemory::Track(GPU_MEMORY_TEXTURE, textureId, GpuMemory::ImageBytes(desc.width, desc.height, 1, desc.internalFormat, false));
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        return textureId;
+    }
+
+    bool RenderGraph::WritesBackbuffer(const RenderPass& pass) {
+
+        for (size_t o = 0; o < pass.outputs.size(); o++) {
+
+            if (resources[pass.outputs[o]].backbuffer)
+                return true;
+        }
+
+        return false;
+    }
+
+    bool RenderGraph::IsDepthFormat(GLenum internalFormat) {
+
+        return internalFormat == GL_DEPTH_COMPONENT
+            || internalFormat == GL_DEPTH_COMPONENT16
+            || internalFormat == GL_DEPTH_COMPONENT24
+            || internalFormat == GL_DEPTH_COMPONENT32F
+            || internalFormat == GL_DEPTH24_STENCIL8;
+    }
+
+    GLuint RenderGraph::GetTexture(RenderResource resource) {
+        return resources[resource].textureId;
+    }
+
+    int RenderGraph::GetPassCount() {
+        return (int)passes.size();
+    }
+
+    const RenderPass& RenderGraph::GetPass(int index) {
+        return passes[index];
+    }
+
+    int RenderGraph::GetTransientTargetCount() {
+        return transientTargetCount;
+    }
+
+    int RenderGraph::GetTransientTextureCount() {
+        return (int)physicalTargets.size();
+    }
+}
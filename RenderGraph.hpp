@@ -0,0 +1,115 @@
+#ifndef RenderGraph_hpp
+#define RenderGraph_hpp
+
+#if defined (__APPLE__)
+    #define GL_SILENCE_DEPRECATION
+    #include <OpenGL/gl3.h>
+#else
+    #define GLEW_STATIC
+    #include <GL/glew.h>
+#endif
+
+#include "GLDebug.hpp"
+#include "GLIntercept.hpp"
+
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace gps {
+
+    //sets of scene objects a pass can declare it draws
+    enum OBJECT_SET {
+        OBJECTS_NONE = 0,
+        OBJECTS_STATIC = 1 << 0,
+        OBJECTS_DYNAMIC = 1 << 1,
+        OBJECTS_SKY = 1 << 2
+    };
+
+    //handle of a texture known to the graph
+    typedef int RenderResource;
+
+    struct RenderTargetDesc {
+        int width;
+        int height;
+        GLenum internalFormat;
+    };
+
+    struct RenderPass {
+        std::string name;
+        std::vector<RenderResource> inputs;
+        std::vector<RenderResource> outputs;
+        int objectSets;
+        std::function<void(const RenderPass&)> execute;
+
+        //filled in by RenderGraph::Compile
+        bool culled;
+        GLuint framebuffer;
+    };
+
+    class RenderGraph {
+
+    public:
+        //a texture owned outside of the graph, e.g. a cached shadow map
+        RenderResource ImportTexture(std::string name, GLuint textureId);
+        //the default framebuffer - passes writing it are never culled
+        //a headless window renders into an offscreen framebuffer instead of 0
+        RenderResource ImportBackbuffer(std::string name, GLuint framebuffer = 0);
+        //a transient target, allocated by Compile and possibly aliased with other transients
+        //its content is undefined when the writing pass starts, so that pass must clear it
+        RenderResource CreateRenderTarget(std::string name, RenderTargetDesc desc);
+        //passes run in the order they are added and must only read resources written before
+        void AddPass(std::string name, std::vector<RenderResource> inputs, std::vector<RenderResource> outputs,
+            int objectSets, std::function<void(const RenderPass&)> execute);
+        //cull passes whose outputs are never read and allocate the transient targets
+        void Compile();
+        //run the passes that survived compilation
+        void Execute();
+        //called around every executed pass, e.g. for timing; kept across Reset
+        void SetPassHooks(std::function<void(const RenderPass&)> beginPass, std::function<void(const RenderPass&)> endPass);
+        //release the transient textures and framebuffers, passes and resources
+        void Reset();
+
+        GLuint GetTexture(RenderResource resource);
+        int GetPassCount();
+        const RenderPass& GetPass(int index);
+        //transient targets of the last compilation and the textures they were packed into
+        int GetTransientTargetCount();
+        int GetTransientTextureCount();
+
+    private:
+        struct Resource {
+            std::string name;
+            bool imported;
+            bool backbuffer;
+            RenderTargetDesc desc;
+            //index into physicalTargets for transients, otherwise the imported texture
+            int physical;
+            GLuint textureId;
+        };
+
+        struct PhysicalTarget {
+            RenderTargetDesc desc;
+            GLuint textureId;
+            //index of the last pass using the texture in the current compilation
+            int lastUse;
+        };
+
+        std::vector<Resource> resources;
+        std::vector<RenderPass> passes;
+        GLuint backbufferFramebuffer = 0;
+        std::function<void(const RenderPass&)> beginPassHook;
+        std::function<void(const RenderPass&)> endPassHook;
+        std::vector<PhysicalTarget> physicalTargets;
+        int transientTargetCount = 0;
+
+        GLuint CreateTexture(RenderTargetDesc desc);
+        void CreateFramebuffer(RenderPass& pass);
+        void ReleaseGLObjects();
+        bool WritesBackbuffer(const RenderPass& pass);
+        bool IsDepthFormat(GLenum internalFormat);
+    };
+}
+
+#endif /* RenderGraph_hpp */
@@ -0,0 +1,83 @@
+#include "RenderQueue.hpp"
+
+namespace gps {
+
+    unsigned long long RenderQueue::MakeKey(unsigned int pass, unsigned int program, unsigned int material, float depth) {
+
+        if (depth < 0.0f)
+            depth = 0.0f;
+        if (depth > 1.0f)
+            depth = 1.0f;
+        unsigned long long depthBits = (unsigned long long)(depth * 16777215.0f);
+
+        return ((unsigned long long)(pass & 0xFF) << 56)
+            | ((unsigned long long)(program & 0xFFF) << 44)
+            | ((unsigned long long)(material & 0xFFFFF) << 24)
+            | depthBits;
+    }
+
+    unsigned int RenderQueue::GetProgram(unsigned long long key) {
+        return (unsigned int)((key >> 44) & 0xFFF);
+    }
+
+    unsigned int RenderQueue::GetMaterial(unsigned long long key) {
+        return (unsigned int)((key >> 24) & 0xFFFFF);
+    }
+
+    void RenderQueue::Clear() {
+        entries.clear();
+    }
+
+    //payload is an index into the caller's draw array
+    void RenderQueue::Push(unsigned long long key, int payload) {
+
+        Entry entry;
+        entry.key = key;
+        entry.payload = payload;
+        entries.push_back(entry);
+    }
+
+    //least significant digit radix sort, 8 bits per pass, passes where every key has the same digit are skipped
+    void RenderQueue::Sort() {
+
+        size_t count = entries.size();
+        if (count < 2)
+            return;
+
+        scratch.resize(count);
+        for (int shift = 0; shift < 64; shift += 8) {
+
+            size_t histogram[256] = { 0 };
+            for (size_t i = 0; i < count; i++)
+                histogram[(entries[i].key >> shift) & 0xFF]++;
+
+            if (histogram[(entries[0].key >> shift) & 0xFF] == count)
+                continue;
+
+            size_t offset = 0;
+            for (int digit = 0; digit < 256; digit++) {
+                size_t digitCount = histogram[digit];
+                histogram[digit] = offset;
+                offset += digitCount;
+            }
+
+            //stable scatter keeps the order of the lower digits
+            for (size_t i = 0; i < count; i++)
+                scratch[histogram[(entries[i].key >> shift) & 0xFF]++] = entries[i];
+
+            entries.swap(scratch);
+        }
+    }
+
+    int RenderQueue::GetSize() {
+        return (int)entries.size();
+    }
+
+    unsigned long long RenderQueue::GetKey(int index) {
+        return entries[index].key;
+    }
+
+    int RenderQueue::GetPayload(int index) {
+        return entries[index].payload;
+    }
+}
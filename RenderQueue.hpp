@@ -0,0 +1,48 @@
+#ifndef RenderQueue_hpp
+#define RenderQueue_hpp
+
+#include <cstddef>
+#include <vector>
+
+namespace gps {
+
+    //state changes a sequence of draws causes
+    struct RenderQueueStats {
+        int draws;
+        int programChanges;
+        int materialChanges;
+        int meshChanges;
+    };
+
+    //draws ordered by a 64 bit key, most significant bits first:
+    //  8 bits pass | 12 bits program | 20 bits material | 24 bits quantized depth
+    //so draws are grouped by pass, then program, then texture set, and go front to back inside a group
+    class RenderQueue {
+
+    public:
+        static unsigned long long MakeKey(unsigned int pass, unsigned int program, unsigned int material, float depth);
+        static unsigned int GetProgram(unsigned long long key);
+        static unsigned int GetMaterial(unsigned long long key);
+
+        void Clear();
+        //payload is an index into the caller's draw array
+        void Push(unsigned long long key, int payload);
+        //least significant digit radix sort, 8 bits per pass, passes where every key has the same digit are skipped
+        void Sort();
+
+        int GetSize();
+        unsigned long long GetKey(int index);
+        int GetPayload(int index);
+
+    private:
+        struct Entry {
+            unsigned long long key;
+            int payload;
+        };
+
+        std::vector<Entry> entries;
+        std::vector<Entry> scratch;
+    };
+}
+
+#endif /* RenderQueue_hpp */
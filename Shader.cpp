@@ -7,8 +7,25 @@
 //
 
 #include "Shader.hpp"
+#include "ProgramCache.hpp"
+
+#include <chrono>
+#include <map>
 
 namespace gps {
+
+    gps::ProgramCache* Shader::programCache = NULL;
+    bool Shader::parallelCompile = false;
+
+    //programs submitted to the driver whose status has not been checked yet
+    //kept by program id, the Shader objects are passed around by value
+    struct PendingProgram {
+        std::string name;
+        std::vector<GLuint> shaders;
+        std::vector<std::string> sources;
+    };
+    static std::map<GLuint, PendingProgram> pendingPrograms;
+
     std::string Shader::readShaderFile(std::string fileName) {
 
         std::ifstream shaderFile;
@@ -30,7 +47,7 @@ namespace gps {
         return shaderString;
     }
     
-    void Shader::shaderCompileLog(GLuint shaderId) {
+    void Shader::shaderCompileLog(GLuint shaderId, std::string name) {
 
         GLint success;
         GLchar infoLog[512];
@@ -41,11 +58,11 @@ namespace gps {
         if(!success) {
 
             glGetShaderInfoLog(shaderId, 512, NULL, infoLog);
-            std::cout << "Shader compilation error\n" << infoLog << std::endl;
+            std::cout << "Shader compilation error in " << name << "\n" << infoLog << std::endl;
         }
     }
     
-    void Shader::shaderLinkLog(GLuint shaderProgramId) {
+    void Shader::shaderLinkLog(GLuint shaderProgramId, std::string name) {
 
         GLint success;
         GLchar infoLog[512];
@@ -53,47 +70,194 @@ namespace gps {
         //check linking info
         glGetProgramiv(shaderProgramId, GL_LINK_STATUS, &success);
         if(!success) {
-            glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-            std::cout << "Shader linking error\n" << infoLog << std::endl;
+            glGetProgramInfoLog(shaderProgramId, 512, NULL, infoLog);
+            std::cout << "Shader linking error in " << name << "\n" << infoLog << std::endl;
         }
     }
     
-    void Shader::loadShader(std::string vertexShaderFileName, std::string fragmentShaderFileName) {
-
-        //read, parse and compile the vertex shader
-        std::string v = readShaderFile(vertexShaderFileName);
-        const GLchar* vertexShaderString = v.c_str();
-        GLuint vertexShader;
-        vertexShader = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertexShader, 1, &vertexShaderString, NULL);
-        glCompileShader(vertexShader);
-        //check compilation status
-        shaderCompileLog(vertexShader);
-        
-        //read, parse and compile the vertex shader
-        std::string f = readShaderFile(fragmentShaderFileName);
-        const GLchar* fragmentShaderString = f.c_str();
-        GLuint fragmentShader;
-        fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragmentShader, 1, &fragmentShaderString, NULL);
-        glCompileShader(fragmentShader);
-        //check compilation status
-        shaderCompileLog(fragmentShader);
-        
-        //attach and link the shader programs
+    //resolve #include "file" relative to the including file and add the defines
+    std::string Shader::preprocessShaderFile(std::string fileName, const std::vector<std::string>& defines, int includeDepth) {
+
+        //includes nested this deep are most likely a cycle
+        if (includeDepth > 16) {
+            std::cout << "Shader include depth exceeded in " << fileName << std::endl;
+            return "";
+        }
+
+        std::string directory;
+        size_t slash = fileName.find_last_of("/\\");
+        if (slash != std::string::npos)
+            directory = fileName.substr(0, slash + 1);
+
+        std::stringstream source(readShaderFile(fileName));
+        std::stringstream output;
+        std::string line;
+        int lineNumber = 0;
+        while (std::getline(source, line)) {
+
+            lineNumber++;
+            size_t first = line.find_first_not_of(" \t");
+            std::string directive = first == std::string::npos ? "" : line.substr(first);
+
+            if (directive.compare(0, 8, "#include") == 0) {
+
+                size_t open = directive.find('"');
+                size_t close = directive.find('"', open + 1);
+                if (open == std::string::npos || close == std::string::npos) {
+                    std::cout << "Malformed #include in " << fileName << " (" << lineNumber << ")" << std::endl;
+                    continue;
+                }
+
+                //compiler messages give the line in the included file, then in this one again
+                output << "#line 1\n";
+                output << preprocessShaderFile(directory + directive.substr(open + 1, close - open - 1), std::vector<std::string>(), includeDepth + 1);
+                output << "#line " << lineNumber + 1 << "\n";
+                continue;
+            }
+
+            output << line << "\n";
+            if (directive.compare(0, 8, "#version") == 0) {
+
+                for (size_t d = 0; d < defines.size(); d++)
+                    output << "#define " << defines[d] << "\n";
+                output << "#line " << lineNumber + 1 << "\n";
+            }
+        }
+
+        return output.str();
+    }
+
+    //the status is checked later in finishLoading, asking now would wait for the driver
+    GLuint Shader::compileShader(GLenum type, const std::string& source) {
+
+        const GLchar* shaderString = source.c_str();
+        GLuint shader = glCreateShader(type);
+        glShaderSource(shader, 1, &shaderString, NULL);
+        glCompileShader(shader);
+
+        return shader;
+    }
+
+    void Shader::buildProgram(std::string name, const std::vector<GLenum>& types, const std::vector<std::string>& sources) {
+
         this->shaderProgram = glCreateProgram();
-        glAttachShader(this->shaderProgram, vertexShader);
-        glAttachShader(this->shaderProgram, fragmentShader);
+        GPS_GL_LABEL(GL_PROGRAM, this->shaderProgram, name);
+        if (programCache != NULL && programCache->Load(sources, this->shaderProgram))
+            return;
+
+        //attach and link the shader program, a program rejected by glProgramBinary can still be linked
+        PendingProgram& pending = pendingPrograms[this->shaderProgram];
+        pending.name = name;
+        pending.sources = sources;
+        for (size_t i = 0; i < types.size(); i++) {
+            pending.shaders.push_back(compileShader(types[i], sources[i]));
+            glAttachShader(this->shaderProgram, pending.shaders[i]);
+        }
+        if (programCache != NULL)
+            glProgramParameteri(this->shaderProgram, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
         glLinkProgram(this->shaderProgram);
-        glDeleteShader(vertexShader);
-        glDeleteShader(fragmentShader);
-        //check linking info
-        shaderLinkLog(this->shaderProgram);
+    }
+    
+    void Shader::loadShader(std::string vertexShaderFileName, std::string fragmentShaderFileName, const std::vector<std::string>& defines) {
+
+        std::vector<GLenum> types;
+        std::vector<std::string> sources;
+        types.push_back(GL_VERTEX_SHADER);
+        sources.push_back(preprocessShaderFile(vertexShaderFileName, defines));
+        types.push_back(GL_FRAGMENT_SHADER);
+        sources.push_back(preprocessShaderFile(fragmentShaderFileName, defines));
+
+        buildProgram(vertexShaderFileName + " + " + fragmentShaderFileName, types, sources);
+    }
+
+    //program without a fragment stage, for passes that only write depth
+    void Shader::loadShader(std::string vertexShaderFileName, const std::vector<std::string>& defines) {
+
+        std::vector<GLenum> types;
+        std::vector<std::string> sources;
+        types.push_back(GL_VERTEX_SHADER);
+        sources.push_back(preprocessShaderFile(vertexShaderFileName, defines));
+
+        buildProgram(vertexShaderFileName, types, sources);
     }
     
     void Shader::useShaderProgram() {
 
+        if (pendingPrograms.count(this->shaderProgram) != 0) {
+
+            //without the extension there is nothing to wait for, linking just finishes here
+            if (!parallelCompile || isReady()) {
+                finishLoading();
+            }
+            else {
+                //the first draw has to wait for the driver, worth knowing at startup
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                std::string name = pendingPrograms[this->shaderProgram].name;
+                finishLoading();
+                double waited = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                std::cout << "Shader stall: " << name << " was not ready at first use, waited " << waited << " ms" << std::endl;
+            }
+        }
+
         glUseProgram(this->shaderProgram);
     }
 
+    bool Shader::isReady() {
+
+        if (pendingPrograms.count(this->shaderProgram) == 0)
+            return true;
+        //without the extension there is no way to ask, the status query blocks
+        if (!parallelCompile)
+            return false;
+
+        GLint completed = GL_FALSE;
+        glGetProgramiv(this->shaderProgram, GL_COMPLETION_STATUS_KHR, &completed);
+        return completed == GL_TRUE;
+    }
+
+    void Shader::finishLoading() {
+
+        std::map<GLuint, PendingProgram>::iterator found = pendingPrograms.find(this->shaderProgram);
+        if (found == pendingPrograms.end())
+            return;
+
+        PendingProgram& pending = found->second;
+        for (size_t i = 0; i < pending.shaders.size(); i++) {
+            //check compilation status
+            shaderCompileLog(pending.shaders[i], pending.name);
+            glDetachShader(this->shaderProgram, pending.shaders[i]);
+            glDeleteShader(pending.shaders[i]);
+        }
+        //check linking info
+        shaderLinkLog(this->shaderProgram, pending.name);
+
+        GLint success = GL_FALSE;
+        glGetProgramiv(this->shaderProgram, GL_LINK_STATUS, &success);
+        if (programCache != NULL && success)
+            programCache->Store(pending.sources, this->shaderProgram);
+
+        pendingPrograms.erase(found);
+    }
+
+    void Shader::EnableParallelCompile() {
+
+#if !defined (__APPLE__)
+        //let the driver pick the number of compiler threads
+        if (GLEW_KHR_parallel_shader_compile) {
+            glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+            parallelCompile = true;
+        }
+        else if (GLEW_ARB_parallel_shader_compile) {
+            glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+            parallelCompile = true;
+        }
+#endif
+        std::cout << "Parallel shader compilation " << (parallelCompile ? "enabled" : "not available") << std::endl;
+    }
+
+    void Shader::SetProgramCache(gps::ProgramCache* cache) {
+
+        programCache = cache;
+    }
+
 }
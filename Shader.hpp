@@ -17,24 +17,52 @@
     #include <GL/glew.h>
 #endif
 
+#include "GLDebug.hpp"
+#include "GLIntercept.hpp"
+
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <string>
+#include <vector>
 
 
 namespace gps {
+
+    class ProgramCache;
     
     class Shader {
 
     public:
         GLuint shaderProgram;
-        void loadShader(std::string vertexShaderFileName, std::string fragmentShaderFileName);
+        //defines - "NAME" or "NAME VALUE", inserted after the #version line of both stages
+        void loadShader(std::string vertexShaderFileName, std::string fragmentShaderFileName,
+            const std::vector<std::string>& defines = std::vector<std::string>());
+        //program without a fragment stage, for passes that only write depth
+        void loadShader(std::string vertexShaderFileName, const std::vector<std::string>& defines = std::vector<std::string>());
+        //waits for a program still being compiled and reports the stall
         void useShaderProgram();
+        //false while the driver is still compiling, never blocks with KHR_parallel_shader_compile
+        bool isReady();
+        //checks the compile and link status, blocks until the driver is done
+        void finishLoading();
+        //GL thread only, after the context is created; loadShader then only submits the work
+        static void EnableParallelCompile();
+        //programs are looked up in the cache before compiling and stored after linking, NULL disables it
+        static void SetProgramCache(gps::ProgramCache* cache);
     
     private:
+        static gps::ProgramCache* programCache;
+        static bool parallelCompile;
+
         std::string readShaderFile(std::string fileName);
-        void shaderCompileLog(GLuint shaderId);
-        void shaderLinkLog(GLuint shaderProgramId);
+        //resolve #include "file" relative to the including file and add the defines
+        std::string preprocessShaderFile(std::string fileName, const std::vector<std::string>& defines, int includeDepth = 0);
+        GLuint compileShader(GLenum type, const std::string& source);
+        //one preprocessed source per stage, in the order of the types
+        void buildProgram(std::string name, const std::vector<GLenum>& types, const std::vector<std::string>& sources);
+        void shaderCompileLog(GLuint shaderId, std::string name);
+        void shaderLinkLog(GLuint shaderProgramId, std::string name);
     };
     
 }
@@ -0,0 +1,54 @@
+#include "ShaderPermutations.hpp"
+
+namespace gps {
+
+    //the feature bits use the low byte, the point light count the rest of the key
+    const int FEATURE_BITS = 8;
+
+    void ShaderPermutations::Init(std::string vertexShaderFileName, std::string fragmentShaderFileName) {
+
+        this->vertexShaderFileName = vertexShaderFileName;
+        this->fragmentShaderFileName = fragmentShaderFileName;
+    }
+
+    unsigned int ShaderPermutations::MakeKey(unsigned int features, int numPointLights) {
+
+        return (features & ((1u << FEATURE_BITS) - 1)) | ((unsigned int)numPointLights << FEATURE_BITS);
+    }
+
+    std::vector<std::string> ShaderPermutations::MakeDefines(unsigned int key) {
+
+        std::vector<std::string> defines;
+        if (key & SHADER_SHADOWS)
+            defines.push_back("SHADOWS");
+        if (key & SHADER_FOG)
+            defines.push_back("FOG");
+        defines.push_back("NUM_POINT_LIGHTS " + std::to_string(key >> FEATURE_BITS));
+
+        return defines;
+    }
+
+    //GL thread only, compiles the permutation if it is not cached yet
+    gps::Shader& ShaderPermutations::Get(unsigned int features, int numPointLights) {
+
+        unsigned int key = MakeKey(features, numPointLights);
+        std::map<unsigned int, gps::Shader>::iterator found = permutations.find(key);
+        if (found != permutations.end())
+            return found->second;
+
+        gps::Shader& shader = permutations[key];
+        shader.loadShader(vertexShaderFileName, fragmentShaderFileName, MakeDefines(key));
+        return shader;
+    }
+
+    int ShaderPermutations::GetCount() {
+        return (int)permutations.size();
+    }
+
+    void ShaderPermutations::Delete() {
+
+        for (std::map<unsigned int, gps::Shader>::iterator it = permutations.begin(); it != permutations.end(); ++it)
+            glDeleteProgram(it->second.shaderProgram);
+        permutations.clear();
+    }
+}
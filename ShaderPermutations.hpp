@@ -0,0 +1,39 @@
+#ifndef ShaderPermutations_hpp
+#define ShaderPermutations_hpp
+
+#include "Shader.hpp"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace gps {
+
+    //optional features compiled into a shader permutation
+    enum SHADER_FEATURE {
+        SHADER_SHADOWS = 1 << 0,
+        SHADER_FOG = 1 << 1
+    };
+
+    //the variants of one vertex/fragment pair, compiled when first asked for and cached by key
+    //the key packs the SHADER_FEATURE bits and the number of point lights shaded per cluster
+    class ShaderPermutations {
+
+    public:
+        void Init(std::string vertexShaderFileName, std::string fragmentShaderFileName);
+        static unsigned int MakeKey(unsigned int features, int numPointLights);
+        //GL thread only, compiles the permutation if it is not cached yet, so ask for the reachable ones at startup
+        gps::Shader& Get(unsigned int features, int numPointLights);
+        int GetCount();
+        void Delete();
+
+    private:
+        std::string vertexShaderFileName;
+        std::string fragmentShaderFileName;
+        std::map<unsigned int, gps::Shader> permutations;
+
+        static std::vector<std::string> MakeDefines(unsigned int key);
+    };
+}
+
+#endif /* ShaderPermutations_hpp */
@@ -0,0 +1,69 @@
+#include "SimulationClock.hpp"
+
+namespace gps {
+
+    SimulationClock::SimulationClock(double fixedTimeStep, int maxStepsPerFrame) {
+        this->fixedTimeStep = fixedTimeStep;
+        this->maxStepsPerFrame = maxStepsPerFrame;
+    }
+
+    //add elapsed real time and return the number of fixed steps to simulate
+    int SimulationClock::Advance(double realDeltaTime) {
+
+        if (paused || realDeltaTime <= 0.0)
+            return 0;
+
+        accumulator += realDeltaTime * timeScale;
+
+        int steps = 0;
+        while (accumulator >= fixedTimeStep && steps < maxStepsPerFrame) {
+            accumulator -= fixedTimeStep;
+            steps++;
+        }
+
+        //after a long stall drop the backlog instead of trying to catch up
+        if (steps == maxStepsPerFrame && accumulator >= fixedTimeStep)
+            accumulator = 0.0;
+
+        simulationTime += steps * fixedTimeStep;
+        stepCount += steps;
+        return steps;
+    }
+
+    //fraction of a step left in the accumulator, used to blend the last two states
+    float SimulationClock::GetInterpolationFactor() {
+        return (float)(accumulator / fixedTimeStep);
+    }
+
+    double SimulationClock::GetFixedTimeStep() {
+        return fixedTimeStep;
+    }
+
+    double SimulationClock::GetSimulationTime() {
+        return simulationTime;
+    }
+
+    long long SimulationClock::GetStepCount() {
+        return stepCount;
+    }
+
+    void SimulationClock::SetTimeScale(double timeScale) {
+        this->timeScale = timeScale < 0.0 ? 0.0 : timeScale;
+    }
+
+    double SimulationClock::GetTimeScale() {
+        return timeScale;
+    }
+
+    void SimulationClock::SetPaused(bool paused) {
+        this->paused = paused;
+    }
+
+    void SimulationClock::TogglePause() {
+        paused = !paused;
+    }
+
+    bool SimulationClock::IsPaused() {
+        return paused;
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef SimulationClock_hpp
+#define SimulationClock_hpp
+
+namespace gps {
+
+    //fixed timestep clock: real time is accumulated (scaled, unless paused)
+    //and consumed in whole simulation steps, the remainder is used to interpolate
+    class SimulationClock {
+
+    public:
+        SimulationClock(double fixedTimeStep = 1.0 / 60.0, int maxStepsPerFrame = 8);
+        //add elapsed real time and return the number of fixed steps to simulate
+        int Advance(double realDeltaTime);
+        //fraction of a step left in the accumulator, used to blend the last two states
+        float GetInterpolationFactor();
+        double GetFixedTimeStep();
+        //simulated seconds since start
+        double GetSimulationTime();
+        long long GetStepCount();
+
+        void SetTimeScale(double timeScale);
+        double GetTimeScale();
+        void SetPaused(bool paused);
+        void TogglePause();
+        bool IsPaused();
+
+    private:
+        double fixedTimeStep;
+        int maxStepsPerFrame;
+        double accumulator = 0.0;
+        double simulationTime = 0.0;
+        long long stepCount = 0;
+        double timeScale = 1.0;
+        bool paused = false;
+    };
+}
+
+#endif /* SimulationClock_hpp */
@@ -7,6 +7,8 @@
 //
 
 #include "SkyBox.hpp"
+#include "GpuMemory.hpp"
+#include "Profiler.hpp"
 
 namespace gps {
     
@@ -21,7 +23,7 @@ namespace gps {
         InitSkyBox();
     }
     
-    void SkyBox::Draw(gps::Shader shader, glm::mat4 viewMatrix, glm::mat4 projectionMatrix)
+    void SkyBox::Draw(gps::Shader& shader, const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix)
     {
         shader.useShaderProgram();
         
@@ -44,6 +46,7 @@ namespace gps {
     
     GLuint SkyBox::LoadSkyBoxTextures(std::vector<const GLchar*> skyBoxFaces)
     {
+        GPS_PROFILE_FUNCTION();
         GLuint textureID;
         glGenTextures(1, &textureID);
         glActiveTexture(GL_TEXTURE0);
@@ -70,6 +73,8 @@ namespace gps {
         glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
         glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
         glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+        GPS_GL_LABEL(GL_TEXTURE, textureID, std::string("skybox ") + skyBoxFaces[0]);
+        GpuMemory::Track(GPU_MEMORY_TEXTURE, textureID, GpuMemory::ImageBytes(width, height, 6, GL_RGB, false));
         glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
         
         return textureID;
@@ -125,8 +130,10 @@ namespace gps {
         glGenBuffers(1, &skyboxVBO);
         
         glBindVertexArray(skyboxVAO);
+        GPS_GL_LABEL(GL_VERTEX_ARRAY, skyboxVAO, "skybox cube");
         glBindBuffer(GL_ARRAY_BUFFER, skyboxVBO);
         glBufferData(GL_ARRAY_BUFFER, sizeof(skyboxVertices), &skyboxVertices, GL_STATIC_DRAW);
+        GpuMemory::Track(GPU_MEMORY_BUFFER, skyboxVBO, sizeof(skyboxVertices));
         
         glEnableVertexAttribArray(0);
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), (GLvoid*)0);
@@ -0,0 +1,259 @@
+#include "TransformStore.hpp"
+
+#if defined (__SSE__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 1)
+    #define GPS_TRANSFORM_SSE
+    #include <xmmintrin.h>
+#endif
+
+namespace gps {
+
+    Entity TransformStore::Create(Entity parent) {
+
+        positionX.push_back(0.0f);
+        positionY.push_back(0.0f);
+        positionZ.push_back(0.0f);
+        rotationX.push_back(0.0f);
+        rotationY.push_back(0.0f);
+        rotationZ.push_back(0.0f);
+        rotationW.push_back(1.0f);
+        scaleX.push_back(1.0f);
+        scaleY.push_back(1.0f);
+        scaleZ.push_back(1.0f);
+        parents.push_back(parent);
+        dirty.push_back(1);
+
+        localMatrices.push_back(glm::mat4(1.0f));
+        worldMatrices.push_back(glm::mat4(1.0f));
+        normalMatrices.push_back(glm::mat3(1.0f));
+
+        return (Entity)parents.size() - 1;
+    }
+
+    int TransformStore::GetCount() {
+        return (int)parents.size();
+    }
+
+    //setters only mark the entity dirty when the value actually changes
+    void TransformStore::SetPosition(Entity entity, glm::vec3 position) {
+
+        if (positionX[entity] == position.x && positionY[entity] == position.y && positionZ[entity] == position.z)
+            return;
+
+        positionX[entity] = position.x;
+        positionY[entity] = position.y;
+        positionZ[entity] = position.z;
+        dirty[entity] = 1;
+    }
+
+    void TransformStore::SetRotation(Entity entity, glm::quat rotation) {
+
+        if (rotationX[entity] == rotation.x && rotationY[entity] == rotation.y
+            && rotationZ[entity] == rotation.z && rotationW[entity] == rotation.w)
+            return;
+
+        rotationX[entity] = rotation.x;
+        rotationY[entity] = rotation.y;
+        rotationZ[entity] = rotation.z;
+        rotationW[entity] = rotation.w;
+        dirty[entity] = 1;
+    }
+
+    void TransformStore::SetScale(Entity entity, glm::vec3 scale) {
+
+        if (scaleX[entity] == scale.x && scaleY[entity] == scale.y && scaleZ[entity] == scale.z)
+            return;
+
+        scaleX[entity] = scale.x;
+        scaleY[entity] = scale.y;
+        scaleZ[entity] = scale.z;
+        dirty[entity] = 1;
+    }
+
+    //recompute the world and normal matrices of the changed entities and their descendants
+    int TransformStore::Update() {
+
+        //parents come first, so a child sees the final state of its parent
+        changed.clear();
+        for (Entity e = 0; e < (Entity)parents.size(); e++) {
+
+            if (parents[e] != NO_PARENT && dirty[parents[e]])
+                dirty[e] = 1;
+            if (dirty[e])
+                changed.push_back(e);
+        }
+
+        ComputeLocalMatrices();
+        ComputeWorldMatrices();
+        ComputeNormalMatrices();
+
+        for (size_t i = 0; i < changed.size(); i++)
+            dirty[changed[i]] = 0;
+
+        return (int)changed.size();
+    }
+
+    //translation * rotation * scale of the changed entities, four at a time
+    void TransformStore::ComputeLocalMatrices() {
+
+        size_t i = 0;
+#if defined (GPS_TRANSFORM_SSE)
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 two = _mm_set1_ps(2.0f);
+        for (; i + 4 <= changed.size(); i += 4) {
+
+            Entity e0 = changed[i], e1 = changed[i + 1], e2 = changed[i + 2], e3 = changed[i + 3];
+            __m128 qx = _mm_set_ps(rotationX[e3], rotationX[e2], rotationX[e1], rotationX[e0]);
+            __m128 qy = _mm_set_ps(rotationY[e3], rotationY[e2], rotationY[e1], rotationY[e0]);
+            __m128 qz = _mm_set_ps(rotationZ[e3], rotationZ[e2], rotationZ[e1], rotationZ[e0]);
+            __m128 qw = _mm_set_ps(rotationW[e3], rotationW[e2], rotationW[e1], rotationW[e0]);
+            __m128 sx = _mm_set_ps(scaleX[e3], scaleX[e2], scaleX[e1], scaleX[e0]);
+            __m128 sy = _mm_set_ps(scaleY[e3], scaleY[e2], scaleY[e1], scaleY[e0]);
+            __m128 sz = _mm_set_ps(scaleZ[e3], scaleZ[e2], scaleZ[e1], scaleZ[e0]);
+
+            __m128 xx = _mm_mul_ps(qx, qx), yy = _mm_mul_ps(qy, qy), zz = _mm_mul_ps(qz, qz);
+            __m128 xy = _mm_mul_ps(qx, qy), xz = _mm_mul_ps(qx, qz), yz = _mm_mul_ps(qy, qz);
+            __m128 wx = _mm_mul_ps(qw, qx), wy = _mm_mul_ps(qw, qy), wz = _mm_mul_ps(qw, qz);
+
+            //rotation columns scaled by the per axis scale
+            __m128 m00 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx);
+            __m128 m01 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sx);
+            __m128 m02 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sx);
+            __m128 m10 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sy);
+            __m128 m11 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy);
+            __m128 m12 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sy);
+            __m128 m20 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sz);
+            __m128 m21 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sz);
+            __m128 m22 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz);
+
+            float c00[4], c01[4], c02[4], c10[4], c11[4], c12[4], c20[4], c21[4], c22[4];
+            _mm_storeu_ps(c00, m00); _mm_storeu_ps(c01, m01); _mm_storeu_ps(c02, m02);
+            _mm_storeu_ps(c10, m10); _mm_storeu_ps(c11, m11); _mm_storeu_ps(c12, m12);
+            _mm_storeu_ps(c20, m20); _mm_storeu_ps(c21, m21); _mm_storeu_ps(c22, m22);
+
+            Entity lanes[4] = { e0, e1, e2, e3 };
+            for (int lane = 0; lane < 4; lane++) {
+
+                Entity e = lanes[lane];
+                glm::mat4& local = localMatrices[e];
+                local[0] = glm::vec4(c00[lane], c01[lane], c02[lane], 0.0f);
+                local[1] = glm::vec4(c10[lane], c11[lane], c12[lane], 0.0f);
+                local[2] = glm::vec4(c20[lane], c21[lane], c22[lane], 0.0f);
+                local[3] = glm::vec4(positionX[e], positionY[e], positionZ[e], 1.0f);
+            }
+        }
+#endif
+        for (; i < changed.size(); i++)
+            ComputeLocalMatrix(changed[i]);
+    }
+
+    void TransformStore::ComputeLocalMatrix(Entity e) {
+
+        float x = rotationX[e], y = rotationY[e], z = rotationZ[e], w = rotationW[e];
+        glm::mat4& local = localMatrices[e];
+        local[0] = glm::vec4(1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y + w * z), 2.0f * (x * z - w * y), 0.0f) * scaleX[e];
+        local[1] = glm::vec4(2.0f * (x * y - w * z), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z + w * x), 0.0f) * scaleY[e];
+        local[2] = glm::vec4(2.0f * (x * z + w * y), 2.0f * (y * z - w * x), 1.0f - 2.0f * (x * x + y * y), 0.0f) * scaleZ[e];
+        local[3] = glm::vec4(positionX[e], positionY[e], positionZ[e], 1.0f);
+    }
+
+    //world = parent world * local, in index order so parents are always done first
+    void TransformStore::ComputeWorldMatrices() {
+
+        for (size_t i = 0; i < changed.size(); i++) {
+
+            Entity e = changed[i];
+            if (parents[e] == NO_PARENT) {
+                worldMatrices[e] = localMatrices[e];
+                continue;
+            }
+
+#if defined (GPS_TRANSFORM_SSE)
+            //each world column is the parent columns weighted by one local column
+            const float* parent = &worldMatrices[parents[e]][0][0];
+            const float* local = &localMatrices[e][0][0];
+            float* world = &worldMatrices[e][0][0];
+            __m128 p0 = _mm_loadu_ps(parent);
+            __m128 p1 = _mm_loadu_ps(parent + 4);
+            __m128 p2 = _mm_loadu_ps(parent + 8);
+            __m128 p3 = _mm_loadu_ps(parent + 12);
+            for (int c = 0; c < 4; c++) {
+
+                __m128 column = _mm_mul_ps(p0, _mm_set1_ps(local[c * 4 + 0]));
+                column = _mm_add_ps(column, _mm_mul_ps(p1, _mm_set1_ps(local[c * 4 + 1])));
+                column = _mm_add_ps(column, _mm_mul_ps(p2, _mm_set1_ps(local[c * 4 + 2])));
+                column = _mm_add_ps(column, _mm_mul_ps(p3, _mm_set1_ps(local[c * 4 + 3])));
+                _mm_storeu_ps(world + c * 4, column);
+            }
+#else
+            worldMatrices[e] = worldMatrices[parents[e]] * localMatrices[e];
+#endif
+        }
+    }
+
+    //inverse transpose of the upper 3x3 as cofactors over the determinant, four entities at a time
+    void TransformStore::ComputeNormalMatrices() {
+
+        size_t i = 0;
+#if defined (GPS_TRANSFORM_SSE)
+        for (; i + 4 <= changed.size(); i += 4) {
+
+            const glm::mat4* w[4] = { &worldMatrices[changed[i]], &worldMatrices[changed[i + 1]],
+                &worldMatrices[changed[i + 2]], &worldMatrices[changed[i + 3]] };
+
+            //a[c][r] holds element (column c, row r) of the four matrices
+            __m128 a[3][3];
+            for (int c = 0; c < 3; c++) {
+                for (int r = 0; r < 3; r++)
+                    a[c][r] = _mm_set_ps((*w[3])[c][r], (*w[2])[c][r], (*w[1])[c][r], (*w[0])[c][r]);
+            }
+
+            //cofactor columns: cross(a1, a2), cross(a2, a0), cross(a0, a1)
+            __m128 cof[3][3];
+            for (int c = 0; c < 3; c++) {
+
+                int c1 = (c + 1) % 3, c2 = (c + 2) % 3;
+                cof[c][0] = _mm_sub_ps(_mm_mul_ps(a[c1][1], a[c2][2]), _mm_mul_ps(a[c1][2], a[c2][1]));
+                cof[c][1] = _mm_sub_ps(_mm_mul_ps(a[c1][2], a[c2][0]), _mm_mul_ps(a[c1][0], a[c2][2]));
+                cof[c][2] = _mm_sub_ps(_mm_mul_ps(a[c1][0], a[c2][1]), _mm_mul_ps(a[c1][1], a[c2][0]));
+            }
+
+            __m128 determinant = _mm_add_ps(_mm_add_ps(
+                _mm_mul_ps(a[0][0], cof[0][0]), _mm_mul_ps(a[0][1], cof[0][1])), _mm_mul_ps(a[0][2], cof[0][2]));
+            __m128 inverseDeterminant = _mm_div_ps(_mm_set1_ps(1.0f), determinant);
+
+            float values[3][3][4];
+            for (int c = 0; c < 3; c++) {
+                for (int r = 0; r < 3; r++)
+                    _mm_storeu_ps(values[c][r], _mm_mul_ps(cof[c][r], inverseDeterminant));
+            }
+
+            for (int lane = 0; lane < 4; lane++) {
+
+                glm::mat3& normal = normalMatrices[changed[i + lane]];
+                for (int c = 0; c < 3; c++)
+                    normal[c] = glm::vec3(values[c][0][lane], values[c][1][lane], values[c][2][lane]);
+            }
+        }
+#endif
+        for (; i < changed.size(); i++)
+            ComputeNormalMatrix(changed[i]);
+    }
+
+    void TransformStore::ComputeNormalMatrix(Entity e) {
+
+        glm::mat3 upper = glm::mat3(worldMatrices[e]);
+        glm::mat3 cofactors(glm::cross(upper[1], upper[2]), glm::cross(upper[2], upper[0]), glm::cross(upper[0], upper[1]));
+        float determinant = glm::dot(upper[0], cofactors[0]);
+        for (int c = 0; c < 3; c++)
+            normalMatrices[e][c] = cofactors[c] / determinant;
+    }
+
+    const glm::mat4& TransformStore::GetWorldMatrix(Entity entity) {
+        return worldMatrices[entity];
+    }
+
+    //inverse transpose of the upper 3x3 of the world matrix
+    const glm::mat3& TransformStore::GetNormalMatrix(Entity entity) {
+        return normalMatrices[entity];
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef TransformStore_hpp
+#define TransformStore_hpp
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <vector>
+
+namespace gps {
+
+    typedef int Entity;
+    const Entity NO_PARENT = -1;
+
+    //entity transforms stored as structure of arrays
+    //local translation/rotation/scale live in separate float arrays so the batch kernels
+    //can load four entities per SIMD register, world and normal matrices are cached
+    //parents have to be created before their children, so one forward sweep propagates changes
+    class TransformStore {
+
+    public:
+        Entity Create(Entity parent = NO_PARENT);
+        int GetCount();
+
+        //setters only mark the entity dirty when the value actually changes
+        void SetPosition(Entity entity, glm::vec3 position);
+        void SetRotation(Entity entity, glm::quat rotation);
+        void SetScale(Entity entity, glm::vec3 scale);
+
+        //recompute the world and normal matrices of the changed entities and their descendants
+        //returns the number of entities recomputed
+        int Update();
+
+        const glm::mat4& GetWorldMatrix(Entity entity);
+        //inverse transpose of the upper 3x3 of the world matrix
+        const glm::mat3& GetNormalMatrix(Entity entity);
+
+    private:
+        std::vector<float> positionX, positionY, positionZ;
+        std::vector<float> rotationX, rotationY, rotationZ, rotationW;
+        std::vector<float> scaleX, scaleY, scaleZ;
+        std::vector<Entity> parents;
+        std::vector<unsigned char> dirty;
+
+        std::vector<glm::mat4> localMatrices;
+        std::vector<glm::mat4> worldMatrices;
+        std::vector<glm::mat3> normalMatrices;
+
+        //indices of the entities to recompute this update
+        std::vector<Entity> changed;
+
+        void ComputeLocalMatrices();
+        void ComputeWorldMatrices();
+        void ComputeNormalMatrices();
+        void ComputeLocalMatrix(Entity entity);
+        void ComputeNormalMatrix(Entity entity);
+    };
+}
+
+#endif /* TransformStore_hpp */
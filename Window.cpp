@@ -1,8 +1,17 @@
 #include "Window.h"
+#include "GpuMemory.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <vector>
 
 namespace gps {
 
     void Window::Create(int width, int height, const char *title) {
+#if defined (GPS_HEADLESS)
+        CreateHeadless(width, height);
+#else
         if (!glfwInit()) {
             throw std::runtime_error("Could not start GLFW3!");
         }
@@ -22,6 +31,11 @@ namespace gps {
         //for antialising
         glfwWindowHint(GLFW_SAMPLES, 4);
 
+#if defined (GPS_GL_DEBUG)
+        //most drivers only report warnings to debug contexts
+        glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
+#endif
+
         this->window = glfwCreateWindow(width, height, title, NULL, NULL);
         if (!this->window) {
             throw std::runtime_error("Could not create GLFW3 window!");
@@ -37,21 +51,139 @@ namespace gps {
         glewInit();
 #endif
 
+        PrintVersion();
+
+        //for RETINA display
+        glfwGetFramebufferSize(window, &this->dimensions.width, &this->dimensions.height);
+#endif
+    }
+
+#if defined (GPS_HEADLESS)
+    //a surfaceless context where Mesa offers one, otherwise the default display with a tiny pbuffer
+    void Window::CreateHeadless(int width, int height) {
+
+        const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+        if (clientExtensions != NULL && strstr(clientExtensions, "EGL_MESA_platform_surfaceless") != NULL) {
+            PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+                (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+            if (getPlatformDisplay != NULL)
+                display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+        }
+        if (display == EGL_NO_DISPLAY)
+            display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+        EGLint major, minor;
+        if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+            throw std::runtime_error("Could not initialize EGL!");
+        }
+        if (!eglBindAPI(EGL_OPENGL_API)) {
+            throw std::runtime_error("EGL has no desktop OpenGL!");
+        }
+
+        const EGLint configAttributes[] = {
+            EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+            EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+            EGL_RED_SIZE, 8,
+            EGL_GREEN_SIZE, 8,
+            EGL_BLUE_SIZE, 8,
+            EGL_NONE
+        };
+        EGLConfig config;
+        EGLint configCount = 0;
+        if (!eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0) {
+            throw std::runtime_error("Could not find an EGL config!");
+        }
+
+        //the same 4.1 core context the windowed backend asks for
+        const EGLint contextAttributes[] = {
+            EGL_CONTEXT_MAJOR_VERSION, 4,
+            EGL_CONTEXT_MINOR_VERSION, 1,
+            EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+#if defined (GPS_GL_DEBUG)
+            EGL_CONTEXT_OPENGL_DEBUG, EGL_TRUE,
+#endif
+            EGL_NONE
+        };
+        context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+        if (context == EGL_NO_CONTEXT) {
+            throw std::runtime_error("Could not create an EGL context!");
+        }
+
+        const char* displayExtensions = eglQueryString(display, EGL_EXTENSIONS);
+        if (displayExtensions == NULL || strstr(displayExtensions, "EGL_KHR_surfaceless_context") == NULL) {
+            const EGLint surfaceAttributes[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+            surface = eglCreatePbufferSurface(display, config, surfaceAttributes);
+        }
+        if (!eglMakeCurrent(display, surface, surface, context)) {
+            throw std::runtime_error("Could not make the EGL context current!");
+        }
+
+        //glewInit would look for a GLX display, the core entry points are all this needs
+        glewExperimental = GL_TRUE;
+        if (glewContextInit() != GLEW_OK) {
+            throw std::runtime_error("Could not load the OpenGL entry points!");
+        }
+
+        PrintVersion();
+        std::cout << "Headless EGL " << major << "." << minor << ", " << width << "x" << height << std::endl;
+
+        this->dimensions.width = width;
+        this->dimensions.height = height;
+        CreateOffscreenFramebuffer();
+        startTime = std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    //sRGB colour like the window back buffer, without the multisampling
+    void Window::CreateOffscreenFramebuffer() {
+
+        glGenRenderbuffers(1, &colorBuffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_SRGB8_ALPHA8, dimensions.width, dimensions.height);
+        GpuMemory::Track(GPU_MEMORY_RENDERBUFFER, colorBuffer, GpuMemory::ImageBytes(dimensions.width, dimensions.height, 1, GL_SRGB8_ALPHA8, false));
+
+        glGenRenderbuffers(1, &depthBuffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, dimensions.width, dimensions.height);
+        GpuMemory::Track(GPU_MEMORY_RENDERBUFFER, depthBuffer, GpuMemory::ImageBytes(dimensions.width, dimensions.height, 1, GL_DEPTH24_STENCIL8, false));
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+        glGenFramebuffers(1, &framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            throw std::runtime_error("The offscreen framebuffer is incomplete!");
+        }
+        GPS_GL_LABEL(GL_FRAMEBUFFER, framebuffer, "offscreen backbuffer");
+    }
+#endif
+
+    void Window::PrintVersion() {
         // get version info
         const GLubyte* renderer = glGetString(GL_RENDERER); // get renderer string
         const GLubyte* version = glGetString(GL_VERSION); // version as a string
         std::cout << "Renderer: " << renderer << std::endl;
         std::cout << "OpenGL version: " << version << std::endl;
-
-        //for RETINA display
-        glfwGetFramebufferSize(window, &this->dimensions.width, &this->dimensions.height);
     }
 
     void Window::Delete() {
+#if defined (GPS_HEADLESS)
+        glDeleteFramebuffers(1, &framebuffer);
+        GpuMemory::Release(GPU_MEMORY_RENDERBUFFER, colorBuffer);
+        GpuMemory::Release(GPU_MEMORY_RENDERBUFFER, depthBuffer);
+        glDeleteRenderbuffers(1, &colorBuffer);
+        glDeleteRenderbuffers(1, &depthBuffer);
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if (surface != EGL_NO_SURFACE)
+            eglDestroySurface(display, surface);
+        eglDestroyContext(display, context);
+        eglTerminate(display);
+#else
         if (window)
             glfwDestroyWindow(window);
         //close GL context and any other GLFW resources
         glfwTerminate();
+#endif
     }
 
     GLFWwindow* Window::getWindow() {
@@ -65,4 +197,73 @@ namespace gps {
     void Window::setWindowDimensions(WindowDimensions dimensions) {
         this->dimensions = dimensions;
     }
+
+    bool Window::isHeadless() {
+        return this->window == NULL;
+    }
+
+    GLuint Window::getFramebuffer() {
+        return this->framebuffer;
+    }
+
+    //a headless run ends when the application decides so
+    bool Window::shouldClose() {
+#if defined (GPS_HEADLESS)
+        return false;
+#else
+        return glfwWindowShouldClose(this->window);
+#endif
+    }
+
+    void Window::swapBuffers() {
+#if defined (GPS_HEADLESS)
+        glFlush();
+#else
+        glfwSwapBuffers(this->window);
+#endif
+    }
+
+    void Window::pollEvents() {
+#if !defined (GPS_HEADLESS)
+        glfwPollEvents();
+#endif
+    }
+
+    void Window::setVSync(bool enabled) {
+#if !defined (GPS_HEADLESS)
+        glfwSwapInterval(enabled ? 1 : 0);
+#endif
+    }
+
+    double Window::getTime() {
+#if defined (GPS_HEADLESS)
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count() - startTime;
+#else
+        return glfwGetTime();
+#endif
+    }
+
+    bool Window::saveFrame(std::string fileName) {
+
+        int width = this->dimensions.width;
+        int height = this->dimensions.height;
+        std::vector<unsigned char> pixels((size_t)width * height * 3);
+
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, this->framebuffer);
+        glReadBuffer(this->framebuffer != 0 ? GL_COLOR_ATTACHMENT0 : GL_BACK);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+
+        std::ofstream file(fileName, std::ios::binary);
+        if (!file.is_open()) {
+            std::cout << "Could not write " << fileName << std::endl;
+            return false;
+        }
+
+        //GL rows start at the bottom, PPM rows at the top
+        file << "P6\n" << width << " " << height << "\n255\n";
+        for (int row = height - 1; row >= 0; row--)
+            file.write((const char*)&pixels[(size_t)row * width * 3], (std::streamsize)width * 3);
+        return true;
+    }
 }
@@ -9,10 +9,24 @@
     #include <GL/glew.h>
 #endif
 
+#include "GLDebug.hpp"
+#include "GLIntercept.hpp"
+
 #include <GLFW/glfw3.h>
 
+//GPS_HEADLESS builds render without a display through an EGL context (e.g. Mesa llvmpipe)
+//into an offscreen framebuffer, GLFW is only used for the windowed backend
+#if defined (GPS_HEADLESS)
+    #if defined (__APPLE__)
+        #error "GPS_HEADLESS needs EGL, it is not available on macOS"
+    #endif
+    #include <EGL/egl.h>
+    #include <EGL/eglext.h>
+#endif
+
 #include <stdexcept>
 #include <iostream>
+#include <string>
 
 struct WindowDimensions {
     int width;
@@ -27,13 +41,41 @@ namespace gps {
         void Create(int width=800, int height=600, const char *title="OpenGL Project");
         void Delete();
 
+        //NULL for the headless backend
         GLFWwindow* getWindow();
         WindowDimensions getWindowDimensions();
         void setWindowDimensions(WindowDimensions dimensions);
 
+        bool isHeadless();
+        //the framebuffer the frame ends up in, 0 is the window back buffer
+        GLuint getFramebuffer();
+        bool shouldClose();
+        void swapBuffers();
+        void pollEvents();
+        //off for benchmarks, so the swap measures the frame and not the display
+        void setVSync(bool enabled);
+        //seconds since Create
+        double getTime();
+        //binary PPM of the current frame, read back from getFramebuffer
+        bool saveFrame(std::string fileName);
+
     private:
         WindowDimensions dimensions;
-        GLFWwindow *window;
+        GLFWwindow *window = NULL;
+        GLuint framebuffer = 0;
+
+#if defined (GPS_HEADLESS)
+        EGLDisplay display = EGL_NO_DISPLAY;
+        EGLSurface surface = EGL_NO_SURFACE;
+        EGLContext context = EGL_NO_CONTEXT;
+        GLuint colorBuffer = 0;
+        GLuint depthBuffer = 0;
+        double startTime = 0.0;
+
+        void CreateHeadless(int width, int height);
+        void CreateOffscreenFramebuffer();
+#endif
+        void PrintVersion();
     };
 }
 
@@ -6,6 +6,9 @@
     #include <GL/glew.h>
 #endif
 
+#include "GLDebug.hpp"
+#include "GLIntercept.hpp"
+
 #include <GLFW/glfw3.h>
 
 #include <glm/glm.hpp> //core glm functionality
@@ -18,21 +21,35 @@
 #include "Camera.hpp"
 #include "Model3D.hpp"
 #include "SkyBox.hpp"
+#include "CascadedShadowMap.hpp"
+#include "Frustum.hpp"
+#include "RenderGraph.hpp"
+#include "SimulationClock.hpp"
+#include "JobSystem.hpp"
+#include "DrawList.hpp"
+#include "TransformStore.hpp"
+#include "LightClusters.hpp"
+#include "ShaderPermutations.hpp"
+#include "ProgramCache.hpp"
+#include "CameraPath.hpp"
+#include "Benchmark.hpp"
+#include "Profiler.hpp"
+#include "GpuProfiler.hpp"
+#include "GpuMemory.hpp"
+#include "Hud.hpp"
+#include "AllocationTracker.hpp"
 
 #include <iostream>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 
 // window
 gps::Window myWindow;
 
 // matrices
 glm::mat4 model;
-glm::mat4 view;
-glm::mat4 projection;
-glm::mat3 normalMatrix;
-glm::mat4 turretModel;
-glm::mat4 shuttleModel;
-glm::mat4 redLightModel;
-glm::mat4 skyModel;
 
 // light parameters
 glm::vec3 lightDir;
@@ -43,17 +60,18 @@ glm::vec3 redLightPos;
 glm::vec3 lightPos1;
 glm::vec3 lightPos2;
 
+// point lights are binned into view space clusters, basic.frag only loops over its own cluster
+gps::LightClusters lightClusters;
+std::vector<gps::PointLight> pointLights;
+// extra lamps scattered over the base to stress the light clusters
+const int EXTRA_LAMP_COUNT = 256;
+// the two ceiling lights, the red light and the extra lamps
+const int MAX_POINT_LIGHTS = 3 + EXTRA_LAMP_COUNT;
+bool extraLamps = false;
+
 // fog
 glm::vec3 fogColor;
 
-// shader uniform locations
-GLint modelLoc;
-GLint viewLoc;
-GLint projectionLoc;
-GLint normalMatrixLoc;
-GLint lightDirLoc;
-GLint lightColorLoc;
-
 // camera
 gps::Camera myCamera(
     glm::vec3(1.2f, 3.04f, 5.0f),
@@ -72,21 +90,85 @@ gps::Model3D turret2;
 gps::Model3D turret3;
 GLfloat angle;
 GLfloat turretAngle;
+// turrets rotate around these points
+glm::vec3 turretPivots[3] = {
+    glm::vec3(12.811f, 1.7615f, 5.8126f),
+    glm::vec3(-9.7728f, 1.6396f, -3.6212f),
+    glm::vec3(-6.9807f, 1.621f, 17.61f) };
+
+// transforms of the moving parts, turrets hang off the base through their pivots
+gps::TransformStore transforms;
+gps::Entity baseEntity;
+gps::Entity turretPivotEntities[3];
+gps::Entity turretEntities[3];
+gps::Entity shuttleEntity;
+gps::Entity redLightEntity;
+gps::Entity skyEntity;
 
 // shaders
-gps::Shader myBasicShader;
 gps::Shader skyboxShader;
 gps::Shader depthMapShader;
+gps::Shader gbufferShader;
+// the lit shaders are compiled per feature set and point light count
+gps::ShaderPermutations basicShaders;
+gps::ShaderPermutations deferredShaders;
+// linked programs from earlier runs of the same driver
+gps::ProgramCache programCache;
 
 // skybox
 gps::SkyBox mySkyBox;
 
 // shadow
-GLuint shadowMapFBO;
-GLuint depthMapTexture; 
-
-const unsigned int SHADOW_WIDTH = 2048;
-const unsigned int SHADOW_HEIGHT = 2048;
+gps::CascadedShadowMap shadowCascades;
+
+// 3 x 1024^2 cascades fill fewer texels than the old single 2048^2 map
+const int SHADOW_CASCADES = 3;
+const int SHADOW_RESOLUTION = 1024;
+const float SHADOW_DISTANCE = 60.0f;
+// static shadow layer cache: refit after 0.5 degrees of light rotation, at most one cascade per frame
+const float SHADOW_CACHE_ANGLE = 0.5f;
+const float SHADOW_CACHE_MARGIN = 0.25f;
+const int SHADOW_CACHE_UPDATES_PER_FRAME = 1;
+
+// camera projection parameters, also used to fit the shadow cascades
+const float CAMERA_FOV = glm::radians(45.0f);
+const float CAMERA_NEAR = 0.1f;
+const float CAMERA_FAR = 100.0f;
+
+// frame graph
+gps::RenderGraph frameGraph;
+
+// draw lists are built by the job system workers
+gps::JobSystem jobSystem;
+std::vector<gps::Renderable> renderables;
+gps::DrawList mainDrawList;
+gps::DrawList shadowDrawList;
+
+// render pass ids, the top bits of the draw sort keys
+const unsigned int PASS_SHADOW = 0;
+const unsigned int PASS_MAIN = 1;
+const unsigned int PASS_GBUFFER = 2;
+
+// deferred path: the scene goes to a G-buffer and is lit once per pixel by a fullscreen pass
+bool deferredShading = false;
+// the frame graph is rebuilt before the next frame after switching paths
+bool renderGraphDirty = false;
+gps::RenderResource gbufferNormal;
+gps::RenderResource gbufferAlbedo;
+gps::RenderResource gbufferDepth;
+
+// optional depth pre-pass for the forward path, the main pass then shades only the visible fragments
+bool depthPrePass = false;
+gps::DrawList prePassDrawList;
+// samples shaded by the main pass, two queries so the result of the previous frame is read
+GLuint samplesQueries[2];
+int samplesQueryFrame = 0;
+GLuint lastSamplesPassed = 0;
+GLuint fullscreenVAO;
+
+// state changes of all the draw lists of the last frame
+gps::DrawListStats frameDrawStats;
+gps::DrawListStats lastFrameDrawStats;
 
 // mouse callback
 float lastX = 960, lastY = 540;
@@ -101,7 +183,90 @@ float shuttleSpeed = 0.3f;
 // turret
 GLfloat delta = 0;
 float movementSpeed = 5;
-double lastTimeStamp = glfwGetTime();
+
+// command line: --size WxH, --frames N (render N frames, one simulation step each), --dump DIR,
+// --benchmark OUT.json, --camera-path FILE (instead of the built in path), --record-path FILE,
+// --gpu-profile, --gpu-time-models NAME,NAME (per model draw timing, implies --gpu-profile),
+// --gl-budget CATEGORY=N,CATEGORY=N (GL calls per frame, exit code 1 when exceeded), --gl-summary,
+// --capture FILE, --capture-frames N (GL trace of the start and the first N frames, for GLReplay),
+// --gl-debug-severity high|medium|low|notification (debug builds), --hud,
+// --assert-no-alloc N (builds with GPS_ALLOC_TRACKING: exit code 1 when a frame after the first N allocates), --alloc-summary
+int windowWidth = 1920;
+int windowHeight = 1080;
+int frameLimit = 0;
+std::string frameDumpDirectory;
+// a headless run without --frames stops after this many frames
+const int HEADLESS_DEFAULT_FRAMES = 60;
+
+// benchmark: no input, the intro and then the camera path in fixed steps, timings written as JSON
+bool benchmarkMode = false;
+std::string benchmarkOutput;
+std::string cameraPathFile;
+std::string recordPathFile;
+gps::CameraPath cameraPath;
+gps::Benchmark benchmark;
+// seconds since the intro ended
+float cameraPathTime = 0.0f;
+// the first frames finish linking the shader permutations and fill the caches
+const int BENCHMARK_WARMUP_FRAMES = 30;
+// a recorded path gets a key this often
+const float CAMERA_RECORD_INTERVAL = 0.5f;
+
+// GPU time of the passes, the skybox and the chosen models, reported with the CPU scopes (F3, F4)
+bool gpuProfiling = false;
+std::string gpuTimedModels;
+gps::GpuProfiler gpuProfiler;
+
+// GL call counts of each frame, only collected by builds with GPS_GL_INTERCEPT (F6 prints the last frame)
+bool glCallSummary = false;
+std::string captureFile;
+int captureFrames = 10;
+
+// driver messages from this severity up, through KHR_debug in debug builds
+GLenum glDebugSeverity = GL_DEBUG_SEVERITY_MEDIUM;
+
+// on-screen stats of the last frame (H), showing it turns on the GPU profiler for the pass times
+struct PassTime {
+    std::string name;
+    double cpuMilliseconds;
+};
+
+gps::Hud hud;
+bool hudVisible = false;
+float lastFrameMilliseconds = 0.0f;
+long long passStartTime = 0;
+// the entries are overwritten in place, their names keep the capacity of the frames before
+std::vector<PassTime> framePassTimes;
+std::vector<PassTime> lastPassTimes;
+int framePassCount = 0;
+int lastPassCount = 0;
+
+// heap allocations of the render loop, counted by builds with GPS_ALLOC_TRACKING (F7 prints the last frame)
+bool allocationGuard = false;
+int allocationWarmupFrames = 0;
+bool allocationSummary = false;
+
+// simulation runs in fixed 60 Hz steps, rendering blends the last two states
+gps::SimulationClock simulationClock(1.0 / 60.0);
+double lastTimeStamp = 0.0;
+
+struct SimulationState {
+    float angle;
+    float turretAngle;
+    float skyboxAngle;
+    float shuttlePos;
+    glm::vec3 lightDir;
+    glm::vec3 cameraPosition;
+};
+
+SimulationState previousState;
+SimulationState currentState;
+SimulationState renderState;
+
+// the camera drops at this fraction of the shuttle speed during the intro
+const float INTRO_CAMERA_RATIO = 0.41f;
+// degrees per second the sun keeps turning on its own
+const float LIGHT_ROTATION_SPEED = 0.12f;
 
 // fog
 float fogDensity = 0.02f;
@@ -144,15 +309,116 @@ GLenum glCheckError_(const char *file, int line)
 }
 #define glCheckError() glCheckError_(__FILE__, __LINE__)
 
+#if !defined (GPS_HEADLESS)
 void windowResizeCallback(GLFWwindow* window, int width, int height) {
 	fprintf(stdout, "Window resized! New width: %d , and height: %d\n", width, height);
 }
+#endif
+
+void addStats(gps::RenderQueueStats& total, gps::RenderQueueStats stats) {
+    total.draws += stats.draws;
+    total.programChanges += stats.programChanges;
+    total.materialChanges += stats.materialChanges;
+    total.meshChanges += stats.meshChanges;
+}
 
+void accumulateDrawStats(gps::DrawList& drawList) {
+    gps::DrawListStats stats = drawList.GetStats();
+    addStats(frameDrawStats.sorted, stats.sorted);
+    addStats(frameDrawStats.unsorted, stats.unsorted);
+    frameDrawStats.renderables += stats.renderables;
+    frameDrawStats.culledRenderables += stats.culledRenderables;
+    frameDrawStats.meshes += stats.meshes;
+    frameDrawStats.culledMeshes += stats.culledMeshes;
+    frameDrawStats.triangles += stats.triangles;
+}
+
+void printDrawStats() {
+    gps::RenderQueueStats before = lastFrameDrawStats.unsorted;
+    gps::RenderQueueStats after = lastFrameDrawStats.sorted;
+    fprintf(stdout, "Draws per frame: %d\n", after.draws);
+    fprintf(stdout, "State changes    scene order    sorted\n");
+    fprintf(stdout, "  programs       %11d %9d\n", before.programChanges, after.programChanges);
+    fprintf(stdout, "  materials      %11d %9d\n", before.materialChanges, after.materialChanges);
+    fprintf(stdout, "  meshes         %11d %9d\n", before.meshChanges, after.meshChanges);
+    int pixels = myWindow.getWindowDimensions().width * myWindow.getWindowDimensions().height;
+    fprintf(stdout, "Shaded samples per pixel: %.2f (depth pre-pass %s)\n",
+        (float)lastSamplesPassed / (float)pixels, depthPrePass ? "on" : "off");
+    fprintf(stdout, "Point lights: %d, cluster references: %d, most lights in a cluster: %d\n",
+        lightClusters.GetLightCount(), lightClusters.GetIndexCount(), lightClusters.GetMaxLightsPerCluster());
+    fprintf(stdout, "Render graph: %d transient targets in %d textures\n",
+        frameGraph.GetTransientTargetCount(), frameGraph.GetTransientTextureCount());
+}
+
+void initGpuProfiler() {
+    gpuProfiler.Init(true);
+    mainDrawList.SetGpuProfiler(&gpuProfiler);
+    shadowDrawList.SetGpuProfiler(&gpuProfiler);
+    prePassDrawList.SetGpuProfiler(&gpuProfiler);
+}
+
+// input only exists with a window, the headless backend does not link GLFW
+#if !defined (GPS_HEADLESS)
 void keyboardCallback(GLFWwindow* window, int key, int scancode, int action, int mode) {
 	if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS) {
         glfwSetWindowShouldClose(window, GL_TRUE);
     }
 
+    if (key == GLFW_KEY_F1 && action == GLFW_PRESS) {
+        printDrawStats();
+    }
+    // switch between forward and deferred shading
+    if (key == GLFW_KEY_G && action == GLFW_PRESS) {
+        deferredShading = !deferredShading;
+        renderGraphDirty = true;
+        fprintf(stdout, deferredShading ? "Deferred shading\n" : "Forward shading\n");
+    }
+    // depth pre-pass for the forward path
+    if (key == GLFW_KEY_F2 && action == GLFW_PRESS) {
+        depthPrePass = !depthPrePass;
+        renderGraphDirty = true;
+        fprintf(stdout, depthPrePass ? "Depth pre-pass on\n" : "Depth pre-pass off\n");
+    }
+    // CPU scope averages, and a Chrome / Perfetto trace of the recent scopes (builds with GPS_PROFILER)
+    if (key == GLFW_KEY_F3 && action == GLFW_PRESS) {
+        gps::Profiler::PrintAverages();
+        if (gpuProfiling) {
+            gpuProfiler.PrintStatistics();
+        }
+    }
+    if (key == GLFW_KEY_F4 && action == GLFW_PRESS) {
+        gps::Profiler::WriteChromeTrace("profile_trace.json");
+    }
+    if (key == GLFW_KEY_F6 && action == GLFW_PRESS) {
+        gps::GLIntercept::PrintFrameSummary();
+    }
+    if (key == GLFW_KEY_F7 && action == GLFW_PRESS) {
+        gps::AllocationTracker::PrintFrameSummary();
+    }
+    // performance overlay, an extra pass at the end of the frame graph
+    if (key == GLFW_KEY_H && action == GLFW_PRESS) {
+        hudVisible = !hudVisible;
+        renderGraphDirty = true;
+        if (hudVisible && !gpuProfiling) {
+            gpuProfiling = true;
+            initGpuProfiler();
+        }
+    }
+    // scatter extra lamps over the base
+    if (key == GLFW_KEY_O && action == GLFW_PRESS) {
+        extraLamps = !extraLamps;
+    }
+    // simulation clock controls: pause, slower, faster
+    if (key == GLFW_KEY_K && action == GLFW_PRESS) {
+        simulationClock.TogglePause();
+    }
+    if (key == GLFW_KEY_MINUS && action == GLFW_PRESS) {
+        simulationClock.SetTimeScale(simulationClock.GetTimeScale() * 0.5);
+    }
+    if (key == GLFW_KEY_EQUAL && action == GLFW_PRESS) {
+        simulationClock.SetTimeScale(simulationClock.GetTimeScale() * 2.0);
+    }
+
 	if (key >= 0 && key < 1024) {
         if (action == GLFW_PRESS) {
             pressedKeys[key] = true;
@@ -187,155 +453,87 @@ void mouseCallback(GLFWwindow* window, double xpos, double ypos) {
     if (pitch < -89.0f)
         pitch = -89.0f;
 
+    // the main pass picks up the new view matrix
     myCamera.rotate(pitch, yaw);
-    view = myCamera.getViewMatrix();
-    myBasicShader.useShaderProgram();
-    glUniformMatrix4fv(glGetUniformLocation(myBasicShader.shaderProgram, "view"), 1, GL_FALSE, glm::value_ptr(view));
-    normalMatrix = glm::mat3(glm::inverseTranspose(view*model));
-    glUniformMatrix3fv(normalMatrixLoc, 1, GL_FALSE, glm::value_ptr(normalMatrix));
 }
+#endif
 
+// light and fog colours follow the sun, the main pass sends them to the shader
 void testNight() {
-    myBasicShader.useShaderProgram();
     if (lightDir.y < 0) {
         float lightLevel = 1.0f + lightDir.y / 50.0f;
         lightColor = glm::vec3(lightLevel, lightLevel, lightLevel);
-        glUniform3fv(glGetUniformLocation(myBasicShader.shaderProgram, "lightColor"), 1, glm::value_ptr(lightColor));
-
         fogColor = glm::vec3(lightLevel / 2, lightLevel / 2, lightLevel / 2);
-        glUniform3fv(glGetUniformLocation(myBasicShader.shaderProgram, "fogColor"), 1, glm::value_ptr(fogColor));
     }
     else {
         lightColor = glm::vec3(1.0f, 1.0f, 1.0f);
-        glUniform3fv(glGetUniformLocation(myBasicShader.shaderProgram, "lightColor"), 1, glm::value_ptr(lightColor));
-
         fogColor = glm::vec3(0.5f, 0.5f, 0.5f);
-        glUniform3fv(glGetUniformLocation(myBasicShader.shaderProgram, "fogColor"), 1, glm::value_ptr(fogColor));
     }
 }
 
-void processMovement() {
+// the amounts per key are tuned for one 60 Hz step, scale is the frame time in those steps
+void processMovement(float scale) {
 	if (pressedKeys[GLFW_KEY_W]) {
-		myCamera.move(gps::MOVE_FORWARD, cameraSpeed);
-		//update view matrix
-        view = myCamera.getViewMatrix();
-        myBasicShader.useShaderProgram();
-        glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
-        // compute normal matrix
-        normalMatrix = glm::mat3(glm::inverseTranspose(view*model));
-        glUniformMatrix3fv(normalMatrixLoc, 1, GL_FALSE, glm::value_ptr(normalMatrix));
+		myCamera.move(gps::MOVE_FORWARD, cameraSpeed * scale);
 	}
 
 	if (pressedKeys[GLFW_KEY_S]) {
-		myCamera.move(gps::MOVE_BACKWARD, cameraSpeed);
-        //update view matrix
-        view = myCamera.getViewMatrix();
-        myBasicShader.useShaderProgram();
-        glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
-        // compute normal matrix
-        normalMatrix = glm::mat3(glm::inverseTranspose(view*model));
-        glUniformMatrix3fv(normalMatrixLoc, 1, GL_FALSE, glm::value_ptr(normalMatrix));
+		myCamera.move(gps::MOVE_BACKWARD, cameraSpeed * scale);
 	}
 
 	if (pressedKeys[GLFW_KEY_A]) {
-		myCamera.move(gps::MOVE_LEFT, cameraSpeed);
-        //update view matrix
-        view = myCamera.getViewMatrix();
-        myBasicShader.useShaderProgram();
-        glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
-        // compute normal matrix
-        normalMatrix = glm::mat3(glm::inverseTranspose(view*model));
-        glUniformMatrix3fv(normalMatrixLoc, 1, GL_FALSE, glm::value_ptr(normalMatrix));
+		myCamera.move(gps::MOVE_LEFT, cameraSpeed * scale);
 	}
 
 	if (pressedKeys[GLFW_KEY_D]) {
-		myCamera.move(gps::MOVE_RIGHT, cameraSpeed);
-        //update view matrix
-        view = myCamera.getViewMatrix();
-        myBasicShader.useShaderProgram();
-        glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
-        // compute normal matrix
-        normalMatrix = glm::mat3(glm::inverseTranspose(view*model));
-        glUniformMatrix3fv(normalMatrixLoc, 1, GL_FALSE, glm::value_ptr(normalMatrix));
+		myCamera.move(gps::MOVE_RIGHT, cameraSpeed * scale);
 	}
 
     if (pressedKeys[GLFW_KEY_SPACE]) {
-        myCamera.move(gps::MOVE_UP, cameraSpeed);
-        //update view matrix
-        view = myCamera.getViewMatrix();
-        myBasicShader.useShaderProgram();
-        glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
-        // compute normal matrix
-        normalMatrix = glm::mat3(glm::inverseTranspose(view * model));
-        glUniformMatrix3fv(normalMatrixLoc, 1, GL_FALSE, glm::value_ptr(normalMatrix));
+        myCamera.move(gps::MOVE_UP, cameraSpeed * scale);
     }
 
     if (pressedKeys[GLFW_KEY_LEFT_SHIFT]) {
-        myCamera.move(gps::MOVE_DOWN, cameraSpeed);
-        //update view matrix
-        view = myCamera.getViewMatrix();
-        myBasicShader.useShaderProgram();
-        glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
-        // compute normal matrix
-        normalMatrix = glm::mat3(glm::inverseTranspose(view * model));
-        glUniformMatrix3fv(normalMatrixLoc, 1, GL_FALSE, glm::value_ptr(normalMatrix));
+        myCamera.move(gps::MOVE_DOWN, cameraSpeed * scale);
     }
 
     if (pressedKeys[GLFW_KEY_Q]) {
-        angle -= 1.0f;
-        myBasicShader.useShaderProgram();
-        // update model matrix
-        model = glm::rotate(glm::mat4(1.0f), glm::radians(angle), glm::vec3(0, 1, 0));
-        // update normal matrix
-        normalMatrix = glm::mat3(glm::inverseTranspose(view*model));
-        glUniformMatrix3fv(normalMatrixLoc, 1, GL_FALSE, glm::value_ptr(normalMatrix));
+        angle -= 1.0f * scale;
+        // the base is a static shadow caster, so the cached shadow layer is stale now
+        shadowCascades.InvalidateStaticLayer();
     }
 
     if (pressedKeys[GLFW_KEY_E]) {
-        angle += 1.0f;
-        myBasicShader.useShaderProgram();
-        // update model matrix
-        model = glm::rotate(glm::mat4(1.0f), glm::radians(angle), glm::vec3(0, 1, 0));
-        // update normal matrix
-        normalMatrix = glm::mat3(glm::inverseTranspose(view*model));
-        glUniformMatrix3fv(normalMatrixLoc, 1, GL_FALSE, glm::value_ptr(normalMatrix));
+        angle += 1.0f * scale;
+        // the base is a static shadow caster, so the cached shadow layer is stale now
+        shadowCascades.InvalidateStaticLayer();
     }
 
     if (pressedKeys[GLFW_KEY_X]) {
         if (fogDensity < 0.36) {
-            fogDensity += 0.002f;
-            myBasicShader.useShaderProgram();
-            glUniform1f(glGetUniformLocation(myBasicShader.shaderProgram, "fogDensity"), fogDensity);
+            fogDensity += 0.002f * scale;
         }
     }
 
     if (pressedKeys[GLFW_KEY_Z]) {
         if (fogDensity > 0) {
-            fogDensity -= 0.002f;
-            myBasicShader.useShaderProgram();
-            glUniform1f(glGetUniformLocation(myBasicShader.shaderProgram, "fogDensity"), fogDensity);
+            fogDensity -= 0.002f * scale;
         }
     }
 
     if (pressedKeys[GLFW_KEY_V]) {
-        skyboxAngle -= 0.2f;
+        skyboxAngle -= 0.2f * scale;
 
-        glm::mat4 rotateLight = glm::rotate(glm::mat4(1.0f), glm::radians(0.2f), glm::vec3(0.0f, 0.0f, 1.0f));
+        glm::mat4 rotateLight = glm::rotate(glm::mat4(1.0f), glm::radians(0.2f * scale), glm::vec3(0.0f, 0.0f, 1.0f));
         lightDir = glm::vec3(rotateLight * glm::vec4(lightDir, 1.0f));
-        myBasicShader.useShaderProgram();
-        glUniform3fv(glGetUniformLocation(myBasicShader.shaderProgram, "lightDir"), 1, glm::value_ptr(lightDir));
-
         testNight();
     }
 
     if (pressedKeys[GLFW_KEY_C]) {
-        skyboxAngle += 0.2f;
+        skyboxAngle += 0.2f * scale;
 
-        glm::mat4 rotateLight = glm::rotate(glm::mat4(1.0f), glm::radians(-0.2f), glm::vec3(0.0f, 0.0f, 1.0f));
+        glm::mat4 rotateLight = glm::rotate(glm::mat4(1.0f), glm::radians(-0.2f * scale), glm::vec3(0.0f, 0.0f, 1.0f));
         lightDir = glm::vec3(rotateLight * glm::vec4(lightDir, 1.0f));
-        myBasicShader.useShaderProgram();
-        glUniform3fv(glGetUniformLocation(myBasicShader.shaderProgram, "lightDir"), 1, glm::value_ptr(lightDir));
-
         testNight();
     }
 
@@ -352,18 +550,98 @@ void processMovement() {
     }
 }
 
+// false when an argument is malformed and the run should not start
+bool parseArguments(int argc, const char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+            sscanf(argv[++i], "%dx%d", &windowWidth, &windowHeight);
+        }
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frameLimit = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--dump") == 0 && i + 1 < argc) {
+            frameDumpDirectory = argv[++i];
+        }
+        else if (strcmp(argv[i], "--benchmark") == 0 && i + 1 < argc) {
+            benchmarkMode = true;
+            benchmarkOutput = argv[++i];
+        }
+        else if (strcmp(argv[i], "--camera-path") == 0 && i + 1 < argc) {
+            cameraPathFile = argv[++i];
+        }
+        else if (strcmp(argv[i], "--record-path") == 0 && i + 1 < argc) {
+            recordPathFile = argv[++i];
+        }
+        else if (strcmp(argv[i], "--gpu-profile") == 0) {
+            gpuProfiling = true;
+        }
+        else if (strcmp(argv[i], "--gpu-time-models") == 0 && i + 1 < argc) {
+            gpuProfiling = true;
+            gpuTimedModels = "," + std::string(argv[++i]) + ",";
+        }
+        else if (strcmp(argv[i], "--gl-budget") == 0 && i + 1 < argc) {
+            if (!gps::GLIntercept::ParseBudgets(argv[++i])) {
+                return false;
+            }
+        }
+        else if (strcmp(argv[i], "--gl-summary") == 0) {
+            glCallSummary = true;
+        }
+        else if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc) {
+            captureFile = argv[++i];
+        }
+        else if (strcmp(argv[i], "--capture-frames") == 0 && i + 1 < argc) {
+            captureFrames = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--hud") == 0) {
+            hudVisible = true;
+            gpuProfiling = true;
+        }
+        else if (strcmp(argv[i], "--assert-no-alloc") == 0 && i + 1 < argc) {
+            allocationGuard = true;
+            allocationWarmupFrames = atoi(argv[++i]);
+            if (!gps::AllocationTracker::IsEnabled()) {
+                std::cout << "--assert-no-alloc needs a build with GPS_ALLOC_TRACKING, nothing is checked" << std::endl;
+            }
+        }
+        else if (strcmp(argv[i], "--alloc-summary") == 0) {
+            allocationSummary = true;
+        }
+        else if (strcmp(argv[i], "--gl-debug-severity") == 0 && i + 1 < argc) {
+            if (!gps::GLDebug::ParseSeverity(argv[++i], glDebugSeverity)) {
+                std::cout << "Unknown severity " << argv[i] << std::endl;
+            }
+        }
+        else {
+            std::cout << "Unknown argument " << argv[i] << std::endl;
+        }
+    }
+    return true;
+}
+
 void initOpenGLWindow() {
-    myWindow.Create(1920, 1080, "Moon Project");
+    myWindow.Create(windowWidth, windowHeight, "Moon Project");
+    if (myWindow.isHeadless() && frameLimit == 0 && !benchmarkMode) {
+        frameLimit = HEADLESS_DEFAULT_FRAMES;
+    }
 }
 
 void setWindowCallbacks() {
+    // no input without a window, and none that could disturb a benchmark
+#if !defined (GPS_HEADLESS)
+    if (benchmarkMode) {
+        return;
+    }
 	glfwSetWindowSizeCallback(myWindow.getWindow(), windowResizeCallback);
     glfwSetKeyCallback(myWindow.getWindow(), keyboardCallback);
     glfwSetCursorPosCallback(myWindow.getWindow(), mouseCallback);
     glfwSetInputMode(myWindow.getWindow(), GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+#endif
 }
 
 void initOpenGLState() {
+    // first, so errors of the setup are reported too
+    gps::GLDebug::Init(glDebugSeverity);
 	glClearColor(0.7f, 0.7f, 0.7f, 1.0f);
 	glViewport(0, 0, myWindow.getWindowDimensions().width, myWindow.getWindowDimensions().height);
     glEnable(GL_FRAMEBUFFER_SRGB);
@@ -383,97 +661,123 @@ void initModels() {
     turret3.LoadModel("models/turret/turret3.obj");
 }
 
+// name - for --gpu-time-models
+gps::Renderable createRenderable(gps::Model3D* model, int objectSet, const char* name) {
+    gps::Renderable renderable;
+    renderable.lods[0] = model;
+    renderable.lodDistances[0] = CAMERA_FAR;
+    renderable.lodCount = 1;
+    renderable.modelMatrix = glm::mat4(1.0f);
+    renderable.normalMatrix = glm::mat3(1.0f);
+    renderable.objectSet = objectSet;
+    bool timed = gpuTimedModels == ",all," || gpuTimedModels.find("," + std::string(name) + ",") != std::string::npos;
+    renderable.gpuTimerName = timed ? gpuProfiler.Intern(name) : NULL;
+    return renderable;
+}
+
+// only full detail models exist for now, more LODs can be appended to lods/lodDistances
+void initRenderables() {
+    renderables.push_back(createRenderable(&scene, gps::OBJECTS_STATIC, "scene"));
+    renderables.push_back(createRenderable(&turret1, gps::OBJECTS_DYNAMIC, "turret1"));
+    renderables.push_back(createRenderable(&turret2, gps::OBJECTS_DYNAMIC, "turret2"));
+    renderables.push_back(createRenderable(&turret3, gps::OBJECTS_DYNAMIC, "turret3"));
+    renderables.push_back(createRenderable(&shuttle, gps::OBJECTS_DYNAMIC, "shuttle"));
+}
+
+void beginCapture() {
+    if (captureFile.empty()) {
+        return;
+    }
+    if (!gps::GLIntercept::IsEnabled()) {
+        std::cout << "--capture needs a build with GPS_GL_INTERCEPT" << std::endl;
+        return;
+    }
+    gps::GLTrace::BeginCapture(captureFile, captureFrames, windowWidth, windowHeight);
+}
+
+// the point light loop is sized to the busiest cluster, rounded up to a power of two
+// so a few lights more or less do not switch to another permutation every frame
+int roundPointLights(int maxLights) {
+    if (maxLights == 0)
+        return 0;
+
+    int numPointLights = 1;
+    while (numPointLights < maxLights)
+        numPointLights *= 2;
+    return numPointLights;
+}
+
+// every permutation a frame can ask for, so none is compiled inside the render loop
+// the deferred pass always shades with shadows, the main pass also draws distant objects without them
+void prebuildShaderPermutations() {
+    for (int lights = 0; lights <= roundPointLights(MAX_POINT_LIGHTS); lights = lights == 0 ? 1 : lights * 2) {
+        for (unsigned int fog = 0; fog <= gps::SHADER_FOG; fog += gps::SHADER_FOG) {
+            basicShaders.Get(gps::SHADER_SHADOWS | fog, lights);
+            basicShaders.Get(fog, lights);
+            deferredShaders.Get(gps::SHADER_SHADOWS | fog, lights);
+        }
+    }
+}
+
 void initShaders() {
-	myBasicShader.loadShader("shaders/basic.vert", "shaders/basic.frag");
-    myBasicShader.useShaderProgram();
+    // a trace has to compile its programs from source, binaries only load on the same driver
+    if (!gps::GLTrace::IsCapturing()) {
+        programCache.Init("shadercache");
+        gps::Shader::SetProgramCache(&programCache);
+    }
+    gps::Shader::EnableParallelCompile();
+
+    basicShaders.Init("shaders/basic.vert", "shaders/basic.frag");
+    deferredShaders.Init("shaders/deferred.vert", "shaders/deferred.frag");
+    prebuildShaderPermutations();
+    // only submitted here, the status is checked when a program is first used
     skyboxShader.loadShader("shaders/skyboxShader.vert", "shaders/skyboxShader.frag");
-    skyboxShader.useShaderProgram();
-    depthMapShader.loadShader("shaders/depthMapShader.vert", "shaders/depthMapShader.frag");
-    depthMapShader.useShaderProgram();
+    // depth only passes need no fragment stage
+    depthMapShader.loadShader("shaders/depthMapShader.vert");
+    gbufferShader.loadShader("shaders/basic.vert", "shaders/gbuffer.frag");
+    if (programCache.IsEnabled()) {
+        std::cout << "Programs: " << programCache.GetLoadedCount() << " from the cache, "
+            << programCache.GetCompiledCount() << " compiled" << std::endl;
+    }
+
+    // the fullscreen triangle is generated from gl_VertexID, but core profile draws need a VAO
+    glGenVertexArrays(1, &fullscreenVAO);
+    glGenQueries(2, samplesQueries);
 }
 
 void initFBO() {
-    //generate FBO ID
-    glGenFramebuffers(1, &shadowMapFBO);
-
-    //create depth texture for FBO
-    glGenTextures(1, &depthMapTexture);
-    glBindTexture(GL_TEXTURE_2D, depthMapTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, SHADOW_WIDTH, SHADOW_HEIGHT, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    float borderColor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
-    glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
-
-    //attach texture to FBO
-    glBindFramebuffer(GL_FRAMEBUFFER, shadowMapFBO);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthMapTexture, 0);
-    glDrawBuffer(GL_NONE);
-    glReadBuffer(GL_NONE);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    shadowCascades.Init(SHADOW_CASCADES, SHADOW_RESOLUTION, SHADOW_DISTANCE);
+    shadowCascades.SetCacheParameters(SHADOW_CACHE_ANGLE, SHADOW_CACHE_MARGIN, SHADOW_CACHE_UPDATES_PER_FRAME);
 }
 
+// the lit shaders receive their uniforms every frame, see setLightingUniforms
 void initUniforms() {
-	myBasicShader.useShaderProgram();
-
     // create model matrix
     model = glm::rotate(glm::mat4(1.0f), glm::radians(angle), glm::vec3(0.0f, 1.0f, 0.0f));
-	modelLoc = glGetUniformLocation(myBasicShader.shaderProgram, "model");
 
-	// get view matrix for current camera
-	view = myCamera.getViewMatrix();
-	viewLoc = glGetUniformLocation(myBasicShader.shaderProgram, "view");
-	// send view matrix to shader
-    glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
-
-    // compute normal matrix
-    normalMatrix = glm::mat3(glm::inverseTranspose(view*model));
-	normalMatrixLoc = glGetUniformLocation(myBasicShader.shaderProgram, "normalMatrix");
-
-	// create projection matrix
-	projection = glm::perspective(glm::radians(45.0f),
+	// the camera owns the projection matrix
+	myCamera.setProjection(CAMERA_FOV,
                                (float)myWindow.getWindowDimensions().width / (float)myWindow.getWindowDimensions().height,
-                               0.1f, 100.0f);
-	projectionLoc = glGetUniformLocation(myBasicShader.shaderProgram, "projection");
-	// send projection matrix to shader
-	glUniformMatrix4fv(projectionLoc, 1, GL_FALSE, glm::value_ptr(projection));	
+                               CAMERA_NEAR, CAMERA_FAR);
 
 	// set the light direction (direction towards the light)
 	lightDir = glm::vec3(32.0f, 20.0f, 1.0f);
-	lightDirLoc = glGetUniformLocation(myBasicShader.shaderProgram, "lightDir");
-	// send light dir to shader
-	glUniform3fv(lightDirLoc, 1, glm::value_ptr(lightDir));
 
 	// set light color
 	lightColor = glm::vec3(1.0f, 1.0f, 1.0f); //white light
-	lightColorLoc = glGetUniformLocation(myBasicShader.shaderProgram, "lightColor");
-	// send light color to shader
-	glUniform3fv(lightColorLoc, 1, glm::value_ptr(lightColor));
     
+    // point light positions in model space, the lights are gathered every frame
     lightPos1 = glm::vec3(2.13f, 0.74f, 3.45f);
     lightPos2 = glm::vec3(1.95f, 0.74f, 3.61f);
-    glUniform3fv(glGetUniformLocation(myBasicShader.shaderProgram, "lightPos1"), 1, glm::value_ptr(lightPos1));
-    glUniform3fv(glGetUniformLocation(myBasicShader.shaderProgram, "lightPos2"), 1, glm::value_ptr(lightPos2));
-
-    redLightModel = glm::mat4(1.0f);
     redLightPos = glm::vec3(2.27f, 0.16f, -1.23f);
-    glUniform3fv(glGetUniformLocation(myBasicShader.shaderProgram, "redLightPos"), 1, glm::value_ptr(redLightPos));
-    glUniformMatrix4fv(glGetUniformLocation(myBasicShader.shaderProgram, "redLightModel"), 1, GL_FALSE, glm::value_ptr(redLightModel));
-    glUniform1i(glGetUniformLocation(myBasicShader.shaderProgram, "redLightOn"), redLightOn);
-
-    // send fog density
-    glUniform1f(glGetUniformLocation(myBasicShader.shaderProgram, "fogDensity"), fogDensity);
 
     fogColor = glm::vec3(0.5f, 0.5f, 0.5f);
-    glUniform3fv(glGetUniformLocation(myBasicShader.shaderProgram, "fogColor"), 1, glm::value_ptr(fogColor));
 
     skyboxShader.useShaderProgram();
 
     // create model matrix
-    skyModel = glm::rotate(glm::mat4(1.0f), glm::radians(skyboxAngle), glm::vec3(0.0f, 0.0f, 1.0f));
-    glUniformMatrix4fv(glGetUniformLocation(myBasicShader.shaderProgram, "model"), 1, GL_FALSE, glm::value_ptr(skyModel));
+    glm::mat4 skyModel = glm::rotate(glm::mat4(1.0f), glm::radians(skyboxAngle), glm::vec3(0.0f, 0.0f, 1.0f));
+    glUniformMatrix4fv(glGetUniformLocation(skyboxShader.shaderProgram, "model"), 1, GL_FALSE, glm::value_ptr(skyModel));
 }
 
 void initSkybox() {
@@ -487,158 +791,643 @@ void initSkybox() {
     mySkyBox.Load(faces);
 }
 
-glm::mat4 computeLightSpaceTrMatrix() {
-    glm::mat4 lightView = glm::lookAt(lightDir, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-    const GLfloat near_plane = 1.0f, far_plane = 100.0f;
-    glm::mat4 lightProjection = glm::ortho(-30.0f, 30.0f, -30.0f, 30.0f, near_plane, far_plane);
-    glm::mat4 lightSpaceTrMatrix = lightProjection * lightView;
-    return lightSpaceTrMatrix;
+void updateShadowCascades() {
+    shadowCascades.Update(myCamera.getViewMatrix(), myCamera.getFov(), myCamera.getAspect(), myCamera.getNearPlane(), renderState.lightDir);
 }
 
-void renderBase(gps::Shader shader) {
-    shader.useShaderProgram();
-    model = glm::rotate(glm::mat4(1.0f), glm::radians(angle), glm::vec3(0.0f, 1.0f, 0.0f));
-    glUniformMatrix4fv(glGetUniformLocation(shader.shaderProgram, "model"), 1, GL_FALSE, glm::value_ptr(model));
-    glUniformMatrix4fv(glGetUniformLocation(shader.shaderProgram, "lightModel"), 1, GL_FALSE, glm::value_ptr(model));
-    scene.Draw(shader);
-}
-
-void updateAnimationTime() {
-    double currentTimeStamp = glfwGetTime();
-    turretAngle += movementSpeed * (float)(currentTimeStamp - lastTimeStamp);
-    skyboxAngle += skySpeed * (float)(currentTimeStamp - lastTimeStamp);
+void updateAnimationTime(float timeStep) {
+    turretAngle += movementSpeed * timeStep;
+    skyboxAngle += skySpeed * timeStep;
     if (intro) {
-        shuttlePos = shuttlePos - shuttleSpeed * (float)(currentTimeStamp - lastTimeStamp);
+        shuttlePos = shuttlePos - shuttleSpeed * timeStep;
     }
-    lastTimeStamp = currentTimeStamp;
 }
 
-void renderShuttle(gps::Shader shader, bool renderingDepthMap) {
-    shader.useShaderProgram();
+void updateIntro(float timeStep) {
     if (intro) {
         if (shuttlePos <= 0) {
             shuttlePos = 0;
             intro = false;
-
         }
         else if (shuttlePos < 2 && shuttleSpeed == 0.2f) {
             shuttleSpeed -= 0.1f;
         }
-        shuttleModel = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, shuttlePos, 0.0f));
-        redLightModel = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, shuttlePos, 0.0f));
-        glUniformMatrix4fv(glGetUniformLocation(shader.shaderProgram, "model"), 1, GL_FALSE, glm::value_ptr(shuttleModel));
-        glUniformMatrix4fv(glGetUniformLocation(shader.shaderProgram, "redLightModel"), 1, GL_FALSE, glm::value_ptr(redLightModel));
 
-        myCamera.move(gps::MOVE_DOWN, shuttleSpeed/290);
-        view = myCamera.getViewMatrix();
-        glUniformMatrix4fv(glGetUniformLocation(shader.shaderProgram, "view"), 1, GL_FALSE, glm::value_ptr(view));
-        if (!renderingDepthMap) {
-            normalMatrix = glm::mat3(glm::inverseTranspose(view * model));
-            glUniformMatrix3fv(normalMatrixLoc, 1, GL_FALSE, glm::value_ptr(normalMatrix));
+        // the camera follows the shuttle down
+        myCamera.move(gps::MOVE_DOWN, shuttleSpeed * INTRO_CAMERA_RATIO * timeStep);
+    }
+    else {
+        redLightOn = 0;
+    }
+}
+
+void updateLight(float timeStep) {
+    glm::mat4 rotateLight = glm::rotate(glm::mat4(1.0f), glm::radians(-LIGHT_ROTATION_SPEED * timeStep), glm::vec3(0.0f, 0.0f, 1.0f));
+    lightDir = glm::vec3(rotateLight * glm::vec4(lightDir, 1.0f));
+    testNight();
+}
+
+// one fixed simulation step, the only place where the scene state advances
+// after the intro the benchmark camera follows the path, a recording samples the free flight
+void updateCameraPath(float timeStep) {
+    if (intro) {
+        return;
+    }
+
+    if (benchmarkMode) {
+        cameraPathTime += timeStep;
+        gps::CameraKey key = cameraPath.Sample(cameraPathTime);
+        yaw = key.yaw;
+        pitch = key.pitch;
+        myCamera.setPosition(key.position);
+        myCamera.rotate(pitch, yaw);
+    }
+    else if (!recordPathFile.empty()) {
+        if (cameraPath.GetKeyCount() == 0 || cameraPathTime - cameraPath.GetDuration() >= CAMERA_RECORD_INTERVAL) {
+            cameraPath.AddKey(cameraPathTime, myCamera.getPosition(), yaw, pitch);
         }
+        cameraPathTime += timeStep;
+    }
+}
+
+void updateSimulation(float timeStep) {
+    updateAnimationTime(timeStep);
+    updateIntro(timeStep);
+    updateCameraPath(timeStep);
+    updateLight(timeStep);
+}
+
+SimulationState captureSimulationState() {
+    SimulationState state;
+    state.angle = angle;
+    state.turretAngle = turretAngle;
+    state.skyboxAngle = skyboxAngle;
+    state.shuttlePos = shuttlePos;
+    state.lightDir = lightDir;
+    state.cameraPosition = myCamera.getPosition();
+    return state;
+}
+
+SimulationState interpolateStates(const SimulationState& from, const SimulationState& to, float alpha) {
+    SimulationState state;
+    state.angle = glm::mix(from.angle, to.angle, alpha);
+    state.turretAngle = glm::mix(from.turretAngle, to.turretAngle, alpha);
+    state.skyboxAngle = glm::mix(from.skyboxAngle, to.skyboxAngle, alpha);
+    state.shuttlePos = glm::mix(from.shuttlePos, to.shuttlePos, alpha);
+    state.lightDir = glm::mix(from.lightDir, to.lightDir, alpha);
+    state.cameraPosition = glm::mix(from.cameraPosition, to.cameraPosition, alpha);
+    return state;
+}
+
+// keyboard input is applied once per real frame, then the fixed steps covered by the elapsed time run
+// realDeltaTime can be wall-clock time or a constant for deterministic runs
+void advanceSimulation(double realDeltaTime) {
+    GPS_PROFILE_FUNCTION();
+    GPS_ALLOC_TAG("simulation");
+    // the camera holds the interpolated position of the last frame
+    myCamera.setPosition(currentState.cameraPosition);
+
+    if (!intro) {
+        processMovement((float)(realDeltaTime / simulationClock.GetFixedTimeStep()));
+        // the move shows this frame, the interpolated states are shifted with it
+        glm::vec3 moved = myCamera.getPosition() - currentState.cameraPosition;
+        previousState.cameraPosition += moved;
+        currentState.cameraPosition += moved;
+    }
+
+    int steps = simulationClock.Advance(realDeltaTime);
+    for (int i = 0; i < steps; i++) {
+        updateSimulation((float)simulationClock.GetFixedTimeStep());
+
+        previousState = currentState;
+        currentState = captureSimulationState();
+    }
+
+    renderState = interpolateStates(previousState, currentState, simulationClock.GetInterpolationFactor());
+    myCamera.setPosition(renderState.cameraPosition);
+}
+
+// the turret pivots never move, only the entity rotations and positions change per frame
+void initTransforms() {
+    baseEntity = transforms.Create();
+    for (int i = 0; i < 3; i++) {
+        turretPivotEntities[i] = transforms.Create(baseEntity);
+        transforms.SetPosition(turretPivotEntities[i], turretPivots[i]);
+        turretEntities[i] = transforms.Create(turretPivotEntities[i]);
+        transforms.SetPosition(turretEntities[i], -turretPivots[i]);
+    }
+    shuttleEntity = transforms.Create();
+    redLightEntity = transforms.Create();
+    skyEntity = transforms.Create();
+}
+
+// model matrices for the frame, built from the interpolated state
+void updateModelMatrices(const SimulationState& state) {
+    GPS_PROFILE_FUNCTION();
+    glm::quat baseRotation = glm::angleAxis(glm::radians(state.angle), glm::vec3(0.0f, 1.0f, 0.0f));
+    transforms.SetRotation(baseEntity, baseRotation);
+
+    for (int i = 0; i < 3; i++) {
+        transforms.SetRotation(turretPivotEntities[i], glm::angleAxis(glm::radians(state.turretAngle), glm::vec3(0.0f, 1.0f, 0.0f)));
+    }
+
+    if (intro) {
+        transforms.SetPosition(shuttleEntity, glm::vec3(0.0f, state.shuttlePos, 0.0f));
+        transforms.SetRotation(shuttleEntity, glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+        transforms.SetPosition(redLightEntity, glm::vec3(0.0f, state.shuttlePos, 0.0f));
     }
     else {
-        shuttleModel = glm::rotate(glm::mat4(1.0f), glm::radians(angle), glm::vec3(0.0f, 1.0f, 0.0f));
-        glUniformMatrix4fv(glGetUniformLocation(shader.shaderProgram, "model"), 1, GL_FALSE, glm::value_ptr(shuttleModel));
+        transforms.SetPosition(shuttleEntity, glm::vec3(0.0f));
+        transforms.SetRotation(shuttleEntity, baseRotation);
+        transforms.SetPosition(redLightEntity, glm::vec3(0.0f, -100.0f, 0.0f));
+    }
 
-        redLightOn = 0;
-        redLightModel = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -100.0f, 0.0f));
-        glUniform1i(glGetUniformLocation(shader.shaderProgram, "redLightOn"), redLightOn);
+    transforms.SetRotation(skyEntity, glm::angleAxis(glm::radians(-state.skyboxAngle), glm::vec3(0.0f, 0.0f, 1.0f)));
 
+    transforms.Update();
+    model = transforms.GetWorldMatrix(baseEntity);
+}
+
+// renderables follow the entities of the transform store
+void updateRenderables() {
+    gps::Entity entities[5] = { baseEntity, turretEntities[0], turretEntities[1], turretEntities[2], shuttleEntity };
+    for (int i = 0; i < 5; i++) {
+        renderables[i].modelMatrix = transforms.GetWorldMatrix(entities[i]);
+        renderables[i].normalMatrix = transforms.GetNormalMatrix(entities[i]);
     }
-    shuttle.Draw(shader);
 }
 
-void renderTurret(gps::Shader shader) {
-    shader.useShaderProgram();
-    turretModel = glm::rotate(glm::mat4(1.0f), glm::radians(angle), glm::vec3(0.0f, 1.0f, 0.0f));
-    turretModel = glm::translate(turretModel, glm::vec3(12.811f, 1.7615f, 5.8126f));
-    turretModel = glm::rotate(turretModel, glm::radians(turretAngle), glm::vec3(0.0f, 1.0f, 0.0f));
-    turretModel = glm::translate(turretModel, glm::vec3(-12.811f, -1.7615f, -5.8126f));
-    glUniformMatrix4fv(glGetUniformLocation(shader.shaderProgram, "model"), 1, GL_FALSE, glm::value_ptr(turretModel));
-    turret1.Draw(shader);
-
-    turretModel = glm::rotate(glm::mat4(1.0f), glm::radians(angle), glm::vec3(0.0f, 1.0f, 0.0f));
-    turretModel = glm::translate(turretModel, glm::vec3(-9.7728f, 1.6396f, -3.6212f));
-    turretModel = glm::rotate(turretModel, glm::radians(turretAngle), glm::vec3(0.0f, 1.0f, 0.0f));
-    turretModel = glm::translate(turretModel, glm::vec3(9.7728f, -1.6396f, 3.6212f));
-    glUniformMatrix4fv(glGetUniformLocation(shader.shaderProgram, "model"), 1, GL_FALSE, glm::value_ptr(turretModel));
-    turret2.Draw(shader);
-
-    turretModel = glm::rotate(glm::mat4(1.0f), glm::radians(angle), glm::vec3(0.0f, 1.0f, 0.0f));
-    turretModel = glm::translate(turretModel, glm::vec3(-6.9807f, 1.621f, 17.61f));
-    turretModel = glm::rotate(turretModel, glm::radians(turretAngle), glm::vec3(0.0f, 1.0f, 0.0f));
-    turretModel = glm::translate(turretModel, glm::vec3(6.9807f, -1.621f, -17.61f));
-    glUniformMatrix4fv(glGetUniformLocation(shader.shaderProgram, "model"), 1, GL_FALSE, glm::value_ptr(turretModel));
-    turret3.Draw(shader);
-}
-
-void renderSkyBox(gps::Shader shader) {
+void renderSkyBox() {
+    GPS_PROFILE_FUNCTION();
+    if (gpuProfiling) {
+        gpuProfiler.BeginScope(gpuProfiler.Intern("skybox"));
+    }
     skyboxShader.useShaderProgram();
-    skyModel = glm::rotate(glm::mat4(1.0f), glm::radians(-skyboxAngle), glm::vec3(0.0f, 0.0f, 1.0f));
-    glUniformMatrix4fv(glGetUniformLocation(skyboxShader.shaderProgram, "model"), 1, GL_FALSE, glm::value_ptr(skyModel));
+    glUniformMatrix4fv(glGetUniformLocation(skyboxShader.shaderProgram, "model"), 1, GL_FALSE, glm::value_ptr(transforms.GetWorldMatrix(skyEntity)));
+    mySkyBox.Draw(skyboxShader, myCamera.getViewMatrix(), myCamera.getProjectionMatrix());
+    if (gpuProfiling) {
+        gpuProfiler.EndScope();
+    }
+}
 
-    glm::mat4 rotateLight = glm::rotate(glm::mat4(1.0f), glm::radians(-0.002f), glm::vec3(0.0f, 0.0f, 1.0f));
-    lightDir = glm::vec3(rotateLight * glm::vec4(lightDir, 1.0f));
-    shader.useShaderProgram();
-    glUniform3fv(glGetUniformLocation(shader.shaderProgram, "lightDir"), 1, glm::value_ptr(lightDir));
+// each cascade only gets the casters inside its own light frustum
+// depth clamping keeps casters between the light and the cascade near plane
+// the static layer is only redrawn after a refit, the dynamic one every frame
+void renderShadowPass(const gps::RenderPass& pass) {
+    GPS_PROFILE_FUNCTION();
+    updateShadowCascades();
+
+    gps::DrawView drawView;
+    drawView.pass = PASS_SHADOW;
+    drawView.view = glm::mat4(1.0f);
+    drawView.position = renderState.cameraPosition;
+    drawView.depthOnly = true;
+    drawView.program = depthMapShader.shaderProgram;
+    drawView.distantProgram = depthMapShader.shaderProgram;
+    drawView.distantDepth = CAMERA_FAR;
 
-    testNight();
+    depthMapShader.useShaderProgram();
+    glEnable(GL_DEPTH_CLAMP);
+    for (int i = 0; i < shadowCascades.GetCascadeCount(); i++) {
+        glUniformMatrix4fv(glGetUniformLocation(depthMapShader.shaderProgram, "lightSpaceTrMatrix"),
+            1,
+            GL_FALSE,
+            glm::value_ptr(shadowCascades.GetLightSpaceMatrix(i)));
+
+        drawView.projection = shadowCascades.GetLightSpaceMatrix(i);
+        drawView.frustum = shadowCascades.GetFrustum(i);
+
+        if (shadowCascades.IsStaticLayerDirty(i)) {
+            shadowDrawList.Build(jobSystem, renderables, pass.objectSets & gps::OBJECTS_STATIC, drawView);
+            accumulateDrawStats(shadowDrawList);
+            shadowCascades.BindForWriting(i, gps::SHADOW_LAYER_STATIC);
+            shadowDrawList.Submit();
+            shadowCascades.StaticLayerUpdated(i);
+        }
 
-    mySkyBox.Draw(skyboxShader, view, projection);
+        shadowDrawList.Build(jobSystem, renderables, pass.objectSets & gps::OBJECTS_DYNAMIC, drawView);
+        accumulateDrawStats(shadowDrawList);
+        shadowCascades.BindForWriting(i, gps::SHADOW_LAYER_DYNAMIC);
+        shadowDrawList.Submit();
+    }
+    glDisable(GL_DEPTH_CLAMP);
 }
 
-void renderObjects(gps::Shader shader, bool renderingDepthMap) {
-    renderBase(shader);
-    updateAnimationTime();
-    renderTurret(shader);
-    renderShuttle(shader, renderingDepthMap);
-    renderSkyBox(shader);
+gps::PointLight createPointLight(glm::vec3 position, glm::vec3 color, float linear, float quadratic) {
+    gps::PointLight light;
+    light.position = position;
+    light.color = color;
+    light.linear = linear;
+    light.quadratic = quadratic;
+    return light;
 }
 
-void renderScene() {
+// the ceiling lights are attached to the base, the red light to the landing shuttle
+void updatePointLights() {
+    pointLights.clear();
+    pointLights.push_back(createPointLight(glm::vec3(model * glm::vec4(lightPos1, 1.0f)), glm::vec3(0.32f, 0.75f, 0.78f), 0.7f, 1.8f));
+    pointLights.push_back(createPointLight(glm::vec3(model * glm::vec4(lightPos2, 1.0f)), glm::vec3(0.32f, 0.75f, 0.78f), 0.7f, 1.8f));
+    if (redLightOn > 0) {
+        glm::vec3 position = glm::vec3(transforms.GetWorldMatrix(redLightEntity) * glm::vec4(redLightPos, 1.0f));
+        pointLights.push_back(createPointLight(position, glm::vec3(1.0f, 0.25f, 0.0f), 0.09f, 0.032f));
+    }
+
+    if (extraLamps) {
+        // a fixed grid over the base with a little jitter, so every run looks the same
+        for (int i = 0; i < EXTRA_LAMP_COUNT; i++) {
+            float x = -20.0f + 40.0f * (float)(i % 16) / 15.0f + std::sin(i * 12.9898f) * 0.8f;
+            float z = -20.0f + 40.0f * (float)(i / 16) / 15.0f + std::sin(i * 78.233f) * 0.8f;
+            glm::vec3 color = glm::vec3(0.5f + 0.5f * std::sin(i * 1.7f), 0.5f + 0.5f * std::sin(i * 2.3f + 2.0f), 0.5f + 0.5f * std::sin(i * 3.1f + 4.0f));
+            pointLights.push_back(createPointLight(glm::vec3(model * glm::vec4(x, 0.5f, z, 1.0f)), color, 0.7f, 1.8f));
+        }
+    }
+}
+
+// the camera view of the main and G-buffer passes
+gps::DrawView createCameraDrawView(unsigned int pass, GLuint program) {
+    gps::DrawView drawView;
+    drawView.pass = pass;
+    drawView.view = myCamera.getViewMatrix();
+    drawView.projection = myCamera.getProjectionMatrix();
+    drawView.position = renderState.cameraPosition;
+    drawView.frustum = myCamera.getFrustum();
+    drawView.depthOnly = false;
+    drawView.program = program;
+    drawView.distantProgram = program;
+    drawView.distantDepth = CAMERA_FAR;
+    return drawView;
+}
+
+// the dynamic shadow layer uses unit 4, the light clusters take 5 to 7
+void updateLightClusters() {
+    GPS_PROFILE_FUNCTION();
+    updatePointLights();
+    lightClusters.Build(jobSystem, pointLights, myCamera.getViewMatrix(), myCamera.getFov(), myCamera.getAspect(),
+        myCamera.getNearPlane(), myCamera.getFarPlane(), myWindow.getWindowDimensions().width, myWindow.getWindowDimensions().height);
+}
+
+int getPointLightPermutation() {
+    return roundPointLights(lightClusters.GetMaxLightsPerCluster());
+}
+
+unsigned int getLightingFeatures(bool shadows) {
+    unsigned int features = 0;
+    if (shadows)
+        features |= gps::SHADER_SHADOWS;
+    if (fogDensity > 0.0f)
+        features |= gps::SHADER_FOG;
+    return features;
+}
+
+// per frame uniforms of lighting.glsl, the compiled out ones have no location and are ignored
+void setLightingUniforms(gps::Shader& shader) {
+    shader.useShaderProgram();
+    GLuint program = shader.shaderProgram;
+    glUniformMatrix4fv(glGetUniformLocation(program, "view"), 1, GL_FALSE, glm::value_ptr(myCamera.getViewMatrix()));
+    glUniform3fv(glGetUniformLocation(program, "lightDir"), 1, glm::value_ptr(renderState.lightDir));
+    glUniform3fv(glGetUniformLocation(program, "lightColor"), 1, glm::value_ptr(lightColor));
+    glUniform1f(glGetUniformLocation(program, "fogDensity"), fogDensity);
+    glUniform3fv(glGetUniformLocation(program, "fogColor"), 1, glm::value_ptr(fogColor));
+
+    //bind the shadow cascades
+    shadowCascades.SetUniforms(shader, 3);
+    lightClusters.SetUniforms(shader, 5);
+}
+
+// lay down the depth of the opaque geometry with the positions only stream and no colour writes
+// the depth program computes gl_Position exactly like basic.vert, see the invariant qualifiers
+void renderDepthPrePass(const gps::RenderPass& pass) {
+    GPS_PROFILE_FUNCTION();
+    gps::DrawView drawView = createCameraDrawView(PASS_MAIN, depthMapShader.shaderProgram);
+    drawView.depthOnly = true;
+    prePassDrawList.Build(jobSystem, renderables, pass.objectSets, drawView);
+    accumulateDrawStats(prePassDrawList);
+
+    glViewport(0, 0, myWindow.getWindowDimensions().width, myWindow.getWindowDimensions().height);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
     depthMapShader.useShaderProgram();
-    glUniformMatrix4fv(glGetUniformLocation(depthMapShader.shaderProgram, "lightSpaceTrMatrix"),
-        1,
-        GL_FALSE,
-        glm::value_ptr(computeLightSpaceTrMatrix()));
-    glViewport(0, 0, SHADOW_WIDTH, SHADOW_HEIGHT);
-    glBindFramebuffer(GL_FRAMEBUFFER, shadowMapFBO);
-    glClear(GL_DEPTH_BUFFER_BIT);
-    renderObjects(depthMapShader, true);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glUniformMatrix4fv(glGetUniformLocation(depthMapShader.shaderProgram, "lightSpaceTrMatrix"), 1, GL_FALSE,
+        glm::value_ptr(myCamera.getViewProjectionMatrix()));
+
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    prePassDrawList.Submit();
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+}
+
+// samples that passed the depth test in the main pass of the previous frame
+void readSamplesQuery() {
+    GLuint previous = samplesQueries[(samplesQueryFrame + 1) % 2];
+    if (samplesQueryFrame == 0)
+        return;
+
+    GLuint available = 0;
+    glGetQueryObjectuiv(previous, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (available)
+        glGetQueryObjectuiv(previous, GL_QUERY_RESULT, &lastSamplesPassed);
+}
+
+void renderMainPass(const gps::RenderPass& pass) {
+    GPS_PROFILE_FUNCTION();
+    updateLightClusters();
+
+    // past the shadow distance the cascades have nothing to sample
+    int numPointLights = getPointLightPermutation();
+    gps::Shader& nearShader = basicShaders.Get(getLightingFeatures(true), numPointLights);
+    gps::Shader& distantShader = basicShaders.Get(getLightingFeatures(false), numPointLights);
+
+    // the workers prepare the draws while nothing else is going on, the GL thread joins in
+    gps::DrawView drawView = createCameraDrawView(PASS_MAIN, nearShader.shaderProgram);
+    drawView.distantProgram = distantShader.shaderProgram;
+    drawView.distantDepth = SHADOW_DISTANCE;
+    mainDrawList.Build(jobSystem, renderables, pass.objectSets, drawView);
+    accumulateDrawStats(mainDrawList);
+
+    glViewport(0, 0, myWindow.getWindowDimensions().width, myWindow.getWindowDimensions().height);
+    // the pre-pass already cleared the buffers and holds the depth
+    if (!depthPrePass) {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    }
+
+    gps::Shader* shaders[2] = { &nearShader, &distantShader };
+    for (int i = 0; i < 2; i++) {
+        setLightingUniforms(*shaders[i]);
+        glUniformMatrix4fv(glGetUniformLocation(shaders[i]->shaderProgram, "viewProjection"), 1, GL_FALSE,
+            glm::value_ptr(myCamera.getViewProjectionMatrix()));
+    }
+
+    if (depthPrePass) {
+        glDepthFunc(GL_EQUAL);
+        glDepthMask(GL_FALSE);
+    }
+
+    readSamplesQuery();
+    glBeginQuery(GL_SAMPLES_PASSED, samplesQueries[samplesQueryFrame % 2]);
+    mainDrawList.Submit();
+    glEndQuery(GL_SAMPLES_PASSED);
+    samplesQueryFrame++;
+
+    glDepthFunc(GL_LESS);
+    glDepthMask(GL_TRUE);
+
+    // the skybox is drawn last so it only fills the pixels left empty
+    if (pass.objectSets & gps::OBJECTS_SKY) {
+        renderSkyBox();
+    }
+}
+
+// eye space octahedral normals, albedo and specular intensity, depth
+// the graph binds the G-buffer framebuffer and viewport before the pass runs
+void renderGBufferPass(const gps::RenderPass& pass) {
+    GPS_PROFILE_FUNCTION();
+    mainDrawList.Build(jobSystem, renderables, pass.objectSets, createCameraDrawView(PASS_GBUFFER, gbufferShader.shaderProgram));
+    accumulateDrawStats(mainDrawList);
+
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    gbufferShader.useShaderProgram();
+    glUniformMatrix4fv(glGetUniformLocation(gbufferShader.shaderProgram, "viewProjection"), 1, GL_FALSE, glm::value_ptr(myCamera.getViewProjectionMatrix()));
 
+    mainDrawList.Submit();
+}
+
+// lighting, shadows and fog once per pixel over the G-buffer
+// the skybox goes first, the lighting shader discards the pixels without geometry
+void renderDeferredLightingPass(const gps::RenderPass& pass) {
+    GPS_PROFILE_FUNCTION();
     glViewport(0, 0, myWindow.getWindowDimensions().width, myWindow.getWindowDimensions().height);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    myBasicShader.useShaderProgram();
-    view = myCamera.getViewMatrix();
-    glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
 
-    //bind the shadow map
-    glActiveTexture(GL_TEXTURE3);
-    glBindTexture(GL_TEXTURE_2D, depthMapTexture);
-    glUniform1i(glGetUniformLocation(myBasicShader.shaderProgram, "shadowMap"), 3);
+    if (pass.objectSets & gps::OBJECTS_SKY) {
+        renderSkyBox();
+    }
+
+    updateLightClusters();
+    gps::Shader& deferredShader = deferredShaders.Get(getLightingFeatures(true), getPointLightPermutation());
+    setLightingUniforms(deferredShader);
+    GLuint program = deferredShader.shaderProgram;
+    const char* samplers[3] = { "gNormal", "gAlbedoSpec", "gDepth" };
+    gps::RenderResource targets[3] = { gbufferNormal, gbufferAlbedo, gbufferDepth };
+    for (int i = 0; i < 3; i++) {
+        glActiveTexture(GL_TEXTURE0 + i);
+        glBindTexture(GL_TEXTURE_2D, frameGraph.GetTexture(targets[i]));
+        glUniform1i(glGetUniformLocation(program, samplers[i]), i);
+    }
+
+    glUniformMatrix4fv(glGetUniformLocation(program, "inverseView"), 1, GL_FALSE, glm::value_ptr(myCamera.getInverseViewMatrix()));
+    glUniformMatrix4fv(glGetUniformLocation(program, "inverseProjection"), 1, GL_FALSE, glm::value_ptr(myCamera.getInverseProjectionMatrix()));
+
+    glDisable(GL_DEPTH_TEST);
+    glBindVertexArray(fullscreenVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+    glEnable(GL_DEPTH_TEST);
+
+    for (int i = 0; i < 3; i++) {
+        glActiveTexture(GL_TEXTURE0 + i);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+}
+
+// the counters are those of the previous frame, this one is still being drawn
+void renderHudPass(const gps::RenderPass& pass) {
+    GPS_PROFILE_FUNCTION();
+    int width = myWindow.getWindowDimensions().width;
+    int height = myWindow.getWindowDimensions().height;
+    glViewport(0, 0, width, height);
+
+    const float left = 10.0f;
+    const float lineHeight = 12.0f;
+    const float graphWidth = 2.0f * gps::HUD_GRAPH_SAMPLES;
+    const float graphHeight = 80.0f;
+    glm::vec4 white = glm::vec4(1.0f);
+    glm::vec4 grey = glm::vec4(0.7f, 0.7f, 0.7f, 1.0f);
+
+    hud.BeginFrame(width, height);
+    hud.Rect(0.0f, 0.0f, graphWidth + 2.0f * left, graphHeight + lineHeight * (12 + lastPassCount) + 20.0f,
+        glm::vec4(0.0f, 0.0f, 0.0f, 0.6f));
+    float y = 10.0f;
+    hud.Print(left, y, 1.0f, white, "frame %.2f ms (%.0f fps)", lastFrameMilliseconds,
+        lastFrameMilliseconds > 0.0f ? 1000.0f / lastFrameMilliseconds : 0.0f);
+    y += lineHeight;
+    hud.FrameTimeGraph(left, y, graphWidth, graphHeight);
+    y += graphHeight + 6.0f;
+
+    hud.Print(left, y, 1.0f, grey, "%-20s %8s %8s", "pass", "cpu ms", "gpu ms");
+    y += lineHeight;
+    for (int i = 0; i < lastPassCount; i++) {
+        double gpuMilliseconds = gpuProfiling ? gpuProfiler.GetLastMilliseconds(gpuProfiler.Intern(lastPassTimes[i].name)) : -1.0;
+        if (gpuMilliseconds >= 0.0) {
+            hud.Print(left, y, 1.0f, white, "%-20s %8.2f %8.2f", lastPassTimes[i].name.c_str(), lastPassTimes[i].cpuMilliseconds, gpuMilliseconds);
+        }
+        else {
+            hud.Print(left, y, 1.0f, white, "%-20s %8.2f %8s", lastPassTimes[i].name.c_str(), lastPassTimes[i].cpuMilliseconds, "-");
+        }
+        y += lineHeight;
+    }
+    y += 6.0f;
+
+    gps::RenderQueueStats sorted = lastFrameDrawStats.sorted;
+    hud.Print(left, y, 1.0f, white, "draws %d, triangles %.1fk", sorted.draws, lastFrameDrawStats.triangles / 1000.0);
+    y += lineHeight;
+    hud.Print(left, y, 1.0f, white, "state changes: programs %d, materials %d, meshes %d",
+        sorted.programChanges, sorted.materialChanges, sorted.meshChanges);
+    y += lineHeight;
+    hud.Print(left, y, 1.0f, white, "culled: renderables %d/%d, meshes %d/%d",
+        lastFrameDrawStats.culledRenderables, lastFrameDrawStats.renderables, lastFrameDrawStats.culledMeshes, lastFrameDrawStats.meshes);
+    y += lineHeight;
+    long long textureBytes = gps::GpuMemory::GetBytes(gps::GPU_MEMORY_TEXTURE) + gps::GpuMemory::GetBytes(gps::GPU_MEMORY_RENDERBUFFER);
+    hud.Print(left, y, 1.0f, white, "memory: textures %.1f MB (%d), buffers %.1f MB (%d)",
+        textureBytes / 1048576.0, gps::GpuMemory::GetObjectCount(gps::GPU_MEMORY_TEXTURE) + gps::GpuMemory::GetObjectCount(gps::GPU_MEMORY_RENDERBUFFER),
+        gps::GpuMemory::GetBytes(gps::GPU_MEMORY_BUFFER) / 1048576.0, gps::GpuMemory::GetObjectCount(gps::GPU_MEMORY_BUFFER));
+    y += lineHeight;
+    hud.Print(left, y, 1.0f, white, "point lights %d, shaded samples per pixel %.2f",
+        lightClusters.GetLightCount(), (float)lastSamplesPassed / (float)(width * height));
+    if (gps::AllocationTracker::IsEnabled()) {
+        y += lineHeight;
+        gps::AllocationCount allocations = gps::AllocationTracker::GetLastFrame();
+        hud.Print(left, y, 1.0f, white, "heap: %lld allocations, %.1f KB", allocations.allocations, allocations.bytes / 1024.0);
+    }
+
+    hud.Draw();
+}
+
+// a loop around the base that ends where the intro leaves the camera
+void initCameraPath() {
+    if (!cameraPathFile.empty() && cameraPath.Load(cameraPathFile)) {
+        return;
+    }
+
+    cameraPath.AddKey(0.0f, glm::vec3(1.2f, 1.0f, 5.0f), -79.43f, 0.0f);
+    cameraPath.AddKey(4.0f, glm::vec3(6.0f, 2.0f, 4.0f), -120.0f, -5.0f);
+    cameraPath.AddKey(8.0f, glm::vec3(6.0f, 3.0f, -4.0f), -200.0f, -10.0f);
+    cameraPath.AddKey(12.0f, glm::vec3(-4.0f, 3.0f, -5.0f), -300.0f, -10.0f);
+    cameraPath.AddKey(16.0f, glm::vec3(-5.0f, 2.0f, 3.0f), -380.0f, -5.0f);
+    cameraPath.AddKey(20.0f, glm::vec3(1.2f, 1.0f, 5.0f), -439.43f, 0.0f);
+}
+
+void initBenchmark() {
+    initCameraPath();
+    benchmark.Init();
+    benchmark.SetWarmupFrames(BENCHMARK_WARMUP_FRAMES);
+    myWindow.setVSync(false);
+}
+
+// every executed pass is timed by whoever is listening
+void initPassHooks() {
+    frameGraph.SetPassHooks(
+        [](const gps::RenderPass& pass) {
+            if (benchmarkMode) {
+                benchmark.BeginPass(pass.name);
+            }
+            if (gpuProfiling) {
+                gpuProfiler.BeginScope(gpuProfiler.Intern(pass.name));
+            }
+            if (hudVisible) {
+                passStartTime = gps::Profiler::Now();
+            }
+        },
+        [](const gps::RenderPass& pass) {
+            if (hudVisible) {
+                if (framePassCount == (int)framePassTimes.size()) {
+                    framePassTimes.push_back(PassTime());
+                }
+                PassTime& passTime = framePassTimes[framePassCount++];
+                passTime.name = pass.name;
+                passTime.cpuMilliseconds = (gps::Profiler::Now() - passStartTime) / 1000000.0;
+            }
+            if (gpuProfiling) {
+                gpuProfiler.EndScope();
+            }
+            if (benchmarkMode) {
+                benchmark.EndPass(pass.name);
+            }
+        });
+}
+
+bool benchmarkFinished() {
+    return !intro && cameraPathTime >= cameraPath.GetDuration();
+}
+
+// the forward and deferred paths share the shadow pass, G selects the path
+void initRenderGraph() {
+    gps::RenderResource staticShadowMap = frameGraph.ImportTexture("staticShadowMap", shadowCascades.GetTextureId(gps::SHADOW_LAYER_STATIC));
+    gps::RenderResource dynamicShadowMap = frameGraph.ImportTexture("dynamicShadowMap", shadowCascades.GetTextureId(gps::SHADOW_LAYER_DYNAMIC));
+    gps::RenderResource backbuffer = frameGraph.ImportBackbuffer("backbuffer", myWindow.getFramebuffer());
+
+    frameGraph.AddPass("shadow", {}, { staticShadowMap, dynamicShadowMap },
+        gps::OBJECTS_STATIC | gps::OBJECTS_DYNAMIC, renderShadowPass);
+
+    if (deferredShading) {
+        int width = myWindow.getWindowDimensions().width;
+        int height = myWindow.getWindowDimensions().height;
+        gbufferNormal = frameGraph.CreateRenderTarget("gbufferNormal", gps::RenderTargetDesc{ width, height, GL_RG16 });
+        gbufferAlbedo = frameGraph.CreateRenderTarget("gbufferAlbedo", gps::RenderTargetDesc{ width, height, GL_RGBA8 });
+        gbufferDepth = frameGraph.CreateRenderTarget("gbufferDepth", gps::RenderTargetDesc{ width, height, GL_DEPTH_COMPONENT24 });
+
+        frameGraph.AddPass("gbuffer", {}, { gbufferNormal, gbufferAlbedo, gbufferDepth },
+            gps::OBJECTS_STATIC | gps::OBJECTS_DYNAMIC, renderGBufferPass);
+        frameGraph.AddPass("deferred lighting", { gbufferNormal, gbufferAlbedo, gbufferDepth, staticShadowMap, dynamicShadowMap }, { backbuffer },
+            gps::OBJECTS_SKY, renderDeferredLightingPass);
+    }
+    else {
+        if (depthPrePass) {
+            frameGraph.AddPass("depth prepass", {}, { backbuffer },
+                gps::OBJECTS_STATIC | gps::OBJECTS_DYNAMIC, renderDepthPrePass);
+        }
+        frameGraph.AddPass("main", { staticShadowMap, dynamicShadowMap }, { backbuffer },
+            gps::OBJECTS_STATIC | gps::OBJECTS_DYNAMIC | gps::OBJECTS_SKY, renderMainPass);
+    }
+
+    if (hudVisible) {
+        frameGraph.AddPass("hud", {}, { backbuffer }, 0, renderHudPass);
+    }
 
-    glUniformMatrix4fv(glGetUniformLocation(myBasicShader.shaderProgram, "lightSpaceTrMatrix"),
-        1, GL_FALSE, glm::value_ptr(computeLightSpaceTrMatrix()));
+    frameGraph.Compile();
+}
 
-    renderObjects(myBasicShader, false);
+void renderScene() {
+    GPS_PROFILE_FUNCTION();
+    if (renderGraphDirty) {
+        frameGraph.Reset();
+        initRenderGraph();
+        renderGraphDirty = false;
+    }
 
+    frameDrawStats = gps::DrawListStats();
+    framePassCount = 0;
+    frameGraph.Execute();
+    lastFrameDrawStats = frameDrawStats;
+    lastPassTimes.swap(framePassTimes);
+    lastPassCount = framePassCount;
 }
 
 void cleanup() {
-    glDeleteTextures(1, &depthMapTexture);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    glDeleteFramebuffers(1, &shadowMapFBO);
-    //glfwDestroyWindow(glWindow);
+    if (!recordPathFile.empty() && !benchmarkMode) {
+        cameraPath.Save(recordPathFile);
+    }
+    benchmark.Delete();
+    gpuProfiler.Delete();
+    hud.Delete();
+    jobSystem.Shutdown();
+    lightClusters.Delete();
+    basicShaders.Delete();
+    deferredShaders.Delete();
+    frameGraph.Reset();
+    glDeleteVertexArrays(1, &fullscreenVAO);
+    glDeleteQueries(2, samplesQueries);
+    shadowCascades.Delete();
+    // closes the GL context and shuts the backend down
     myWindow.Delete();
-    //close GL context and any other GLFW resources
-    glfwTerminate();
 }
 
 int main(int argc, const char * argv[]) {
 
+    GPS_PROFILE_THREAD("main");
+    if (!parseArguments(argc, argv)) {
+        return EXIT_FAILURE;
+    }
+    beginCapture();
     try {
         initOpenGLWindow();
     } catch (const std::exception& e) {
@@ -647,28 +1436,118 @@ int main(int argc, const char * argv[]) {
     }
 
     initOpenGLState();
-	initModels();
+    // the driver compiles the programs while the models and textures load
 	initShaders();
+	initModels();
+    initTransforms();
+    initRenderables();
+    jobSystem.Init();
 	initUniforms();
     initFBO();
     setWindowCallbacks();
     initSkybox();
+    lightClusters.Init();
+    hud.Init();
+    initRenderGraph();
+    if (benchmarkMode) {
+        initBenchmark();
+    }
+    if (gpuProfiling) {
+        initGpuProfiler();
+    }
+    initPassHooks();
+
+    currentState = captureSimulationState();
+    previousState = currentState;
+    renderState = currentState;
+    lastTimeStamp = myWindow.getTime();
 
+    // once after the setup, the frames report through the debug output, glGetError in the loop would stall the driver
 	glCheckError();
+    // the uploads, links and lookups of the setup do not count against the first frame's budget
+    gps::GLIntercept::ResetFrame();
 	// application loop
-	while (!glfwWindowShouldClose(myWindow.getWindow())) {
-        if (!intro) {
-            processMovement();
+    // a fixed frame count or a benchmark steps the simulation once per frame, the frames do not depend on the machine
+    bool fixedSteps = frameLimit > 0 || benchmarkMode;
+	for (int frame = 0; !myWindow.shouldClose() && (frameLimit == 0 || frame < frameLimit); frame++) {
+        // the first frames fill the caches, after them the loop should not touch the heap
+        bool allocationGuarded = allocationGuard && frame >= allocationWarmupFrames;
+        gps::AllocationTracker::SetGuard(allocationGuarded);
+        if (benchmarkMode) {
+            if (benchmarkFinished()) {
+                break;
+            }
+            benchmark.BeginFrame();
+        }
+        if (gpuProfiling) {
+            gpuProfiler.BeginFrame();
         }
+
+        double currentTimeStamp = myWindow.getTime();
+        lastFrameMilliseconds = (float)((currentTimeStamp - lastTimeStamp) * 1000.0);
+        hud.AddFrameTime(lastFrameMilliseconds);
+        advanceSimulation(fixedSteps ? simulationClock.GetFixedTimeStep() : currentTimeStamp - lastTimeStamp);
+        lastTimeStamp = currentTimeStamp;
+
+        updateModelMatrices(renderState);
+        updateRenderables();
 	    renderScene();
 
-		glfwPollEvents();
-		glfwSwapBuffers(myWindow.getWindow());
+        if (!frameDumpDirectory.empty()) {
+            gps::AllocationTracker::SetGuard(false);
+            char fileName[32];
+            snprintf(fileName, sizeof(fileName), "/frame_%05d.ppm", frame);
+            myWindow.saveFrame(frameDumpDirectory + fileName);
+            gps::AllocationTracker::SetGuard(allocationGuarded);
+        }
 
-		glCheckError();
+        if (gpuProfiling) {
+            gpuProfiler.EndFrame();
+        }
+        if (benchmarkMode) {
+            benchmark.BeginSwap();
+        }
+        {
+            GPS_ALLOC_TAG("swap");
+            myWindow.pollEvents();
+            myWindow.swapBuffers();
+        }
+        if (benchmarkMode) {
+            benchmark.EndSwap();
+            benchmark.EndFrame();
+        }
+        gps::Profiler::EndFrame();
+        // the summaries and the trace file allocate, they run after the guard
+        // the GL call counters inside the frame only allocate for an entry point or call site not seen before
+        gps::AllocationTracker::SetGuard(false);
+        gps::AllocationTracker::EndFrame();
+        if (allocationSummary) {
+            gps::AllocationTracker::PrintFrameSummary();
+        }
+        // a frame over budget prints its summary already
+        if (gps::GLIntercept::EndFrame() && glCallSummary) {
+            gps::GLIntercept::PrintFrameSummary();
+        }
+        gps::GLTrace::EndFrame();
 	}
 
+    if (benchmarkMode) {
+        benchmark.Finish();
+        benchmark.WriteJson(benchmarkOutput);
+    }
+
+    // a run shorter than the capture still leaves a complete trace
+    gps::GLTrace::EndCapture();
 	cleanup();
 
+    if (gps::GLIntercept::GetBudgetViolationCount() > 0) {
+        std::cerr << gps::GLIntercept::GetBudgetViolationCount() << " frames over the GL call budget" << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (gps::AllocationTracker::GetGuardViolationCount() > 0) {
+        std::cerr << gps::AllocationTracker::GetGuardViolationCount() << " heap allocations in the render loop after "
+            << allocationWarmupFrames << " warm-up frames" << std::endl;
+        return EXIT_FAILURE;
+    }
     return EXIT_SUCCESS;
 }
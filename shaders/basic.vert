@@ -4,33 +4,27 @@ layout(location=0) in vec3 vPosition;
 layout(location=1) in vec3 vNormal;
 layout(location=2) in vec2 vTexCoords;
 
-out vec3 fPosition;
-out vec3 fNormal;
+out vec3 fPosWorld;
+out vec3 fPosEyeSpace;
+out vec3 fNormalEye;
 out vec2 fTexCoords;
-out vec3 fLightPos1;
-out vec3 fLightPos2;
-out vec3 fRedLightPos;
-out vec4 fragPosLightSpace;
 
-uniform mat4 model;
 uniform mat4 view;
-uniform mat4 projection;
-uniform vec3 lightPos1;
-uniform vec3 lightPos2;
-uniform vec3 redLightPos;
-uniform mat4 lightModel;
-uniform mat4 redLightModel;
-uniform mat4 lightSpaceTrMatrix;
+//projection * view, computed on the CPU
+uniform mat4 viewProjection;
+uniform mat4 model;
+uniform mat3 normalMatrix;
+
+//same expression as depthMapShader.vert, so the main pass can test GL_EQUAL against the depth pre-pass
+invariant gl_Position;
 
 void main() 
 {
-	gl_Position = projection * view * model * vec4(vPosition, 1.0f);
-	fragPosLightSpace = lightSpaceTrMatrix * model * vec4(vPosition, 1.0f);
-	fPosition = vPosition;
-	fNormal = vNormal;
-	//vec4 viewPos = vec4(0.0f, 0.0f, 0.0f, 1.0f);
-	fLightPos1 = vec3(view * lightModel * vec4(lightPos1, 1.0f));
-	fLightPos2 = vec3(view * lightModel * vec4(lightPos2, 1.0f));
-	fRedLightPos = vec3(view * redLightModel * vec4(redLightPos, 1.0f));
+	gl_Position = viewProjection * model * vec4(vPosition, 1.0f);
+
+	vec4 posWorld = model * vec4(vPosition, 1.0f);
+	fPosWorld = posWorld.xyz;
+	fPosEyeSpace = vec3(view * posWorld);
+	fNormalEye = normalMatrix * vNormal;
 	fTexCoords = vTexCoords;
 }
@@ -0,0 +1,47 @@
+#version 410 core
+
+in vec2 fTexCoords;
+
+out vec4 fColor;
+
+//G-buffer
+uniform sampler2D gNormal;
+uniform sampler2D gAlbedoSpec;
+uniform sampler2D gDepth;
+//matrices
+uniform mat4 view;
+uniform mat4 inverseView;
+uniform mat4 inverseProjection;
+
+#include "lighting.glsl"
+
+vec2 signNotZero(vec2 v)
+{
+	return vec2(v.x >= 0.0f ? 1.0f : -1.0f, v.y >= 0.0f ? 1.0f : -1.0f);
+}
+
+vec3 decodeOctahedron(vec2 encoded)
+{
+	encoded = encoded * 2.0f - 1.0f;
+	vec3 n = vec3(encoded, 1.0f - abs(encoded.x) - abs(encoded.y));
+	if (n.z < 0.0f)
+		n.xy = (1.0f - abs(n.yx)) * signNotZero(n.xy);
+	return normalize(n);
+}
+
+void main() 
+{
+	float depth = texture(gDepth, fTexCoords).r;
+	//the skybox is already in the backbuffer
+	if (depth >= 1.0f)
+		discard;
+
+	//eye space position from the depth buffer
+	fPosEye = inverseProjection * vec4(vec3(fTexCoords, depth) * 2.0f - 1.0f, 1.0f);
+	fPosEye /= fPosEye.w;
+	normalEye = decodeOctahedron(texture(gNormal, fTexCoords).rg);
+	vec4 albedoSpec = texture(gAlbedoSpec, fTexCoords);
+
+	vec3 posWorld = vec3(inverseView * fPosEye);
+	fColor = computeLighting(albedoSpec.rgb, vec3(albedoSpec.a), posWorld);
+}
@@ -0,0 +1,11 @@
+#version 410 core
+
+out vec2 fTexCoords;
+
+//a single triangle covering the screen, no vertex buffer needed
+void main()
+{
+	vec2 position = vec2(float((gl_VertexID << 1) & 2), float(gl_VertexID & 2));
+	fTexCoords = position;
+	gl_Position = vec4(position * 2.0f - 1.0f, 0.0f, 1.0f);
+}
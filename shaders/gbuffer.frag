@@ -0,0 +1,34 @@
+#version 410 core
+
+in vec3 fNormalEye;
+in vec2 fTexCoords;
+
+//octahedral eye space normal in [0, 1]
+layout(location=0) out vec2 gNormal;
+//albedo and specular intensity
+layout(location=1) out vec4 gAlbedoSpec;
+
+uniform sampler2D diffuseTexture;
+uniform sampler2D specularTexture;
+
+vec2 signNotZero(vec2 v)
+{
+	return vec2(v.x >= 0.0f ? 1.0f : -1.0f, v.y >= 0.0f ? 1.0f : -1.0f);
+}
+
+//project the unit sphere onto an octahedron and unfold it into a square
+vec2 encodeOctahedron(vec3 n)
+{
+	n /= abs(n.x) + abs(n.y) + abs(n.z);
+	vec2 encoded = n.z >= 0.0f ? n.xy : (1.0f - abs(n.yx)) * signNotZero(n.xy);
+	return encoded * 0.5f + 0.5f;
+}
+
+void main()
+{
+	vec3 normalEye = normalize(fNormalEye);
+	gNormal = encodeOctahedron(normalEye);
+
+	vec3 specularColor = texture(specularTexture, fTexCoords).rgb;
+	gAlbedoSpec = vec4(texture(diffuseTexture, fTexCoords).rgb, (specularColor.r + specularColor.g + specularColor.b) / 3.0f);
+}
@@ -0,0 +1,14 @@
+#version 410 core
+
+in vec2 fTexCoords;
+in vec4 fColor;
+
+out vec4 color;
+
+//coverage of the glyphs in the red channel, solid quads sample a filled glyph
+uniform sampler2D glyphAtlas;
+
+void main()
+{
+	color = vec4(fColor.rgb, fColor.a * texture(glyphAtlas, fTexCoords).r);
+}
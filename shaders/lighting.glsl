@@ -0,0 +1,185 @@
+//lighting shared by basic.frag and deferred.frag
+//the including shader declares the view matrix and sets fPosEye and normalEye
+//features: SHADOWS, FOG, NUM_POINT_LIGHTS (most lights shaded per cluster, 0 compiles them out)
+
+#ifndef NUM_POINT_LIGHTS
+#define NUM_POINT_LIGHTS 0
+#endif
+
+//lighting
+uniform vec3 lightDir;
+uniform vec3 lightColor;
+#if NUM_POINT_LIGHTS > 0
+//clustered point lights, two texels per light: (view position, linear) (color, quadratic)
+#define LIGHT_CUTOFF 0.01f
+uniform samplerBuffer clusterLights;
+//(first index, light count) per cluster
+uniform usamplerBuffer clusterTable;
+uniform usamplerBuffer clusterIndices;
+//slice = log(depth) * x + y
+uniform vec2 clusterDepthParams;
+uniform vec2 clusterTileSize;
+uniform ivec3 clusterDims;
+#endif
+#ifdef FOG
+uniform float fogDensity;
+uniform vec3 fogColor;
+#endif
+#ifdef SHADOWS
+#define MAX_CASCADES 4
+uniform sampler2DArray shadowMap;
+uniform sampler2DArray dynamicShadowMap;
+uniform mat4 lightSpaceTrMatrices[MAX_CASCADES];
+uniform float cascadeSplits[MAX_CASCADES];
+uniform float cascadeBias[MAX_CASCADES];
+uniform int cascadeCount;
+#endif
+
+//components
+vec4 fPosEye;
+vec3 ambient;
+float ambientStrength = 0.2f;
+vec3 diffuse;
+vec3 specular;
+float specularStrength = 0.5f;
+vec3 normalEye;
+float shininess = 32.0f;
+
+float constant = 1.0f;
+
+float shadow;
+
+void computeDirLight()
+{
+    //normalize light direction
+    vec3 lightDirN = vec3(normalize(view * vec4(lightDir, 0.0f)));
+
+    //compute view direction (in eye coordinates, the viewer is situated at the origin
+    vec3 viewDir = normalize(- fPosEye.xyz);
+
+    //compute ambient light
+    ambient = ambientStrength * lightColor;
+
+    //compute diffuse light
+    diffuse = max(dot(normalEye, lightDirN), 0.0f) * lightColor;
+	
+	//compute half vector
+	vec3 halfVector = normalize(lightDirN + viewDir);
+
+    //compute specular light
+    float specCoeff = pow(max(dot(normalEye, halfVector), 0.0f), 32);
+    specular = specularStrength * specCoeff * lightColor;
+}
+
+#if NUM_POINT_LIGHTS > 0
+void computePunctLigth(vec3 fLightPos, vec3 lightColorPunct, float lin, float quad)
+{
+	vec3 cameraPosEye = vec3(0.0f);
+	
+	//normalize light direction
+	vec3 lightDirN = normalize(fLightPos - fPosEye.xyz);
+
+	//compute view direction
+	vec3 viewDirN = normalize(cameraPosEye - fPosEye.xyz);
+
+	//compute half vector
+	vec3 halfVector = normalize(lightDirN + viewDirN);
+	
+	//compute specular light
+	float specCoeff = pow(max(dot(normalEye, halfVector), 0.0f), shininess);
+	
+	//compute distance to light
+	float dist = length(fLightPos - fPosEye.xyz);
+	//compute attenuation, shifted so it reaches zero at the cluster radius
+	float att = 1.0f / (constant + lin * dist + quad * (dist * dist));
+	att = max(att - LIGHT_CUTOFF, 0.0f) / (1.0f - LIGHT_CUTOFF);
+	
+	ambient += att * ambientStrength * lightColorPunct;
+	diffuse += att * max(dot(normalEye, lightDirN), 0.0f) * lightColorPunct;
+	specular += att * specularStrength * specCoeff * lightColorPunct;
+}
+
+void computeClusterLights()
+{
+	//the cluster of the fragment: screen tile and exponential depth slice
+	int slice = int(log(max(-fPosEye.z, 0.0001f)) * clusterDepthParams.x + clusterDepthParams.y);
+	slice = clamp(slice, 0, clusterDims.z - 1);
+	ivec2 tile = clamp(ivec2(gl_FragCoord.xy / clusterTileSize), ivec2(0), clusterDims.xy - 1);
+	int cluster = tile.x + clusterDims.x * (tile.y + clusterDims.y * slice);
+
+	uvec2 range = texelFetch(clusterTable, cluster).xy;
+	uint count = min(range.y, uint(NUM_POINT_LIGHTS));
+	for (uint i = 0u; i < count; i++) {
+		int light = int(texelFetch(clusterIndices, int(range.x + i)).r);
+		vec4 positionLinear = texelFetch(clusterLights, light * 2);
+		vec4 colorQuadratic = texelFetch(clusterLights, light * 2 + 1);
+		computePunctLigth(positionLinear.xyz, colorQuadratic.rgb, positionLinear.w, colorQuadratic.w);
+	}
+}
+#endif
+
+#ifdef SHADOWS
+void computeShadow(vec3 posWorld)
+{
+	//the first cascade whose far split lies beyond the fragment, or a later one when its
+	//refit was deferred and the fragment fell outside its light space rectangle
+	float viewDepth = -fPosEye.z;
+	shadow = 0.0f;
+	for (int i = 0; i < cascadeCount; i++) {
+		if (viewDepth >= cascadeSplits[i])
+			continue;
+
+		vec4 fragPosLightSpace = lightSpaceTrMatrices[i] * vec4(posWorld, 1.0f);
+		vec3 normalizedCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
+		normalizedCoords = normalizedCoords * 0.5 + 0.5;
+		if (any(lessThan(normalizedCoords.xy, vec2(0.0f))) || any(greaterThan(normalizedCoords.xy, vec2(1.0f))))
+			continue;
+
+		//the cached static layer and the per-frame dynamic layer share the cascade matrices
+		vec3 layerCoords = vec3(normalizedCoords.xy, float(i));
+		float closestDepth = min(texture(shadowMap, layerCoords).r, texture(dynamicShadowMap, layerCoords).r);
+		float currentDepth = normalizedCoords.z;
+		float bias = cascadeBias[i];
+		shadow = (currentDepth - bias) > closestDepth ? 1.0 : 0.0;
+		if (currentDepth > 1.0f)
+			shadow = 0.0f;
+		return;
+	}
+}
+#endif
+
+#ifdef FOG
+float computeFog()
+{
+	float fragmentDistance = length(fPosEye);
+	float fogFactor = exp(-pow(fragmentDistance * fogDensity, 2));
+ 
+	return clamp(fogFactor, 0.0f, 1.0f);
+}
+#endif
+
+//final colour of the fragment from its material and world position
+vec4 computeLighting(vec3 albedo, vec3 specularColor, vec3 posWorld)
+{
+	computeDirLight();
+#if NUM_POINT_LIGHTS > 0
+	computeClusterLights();
+#endif
+
+	ambient *= albedo;
+	diffuse *= albedo;
+	specular *= specularColor;
+
+	shadow = 0.0f;
+#ifdef SHADOWS
+	computeShadow(posWorld);
+#endif
+	vec3 color = min((ambient + (1.0f - shadow)*diffuse) + (1.0f - shadow)*specular, 1.0f);
+
+#ifdef FOG
+	float fogFactor = computeFog();
+	return mix(vec4(fogColor, 1.0f), vec4(color, 1.0f), fogFactor);
+#else
+	return vec4(color, 1.0f);
+#endif
+}